@@ -0,0 +1,485 @@
+#include "asset_manager.h"
+
+#include <algorithm>
+#include <chrono>
+#include <utility>
+
+#include "profiler.h"
+
+namespace
+{
+    // raylib's defaults for TTF fonts: printable ASCII, 4 px between glyphs.
+    constexpr int FONT_GLYPH_COUNT = 95;
+    constexpr int FONT_GLYPH_PADDING = 4;
+
+    std::string MakeKey(const std::string& path, AssetType type, int fontSize)
+    {
+        switch (type)
+        {
+            case AssetType::Texture: return "texture:" + path;
+            case AssetType::Sound: return "sound:" + path;
+            case AssetType::Font: return "font" + std::to_string(fontSize) + ":" + path;
+            case AssetType::Music: return "music:" + path;
+        }
+        return path;
+    }
+}
+
+AssetManager::~AssetManager()
+{
+    Stop();
+}
+
+void AssetManager::Start(const std::string& assetRoot, int loaderThreads, std::size_t budget)
+{
+    Stop();
+    root = assetRoot;
+    memoryBudget = budget;
+
+    running = true;
+    const int threads = std::max(1, loaderThreads);
+    loaders.reserve(static_cast<std::size_t>(threads));
+    for (int i = 0; i < threads; ++i)
+    {
+        loaders.emplace_back(&AssetManager::LoaderMain, this);
+    }
+}
+
+void AssetManager::Stop()
+{
+    {
+        const std::lock_guard<std::mutex> lock(queueMutex);
+        running = false;
+        requests.clear();
+    }
+    wakeLoaders.notify_all();
+
+    for (std::thread& loader : loaders)
+    {
+        loader.join();
+    }
+    loaders.clear();
+
+    for (DecodedAsset& pending : decoded)
+    {
+        Discard(pending);
+    }
+    decoded.clear();
+
+    for (auto& entry : entries)
+    {
+        Unload(entry.second);
+    }
+    entries.clear();
+    idsByKey.clear();
+    residentBytes = 0;
+    stats = {};
+}
+
+AssetHandle AssetManager::Acquire(const std::string& path, AssetType type, int fontSize)
+{
+    std::string key = MakeKey(path, type, fontSize);
+    const auto existing = idsByKey.find(key);
+    if (existing != idsByKey.end())
+    {
+        entries[existing->second].references += 1;
+        return {existing->second};
+    }
+
+    const std::uint32_t id = nextId++;
+    Entry& entry = entries[id];
+    entry.key = key;
+    entry.path = path;
+    entry.type = type;
+    entry.fontSize = fontSize;
+    entry.references = 1;
+    idsByKey.emplace(std::move(key), id);
+
+    {
+        const std::lock_guard<std::mutex> lock(queueMutex);
+        requests.push_back({id, path, type, fontSize});
+    }
+    wakeLoaders.notify_one();
+    return {id};
+}
+
+void AssetManager::Release(AssetHandle handle)
+{
+    const auto found = entries.find(handle.id);
+    if (found == entries.end() || found->second.references == 0)
+    {
+        return;
+    }
+
+    Entry& entry = found->second;
+    entry.references -= 1;
+    if (entry.references > 0)
+    {
+        return;
+    }
+
+    entry.releasedAt = ++releaseCounter;
+    // Nothing to keep for a failed load, and dropping it lets a later Acquire retry.
+    if (entry.state == AssetState::Failed)
+    {
+        Erase(handle.id);
+    }
+}
+
+AssetState AssetManager::GetState(AssetHandle handle) const
+{
+    const auto found = entries.find(handle.id);
+    return found != entries.end() ? found->second.state : AssetState::Failed;
+}
+
+const Texture2D* AssetManager::GetTexture(AssetHandle handle) const
+{
+    const Entry* entry = Find(handle, AssetType::Texture);
+    return entry != nullptr ? &entry->texture : nullptr;
+}
+
+const Sound* AssetManager::GetSound(AssetHandle handle) const
+{
+    const Entry* entry = Find(handle, AssetType::Sound);
+    return entry != nullptr ? &entry->sound : nullptr;
+}
+
+const Font* AssetManager::GetFont(AssetHandle handle) const
+{
+    const Entry* entry = Find(handle, AssetType::Font);
+    return entry != nullptr ? &entry->font : nullptr;
+}
+
+const Music* AssetManager::GetMusic(AssetHandle handle) const
+{
+    const Entry* entry = Find(handle, AssetType::Music);
+    return entry != nullptr ? &entry->music : nullptr;
+}
+
+void AssetManager::Update(double uploadSeconds)
+{
+    SKYBOUND_PROFILE_SCOPE("UploadAssets");
+
+    using Clock = std::chrono::steady_clock;
+    const Clock::time_point start = Clock::now();
+    int uploads = 0;
+
+    for (;;)
+    {
+        DecodedAsset next{};
+        {
+            const std::lock_guard<std::mutex> lock(queueMutex);
+            if (decoded.empty())
+            {
+                break;
+            }
+            next = decoded.front();
+            decoded.pop_front();
+        }
+
+        const auto found = entries.find(next.id);
+        if (found != entries.end())
+        {
+            Upload(found->second, next);
+        }
+        else
+        {
+            Discard(next);
+        }
+        uploads += 1;
+
+        if (std::chrono::duration<double>(Clock::now() - start).count() >= uploadSeconds)
+        {
+            break;
+        }
+    }
+
+    EvictOverBudget();
+    CountEntries();
+    stats.uploadsLastFrame = uploads;
+}
+
+void AssetManager::LoaderMain()
+{
+    for (;;)
+    {
+        LoadRequest request{};
+        {
+            std::unique_lock<std::mutex> lock(queueMutex);
+            wakeLoaders.wait(lock, [this]() { return !running || !requests.empty(); });
+            if (!running)
+            {
+                return;
+            }
+            request = std::move(requests.front());
+            requests.pop_front();
+        }
+
+        DecodedAsset result = Decode(request);
+
+        const std::lock_guard<std::mutex> lock(queueMutex);
+        if (!running)
+        {
+            Discard(result);
+            return;
+        }
+        decoded.push_back(result);
+    }
+}
+
+AssetManager::DecodedAsset AssetManager::Decode(const LoadRequest& request) const
+{
+    DecodedAsset result{};
+    result.id = request.id;
+
+    const std::string fullPath = root + "/" + request.path;
+    const char* extension = GetFileExtension(request.path.c_str());
+    if (extension == nullptr)
+    {
+        return result;
+    }
+
+    int size = 0;
+    unsigned char* data = LoadFileData(fullPath.c_str(), &size);
+    if (data == nullptr)
+    {
+        return result;
+    }
+
+    switch (request.type)
+    {
+        case AssetType::Texture:
+        {
+            result.image = LoadImageFromMemory(extension, data, size);
+            result.loaded = result.image.data != nullptr;
+            break;
+        }
+        case AssetType::Sound:
+        {
+            result.wave = LoadWaveFromMemory(extension, data, size);
+            result.loaded = result.wave.data != nullptr;
+            break;
+        }
+        case AssetType::Font:
+        {
+            // The same steps as LoadFontFromMemory, minus the texture upload.
+            result.glyphs = LoadFontData(data, size, request.fontSize, nullptr, FONT_GLYPH_COUNT, FONT_DEFAULT);
+            if (result.glyphs != nullptr)
+            {
+                result.glyphCount = FONT_GLYPH_COUNT;
+                result.image = GenImageFontAtlas(result.glyphs, &result.glyphRecs, result.glyphCount, request.fontSize, FONT_GLYPH_PADDING, 0);
+            }
+            result.loaded = result.image.data != nullptr;
+            break;
+        }
+        case AssetType::Music:
+        {
+            // Music decodes as it plays, straight from the file's bytes.
+            result.fileData = data;
+            result.fileSize = size;
+            result.loaded = true;
+            return result;
+        }
+    }
+
+    UnloadFileData(data);
+    return result;
+}
+
+void AssetManager::Upload(Entry& entry, DecodedAsset& asset)
+{
+    bool ready = false;
+    if (asset.loaded)
+    {
+        switch (entry.type)
+        {
+            case AssetType::Texture:
+            {
+                entry.texture = LoadTextureFromImage(asset.image);
+                entry.bytes = static_cast<std::size_t>(GetPixelDataSize(asset.image.width, asset.image.height, asset.image.format));
+                ready = entry.texture.id != 0;
+                break;
+            }
+            case AssetType::Sound:
+            {
+                entry.sound = LoadSoundFromWave(asset.wave);
+                entry.bytes = static_cast<std::size_t>(asset.wave.frameCount) * asset.wave.channels * (asset.wave.sampleSize / 8);
+                ready = IsSoundReady(entry.sound);
+                break;
+            }
+            case AssetType::Font:
+            {
+                entry.font.texture = LoadTextureFromImage(asset.image);
+                ready = entry.font.texture.id != 0;
+                if (ready)
+                {
+                    entry.font.baseSize = entry.fontSize;
+                    entry.font.glyphCount = asset.glyphCount;
+                    entry.font.glyphPadding = FONT_GLYPH_PADDING;
+                    entry.font.glyphs = asset.glyphs;
+                    entry.font.recs = asset.glyphRecs;
+                    entry.bytes = static_cast<std::size_t>(GetPixelDataSize(asset.image.width, asset.image.height, asset.image.format));
+                    asset.glyphs = nullptr;
+                    asset.glyphRecs = nullptr;
+                }
+                break;
+            }
+            case AssetType::Music:
+            {
+                entry.music = LoadMusicStreamFromMemory(GetFileExtension(entry.path.c_str()), asset.fileData, asset.fileSize);
+                ready = IsMusicReady(entry.music);
+                if (ready)
+                {
+                    entry.musicData = asset.fileData;
+                    entry.bytes = static_cast<std::size_t>(asset.fileSize);
+                    asset.fileData = nullptr;
+                }
+                break;
+            }
+        }
+    }
+    Discard(asset);
+
+    if (!ready)
+    {
+        entry.state = AssetState::Failed;
+        entry.bytes = 0;
+        TraceLog(LOG_WARNING, "ASSETS: Could not load %s", entry.path.c_str());
+        return;
+    }
+
+    entry.state = AssetState::Ready;
+    residentBytes += entry.bytes;
+}
+
+void AssetManager::Discard(DecodedAsset& asset)
+{
+    if (asset.image.data != nullptr)
+    {
+        UnloadImage(asset.image);
+        asset.image = Image{};
+    }
+    if (asset.wave.data != nullptr)
+    {
+        UnloadWave(asset.wave);
+        asset.wave = Wave{};
+    }
+    if (asset.glyphs != nullptr)
+    {
+        UnloadFontData(asset.glyphs, asset.glyphCount);
+        asset.glyphs = nullptr;
+    }
+    if (asset.glyphRecs != nullptr)
+    {
+        MemFree(asset.glyphRecs);
+        asset.glyphRecs = nullptr;
+    }
+    if (asset.fileData != nullptr)
+    {
+        UnloadFileData(asset.fileData);
+        asset.fileData = nullptr;
+    }
+}
+
+void AssetManager::Unload(Entry& entry)
+{
+    if (entry.state != AssetState::Ready)
+    {
+        return;
+    }
+
+    switch (entry.type)
+    {
+        case AssetType::Texture:
+            UnloadTexture(entry.texture);
+            break;
+        case AssetType::Sound:
+            UnloadSound(entry.sound);
+            break;
+        case AssetType::Font:
+            UnloadFont(entry.font);
+            break;
+        case AssetType::Music:
+            UnloadMusicStream(entry.music);
+            UnloadFileData(entry.musicData);
+            entry.musicData = nullptr;
+            break;
+    }
+
+    residentBytes -= entry.bytes;
+    entry.bytes = 0;
+    entry.state = AssetState::Failed;
+}
+
+void AssetManager::Erase(std::uint32_t id)
+{
+    const auto found = entries.find(id);
+    if (found == entries.end())
+    {
+        return;
+    }
+
+    Unload(found->second);
+    idsByKey.erase(found->second.key);
+    entries.erase(found);
+}
+
+void AssetManager::EvictOverBudget()
+{
+    while (residentBytes > memoryBudget)
+    {
+        std::uint32_t oldest = 0;
+        std::uint64_t oldestRelease = 0;
+        for (const auto& entry : entries)
+        {
+            const Entry& candidate = entry.second;
+            if (candidate.state == AssetState::Ready && candidate.references == 0 &&
+                (oldest == 0 || candidate.releasedAt < oldestRelease))
+            {
+                oldest = entry.first;
+                oldestRelease = candidate.releasedAt;
+            }
+        }
+
+        // Everything resident is in use; stay over budget rather than pull it.
+        if (oldest == 0)
+        {
+            return;
+        }
+
+        Erase(oldest);
+        stats.evicted += 1;
+    }
+}
+
+void AssetManager::CountEntries()
+{
+    stats.loading = 0;
+    stats.ready = 0;
+    stats.failed = 0;
+    stats.unreferenced = 0;
+    for (const auto& entry : entries)
+    {
+        switch (entry.second.state)
+        {
+            case AssetState::Loading: stats.loading += 1; break;
+            case AssetState::Ready: stats.ready += 1; break;
+            case AssetState::Failed: stats.failed += 1; break;
+        }
+        if (entry.second.state == AssetState::Ready && entry.second.references == 0)
+        {
+            stats.unreferenced += 1;
+        }
+    }
+    stats.residentBytes = residentBytes;
+}
+
+const AssetManager::Entry* AssetManager::Find(AssetHandle handle, AssetType type) const
+{
+    const auto found = entries.find(handle.id);
+    if (found == entries.end() || found->second.type != type || found->second.state != AssetState::Ready)
+    {
+        return nullptr;
+    }
+    return &found->second;
+}
@@ -0,0 +1,169 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "raylib.h"
+
+enum class AssetType
+{
+    Texture,
+    Sound,
+    Font,
+    // Streamed from its encoded bytes, which stay resident while it plays.
+    Music
+};
+
+enum class AssetState
+{
+    Loading,
+    Ready,
+    Failed
+};
+
+constexpr int DEFAULT_ASSET_LOADER_THREADS = 2;
+constexpr std::size_t DEFAULT_ASSET_MEMORY_BUDGET = 256u * 1024u * 1024u;
+// Main-thread time per frame for GPU and audio uploads; at least one upload
+// goes through every frame, so a single large asset cannot stall the queue.
+constexpr double DEFAULT_ASSET_UPLOAD_SECONDS = 0.002;
+constexpr int DEFAULT_ASSET_FONT_SIZE = 32;
+
+// Refers to one cached asset. Ids are never reused, so a handle to an evicted
+// asset just stops resolving.
+struct AssetHandle
+{
+    std::uint32_t id{0};
+
+    bool IsValid() const { return id != 0; }
+};
+
+struct AssetStats
+{
+    int loading{0};
+    int ready{0};
+    int failed{0};
+    // Ready but unreferenced: kept until the memory budget needs the room.
+    int unreferenced{0};
+    int evicted{0};
+    int uploadsLastFrame{0};
+    std::size_t residentBytes{0};
+};
+
+// Loads textures, sounds, fonts and music without blocking the frame. Loader
+// threads read and decode files into CPU-side images, waves and glyph atlases;
+// Update, on the main thread, turns a time-budgeted slice of those into GPU
+// textures and audio buffers each frame, since only the thread that owns the
+// GL context and audio device may create them.
+//
+// Assets are deduplicated by path (and size, for fonts) and reference counted.
+// Releasing the last reference leaves the asset cached; the least recently
+// released ones are unloaded once resident memory passes the budget.
+//
+// Everything except the loader threads runs on the main thread.
+class AssetManager
+{
+public:
+    AssetManager() = default;
+    ~AssetManager();
+
+    AssetManager(const AssetManager&) = delete;
+    AssetManager& operator=(const AssetManager&) = delete;
+
+    // Paths passed to Acquire are relative to `root`.
+    void Start(const std::string& root, int loaderThreads, std::size_t memoryBudget);
+    // Joins the loaders and unloads everything; call before closing the window
+    // and the audio device.
+    void Stop();
+
+    // Takes a reference, queueing the load if the asset is not cached.
+    AssetHandle Acquire(const std::string& path, AssetType type, int fontSize = DEFAULT_ASSET_FONT_SIZE);
+    void Release(AssetHandle handle);
+
+    // Failed for handles that no longer resolve.
+    AssetState GetState(AssetHandle handle) const;
+    // Null until the asset is ready, or if the handle is of another type.
+    const Texture2D* GetTexture(AssetHandle handle) const;
+    const Sound* GetSound(AssetHandle handle) const;
+    const Font* GetFont(AssetHandle handle) const;
+    const Music* GetMusic(AssetHandle handle) const;
+
+    // Once per frame: uploads decoded assets for up to `uploadSeconds`, then
+    // evicts unreferenced ones while over the memory budget.
+    void Update(double uploadSeconds);
+
+    const AssetStats& GetStats() const { return stats; }
+
+private:
+    struct LoadRequest
+    {
+        std::uint32_t id{0};
+        std::string path{};
+        AssetType type{AssetType::Texture};
+        int fontSize{0};
+    };
+
+    // CPU-side result of a load; which fields are set depends on the type.
+    struct DecodedAsset
+    {
+        std::uint32_t id{0};
+        bool loaded{false};
+        Image image{};
+        Wave wave{};
+        GlyphInfo* glyphs{nullptr};
+        int glyphCount{0};
+        Rectangle* glyphRecs{nullptr};
+        unsigned char* fileData{nullptr};
+        int fileSize{0};
+    };
+
+    struct Entry
+    {
+        std::string key{};
+        std::string path{};
+        AssetType type{AssetType::Texture};
+        AssetState state{AssetState::Loading};
+        int fontSize{0};
+        int references{0};
+        std::uint64_t releasedAt{0};
+        std::size_t bytes{0};
+        Texture2D texture{};
+        Sound sound{};
+        Font font{};
+        Music music{};
+        unsigned char* musicData{nullptr};
+    };
+
+    void LoaderMain();
+    DecodedAsset Decode(const LoadRequest& request) const;
+    void Upload(Entry& entry, DecodedAsset& decoded);
+    static void Discard(DecodedAsset& decoded);
+    void Unload(Entry& entry);
+    void Erase(std::uint32_t id);
+    void EvictOverBudget();
+    void CountEntries();
+    const Entry* Find(AssetHandle handle, AssetType type) const;
+
+    std::string root{};
+    std::size_t memoryBudget{DEFAULT_ASSET_MEMORY_BUDGET};
+    std::unordered_map<std::uint32_t, Entry> entries{};
+    std::unordered_map<std::string, std::uint32_t> idsByKey{};
+    std::uint32_t nextId{1};
+    std::uint64_t releaseCounter{0};
+    std::size_t residentBytes{0};
+    AssetStats stats{};
+
+    // Shared with the loader threads.
+    std::mutex queueMutex{};
+    std::condition_variable wakeLoaders{};
+    std::deque<LoadRequest> requests{};
+    std::deque<DecodedAsset> decoded{};
+    bool running{false};
+    std::vector<std::thread> loaders{};
+};
@@ -0,0 +1,465 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "coin.h"
+#include "collision.h"
+#include "enemy.h"
+#include "entity_store.h"
+#include "input_state.h"
+#include "job_system.h"
+#include "lod.h"
+#include "particles.h"
+#include "platform.h"
+#include "player.h"
+#include "random.h"
+#include "simulation.h"
+#include "spatial_grid.h"
+#include "weather.h"
+
+namespace
+{
+    // Roughly the density of a hand-built level: this many of each entity type
+    // per streaming chunk, so larger scenes get wider rather than more crowded.
+    constexpr float ENTITIES_PER_CHUNK = 16.0f;
+    constexpr float BENCH_STEP = SIMULATION_STEP;
+    constexpr int RESOLVE_PROBES = 1024;
+    // About a screen's width, the longest sight line gameplay code asks for.
+    constexpr Vector2 CAST_REACH{640.0f, 120.0f};
+
+    struct BenchOptions
+    {
+        std::vector<int> sizes{10, 100, 1000, 10000, 100000};
+        double minSeconds{0.25};
+        std::uint32_t seed{Random::DEFAULT_SEED};
+        const char* filter{nullptr};
+        bool csv{false};
+        int workerThreads{0};
+    };
+
+    void PrintUsage(const char* program)
+    {
+        std::printf("Usage: %s [--sizes N,N,...] [--min-time SECONDS] [--seed S] [--filter TEXT] [--csv]\n"
+                    "          [--threads N]\n"
+                    "Times each kernel over generated scenes of every size and reports ns per call,\n"
+                    "ns per entity and how the call cost grew from the previous size. --threads runs\n"
+                    "the kernels on that many job system workers.\n",
+                    program);
+    }
+
+    bool ParseSizes(const char* text, std::vector<int>& sizes)
+    {
+        sizes.clear();
+        const char* cursor = text;
+        while (*cursor != '\0')
+        {
+            char* end = nullptr;
+            const long value = std::strtol(cursor, &end, 10);
+            if (end == cursor || value <= 0)
+            {
+                return false;
+            }
+            sizes.push_back(static_cast<int>(value));
+            cursor = *end == ',' ? end + 1 : end;
+        }
+        return !sizes.empty();
+    }
+
+    bool ParseArguments(int argc, char** argv, BenchOptions& options)
+    {
+        for (int i = 1; i < argc; ++i)
+        {
+            const char* arg = argv[i];
+            const bool hasValue = i + 1 < argc;
+
+            if (std::strcmp(arg, "--sizes") == 0 && hasValue)
+            {
+                if (!ParseSizes(argv[++i], options.sizes))
+                {
+                    return false;
+                }
+            }
+            else if (std::strcmp(arg, "--min-time") == 0 && hasValue)
+            {
+                options.minSeconds = std::strtod(argv[++i], nullptr);
+            }
+            else if (std::strcmp(arg, "--seed") == 0 && hasValue)
+            {
+                options.seed = static_cast<std::uint32_t>(std::strtoul(argv[++i], nullptr, 0));
+            }
+            else if (std::strcmp(arg, "--filter") == 0 && hasValue)
+            {
+                options.filter = argv[++i];
+            }
+            else if (std::strcmp(arg, "--csv") == 0)
+            {
+                options.csv = true;
+            }
+            else if (std::strcmp(arg, "--threads") == 0 && hasValue)
+            {
+                options.workerThreads = std::atoi(argv[++i]);
+            }
+            else
+            {
+                return false;
+            }
+        }
+
+        return options.minSeconds > 0.0 && options.workerThreads >= 0;
+    }
+
+    struct Scene
+    {
+        float width{0.0f};
+        PlatformStore platforms{};
+        EnemyStore enemies{};
+        std::vector<Coin> coins{};
+        SpatialGrid platformGrid{};
+        SpatialGrid enemyGrid{};
+        SpatialGrid coinGrid{};
+    };
+
+    // `count` of each entity type spread across a level-like strip; half the
+    // platforms move.
+    Scene MakeScene(int count, std::uint32_t seed)
+    {
+        Random rng(seed);
+        Scene scene;
+        scene.width = std::max(1.0f, static_cast<float>(count) / ENTITIES_PER_CHUNK) * WORLD_CHUNK_WIDTH;
+
+        scene.platforms.Reserve(static_cast<std::size_t>(count), static_cast<std::size_t>(count / 2 + 1));
+        scene.enemies.Reserve(static_cast<std::size_t>(count));
+        scene.coins.reserve(static_cast<std::size_t>(count));
+
+        for (int i = 0; i < count; ++i)
+        {
+            Platform platform{};
+            platform.bounds = {rng.Uniform(0.0f, scene.width), rng.Uniform(-600.0f, 400.0f), rng.Uniform(80.0f, 260.0f), 20.0f};
+            platform.startPosition = {platform.bounds.x, platform.bounds.y};
+            platform.endPosition = platform.startPosition;
+            if (i % 2 == 1)
+            {
+                platform.endPosition.x += rng.Uniform(-240.0f, 240.0f);
+                platform.endPosition.y += rng.Uniform(-120.0f, 120.0f);
+                platform.travelTime = rng.Uniform(1.5f, 5.0f);
+                platform.moving = true;
+            }
+            scene.platforms.Push(platform);
+
+            Enemy enemy{};
+            const float x = rng.Uniform(0.0f, scene.width);
+            enemy.bounds = {x, rng.Uniform(-600.0f, 400.0f), 32.0f, 32.0f};
+            enemy.leftLimit = x - rng.Uniform(60.0f, 240.0f);
+            enemy.rightLimit = x + 32.0f + rng.Uniform(60.0f, 240.0f);
+            enemy.speed = rng.Uniform(50.0f, 140.0f);
+            enemy.direction = rng.Range(0, 1) == 0 ? -1 : 1;
+            scene.enemies.Push(enemy);
+
+            Coin coin{};
+            coin.position = {rng.Uniform(0.0f, scene.width), rng.Uniform(-600.0f, 400.0f)};
+            scene.coins.push_back(coin);
+        }
+
+        for (std::size_t i = 0; i < scene.platforms.Size(); ++i)
+        {
+            scene.platformGrid.Insert(static_cast<int>(i), scene.platforms.GetBounds(i));
+        }
+        for (std::size_t i = 0; i < scene.enemies.Size(); ++i)
+        {
+            scene.enemyGrid.Insert(static_cast<int>(i), scene.enemies.GetBounds(i));
+        }
+        for (std::size_t i = 0; i < scene.coins.size(); ++i)
+        {
+            scene.coinGrid.Insert(static_cast<int>(i), GetCoinBounds(scene.coins[i]));
+        }
+
+        return scene;
+    }
+
+    // Positions scattered over the scene; enough that the probe loop does not
+    // just hit the same few cache lines.
+    std::vector<Vector2> MakeProbes(const Scene& scene, std::uint32_t seed)
+    {
+        Random rng(seed ^ 0x9E0B5u);
+        std::vector<Vector2> probes(RESOLVE_PROBES);
+        for (Vector2& probe : probes)
+        {
+            probe = {rng.Uniform(0.0f, scene.width), rng.Uniform(-620.0f, 420.0f)};
+        }
+        return probes;
+    }
+
+    Player MakeFallingPlayer(Vector2 position)
+    {
+        Player player{};
+        player.position = position;
+        player.previousPosition = {position.x - 2.0f, position.y - 6.0f};
+        player.velocity = {120.0f, 420.0f};
+        // Keeps UpdateEnemies on its movement path instead of repeatedly hitting.
+        player.invincibilityTimer = 1.0e9f;
+        return player;
+    }
+
+    struct Measurement
+    {
+        double nsPerOp{0.0};
+        long long ops{0};
+    };
+
+    // Calls `op` in growing batches until minSeconds of timed work. `reset`
+    // runs between batches, untimed, to put mutated scenes back.
+    Measurement Measure(double minSeconds, const std::function<void()>& op, const std::function<void()>& reset)
+    {
+        using Clock = std::chrono::steady_clock;
+
+        op();
+        reset();
+
+        long long batch = 1;
+        long long ops = 0;
+        double seconds = 0.0;
+        while (seconds < minSeconds)
+        {
+            const auto start = Clock::now();
+            for (long long i = 0; i < batch; ++i)
+            {
+                op();
+            }
+            seconds += std::chrono::duration<double>(Clock::now() - start).count();
+            ops += batch;
+            reset();
+
+            if (batch < (1 << 20))
+            {
+                batch *= 2;
+            }
+        }
+
+        return {seconds * 1.0e9 / static_cast<double>(ops), ops};
+    }
+
+    struct Benchmark
+    {
+        const char* name;
+        // Builds the per-size state and returns the measurement.
+        std::function<Measurement(int size, const BenchOptions& options)> run;
+    };
+
+    std::vector<Benchmark> MakeBenchmarks()
+    {
+        std::vector<Benchmark> benchmarks;
+
+        benchmarks.push_back({"UpdatePlayerPhysics", [](int size, const BenchOptions& options)
+        {
+            std::vector<Player> players(static_cast<std::size_t>(size));
+            auto reset = [&players]()
+            {
+                for (std::size_t i = 0; i < players.size(); ++i)
+                {
+                    players[i] = MakeFallingPlayer({static_cast<float>(i) * 40.0f, 0.0f});
+                }
+            };
+            reset();
+            return Measure(options.minSeconds, [&players]()
+            {
+                for (Player& player : players)
+                {
+                    UpdatePlayerPhysics(player, 780.0f, BENCH_STEP, {35.0f, 20.0f});
+                }
+            }, reset);
+        }});
+
+        benchmarks.push_back({"ResolvePlayerPlatforms", [](int size, const BenchOptions& options)
+        {
+            const Scene scene = MakeScene(size, options.seed);
+            const std::vector<Vector2> probes = MakeProbes(scene, options.seed);
+            std::size_t next = 0;
+            // One op is one player resolve against the whole scene.
+            return Measure(options.minSeconds, [&]()
+            {
+                Player player = MakeFallingPlayer(probes[next]);
+                next = (next + 1) % probes.size();
+                ResolvePlayerPlatforms(player, scene.platforms, scene.platformGrid);
+            }, []() {});
+        }});
+
+        benchmarks.push_back({"CastSegment", [](int size, const BenchOptions& options)
+        {
+            const Scene scene = MakeScene(size, options.seed);
+            const std::vector<Vector2> probes = MakeProbes(scene, options.seed);
+            std::size_t next = 0;
+            std::vector<int> candidates{};
+            // One op is one sight line against the whole scene.
+            return Measure(options.minSeconds, [&]()
+            {
+                const Vector2 from = probes[next];
+                next = (next + 1) % probes.size();
+                CastHit hit{};
+                CastSegment(scene.platforms, scene.platformGrid, from, {from.x + CAST_REACH.x, from.y + CAST_REACH.y}, hit, candidates);
+            }, []() {});
+        }});
+
+        benchmarks.push_back({"UpdatePlatforms", [](int size, const BenchOptions& options)
+        {
+            Scene scene = MakeScene(size, options.seed);
+            return Measure(options.minSeconds, [&scene]()
+            {
+                UpdatePlatforms(scene.platforms, scene.platformGrid, BENCH_STEP);
+            }, []() {});
+        }});
+
+        benchmarks.push_back({"UpdateEnemies", [](int size, const BenchOptions& options)
+        {
+            Scene scene = MakeScene(size, options.seed);
+            Player player = MakeFallingPlayer({scene.width * 0.5f, 0.0f});
+            return Measure(options.minSeconds, [&]()
+            {
+                UpdateEnemies(scene.enemies, scene.enemyGrid, player, BENCH_STEP);
+            }, []() {});
+        }});
+
+        // The same kernels watched from the middle of the scene, as the
+        // simulation runs them; far entities drop to reduced rate or sleep.
+        benchmarks.push_back({"UpdatePlatformsLod", [](int size, const BenchOptions& options)
+        {
+            Scene scene = MakeScene(size, options.seed);
+            LodFocus focus{};
+            focus.x = scene.width * 0.5f;
+            focus.enabled = true;
+            return Measure(options.minSeconds, [&]()
+            {
+                UpdatePlatforms(scene.platforms, scene.platformGrid, BENCH_STEP, focus);
+            }, []() {});
+        }});
+
+        benchmarks.push_back({"MoveEnemiesLod", [](int size, const BenchOptions& options)
+        {
+            Scene scene = MakeScene(size, options.seed);
+            LodFocus focus{};
+            focus.x = scene.width * 0.5f;
+            focus.enabled = true;
+            return Measure(options.minSeconds, [&]()
+            {
+                MoveEnemies(scene.enemies, scene.enemyGrid, BENCH_STEP, focus);
+            }, []() {});
+        }});
+
+        benchmarks.push_back({"CheckCoinCollection", [](int size, const BenchOptions& options)
+        {
+            Scene scene = MakeScene(size, options.seed);
+            const std::vector<Vector2> probes = MakeProbes(scene, options.seed);
+            std::size_t next = 0;
+            auto reset = [&scene]()
+            {
+                for (std::size_t i = 0; i < scene.coins.size(); ++i)
+                {
+                    if (scene.coins[i].collected)
+                    {
+                        scene.coins[i].collected = false;
+                        scene.coinGrid.Insert(static_cast<int>(i), GetCoinBounds(scene.coins[i]));
+                    }
+                }
+            };
+            // One op is one player's collection check against the whole scene.
+            return Measure(options.minSeconds, [&]()
+            {
+                Player player = MakeFallingPlayer(probes[next]);
+                next = (next + 1) % probes.size();
+                CheckCoinCollection(scene.coins, scene.coinGrid, player);
+            }, reset);
+        }});
+
+        benchmarks.push_back({"RainUpdate", [](int size, const BenchOptions& options)
+        {
+            // The same forces and respawn UpdateWeather applies in a storm, at
+            // `size` drops instead of RAIN_DROP_COUNT.
+            const Vector2 view{1600.0f, 900.0f};
+            ParticleSystem rain(size, options.seed);
+            ParticleEmitter emitter{};
+            emitter.area = {-view.x * 0.25f, -view.y, view.x * 1.5f, view.y * 2.0f};
+            emitter.minVelocity = {0.0f, 380.0f};
+            emitter.maxVelocity = {0.0f, 650.0f};
+            emitter.minLife = 1.0e30f;
+            emitter.maxLife = 1.0e30f;
+            emitter.minSize = 14.0f;
+            emitter.maxSize = 26.0f;
+            rain.Spawn(emitter, size);
+
+            ParticleForces forces{};
+            forces.floor = view.y;
+            forces.drift.x = 90.0f * 0.15f;
+            forces.speedScale = 2.25f;
+            forces.wrapMinX = -view.x * 0.4f;
+            forces.wrapMaxX = view.x * 1.4f;
+
+            ParticleEmitter respawn = emitter;
+            respawn.area.height = view.y;
+            return Measure(options.minSeconds, [&]()
+            {
+                rain.Update(forces, BENCH_STEP);
+                rain.Spawn(respawn, size - rain.GetCount());
+            }, []() {});
+        }});
+
+        return benchmarks;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    BenchOptions options{};
+    if (!ParseArguments(argc, argv, options))
+    {
+        PrintUsage(argv[0]);
+        return 1;
+    }
+
+    JobSystem::Get().Start(options.workerThreads, false);
+
+    if (options.csv)
+    {
+        std::printf("kernel,entities,ns_per_op,ns_per_entity,ops\n");
+    }
+    else
+    {
+        std::printf("%-24s %10s %14s %12s %10s\n", "kernel", "entities", "ns/op", "ns/entity", "x prev");
+    }
+
+    for (const Benchmark& benchmark : MakeBenchmarks())
+    {
+        if (options.filter != nullptr && std::strstr(benchmark.name, options.filter) == nullptr)
+        {
+            continue;
+        }
+
+        double previous = 0.0;
+        for (const int size : options.sizes)
+        {
+            const Measurement result = benchmark.run(size, options);
+            const double perEntity = result.nsPerOp / static_cast<double>(size);
+
+            if (options.csv)
+            {
+                std::printf("%s,%d,%.2f,%.4f,%lld\n", benchmark.name, size, result.nsPerOp, perEntity, result.ops);
+            }
+            else if (previous > 0.0)
+            {
+                std::printf("%-24s %10d %14.1f %12.3f %9.2fx\n", benchmark.name, size, result.nsPerOp, perEntity, result.nsPerOp / previous);
+            }
+            else
+            {
+                std::printf("%-24s %10d %14.1f %12.3f %10s\n", benchmark.name, size, result.nsPerOp, perEntity, "-");
+            }
+            std::fflush(stdout);
+            previous = result.nsPerOp;
+        }
+    }
+
+    JobSystem::Get().Stop();
+    return 0;
+}
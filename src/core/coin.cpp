@@ -2,26 +2,33 @@
 
 #include <algorithm>
 
+#include "geometry.h"
 #include "player.h"
+#include "spatial_grid.h"
 
-int CheckCoinCollection(std::vector<Coin>& coins, Player& player)
+Rectangle GetCoinBounds(const Coin& coin)
+{
+    return {coin.position.x - coin.radius, coin.position.y - coin.radius,
+            coin.radius * 2.0f, coin.radius * 2.0f};
+}
+
+int CheckCoinCollection(std::vector<Coin>& coins, SpatialGrid& grid, Player& player)
 {
     const Rectangle playerBounds = GetPlayerBounds(player);
     int collectedThisFrame = 0;
 
-    for (Coin& coin : coins)
+    for (const int index : grid.Query(playerBounds))
     {
+        Coin& coin = coins[static_cast<std::size_t>(index)];
         if (coin.collected)
         {
             continue;
         }
 
-        const Rectangle coinRect{coin.position.x - coin.radius, coin.position.y - coin.radius,
-                                 coin.radius * 2.0f, coin.radius * 2.0f};
-
-        if (CheckCollisionRecs(playerBounds, coinRect))
+        if (RectsOverlap(playerBounds, GetCoinBounds(coin)))
         {
             coin.collected = true;
+            grid.Remove(index);
             ++collectedThisFrame;
             player.comboCount += 1;
             player.comboTimer = player.comboWindow;
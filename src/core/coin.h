@@ -0,0 +1,21 @@
+#pragma once
+
+#include <vector>
+
+#include "raylib.h"
+
+class SpatialGrid;
+
+struct Coin
+{
+    Vector2 position{};
+    float radius{12.0f};
+    bool collected{false};
+};
+
+Rectangle GetCoinBounds(const Coin& coin);
+
+// Collected coins are dropped from the grid so later ticks never revisit them.
+int CheckCoinCollection(std::vector<Coin>& coins, SpatialGrid& grid, struct Player& player);
+
+
@@ -0,0 +1,106 @@
+#include "collision.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include "entity_store.h"
+#include "spatial_grid.h"
+
+namespace
+{
+    // When one axis of the box meets the target's span, as fractions of the
+    // motion. False when it never does.
+    bool SweepAxis(float start, float size, float motion, float targetStart, float targetSize, float& entry, float& exit)
+    {
+        const float end = start + size;
+        const float targetEnd = targetStart + targetSize;
+        if (motion == 0.0f)
+        {
+            if (end <= targetStart || start >= targetEnd)
+            {
+                return false;
+            }
+            entry = -std::numeric_limits<float>::infinity();
+            exit = std::numeric_limits<float>::infinity();
+            return true;
+        }
+
+        float entryDistance = motion > 0.0f ? targetStart - end : start - targetEnd;
+        const float exitDistance = motion > 0.0f ? targetEnd - start : end - targetStart;
+        if (entryDistance < 0.0f && entryDistance >= -COLLISION_SKIN)
+        {
+            entryDistance = 0.0f;
+        }
+        const float speed = std::fabs(motion);
+        entry = entryDistance / speed;
+        exit = exitDistance / speed;
+        return true;
+    }
+}
+
+bool SweepBox(const Rectangle& box, Vector2 motion, const Rectangle& target, SweepHit& hit)
+{
+    float entryX = 0.0f;
+    float exitX = 0.0f;
+    float entryY = 0.0f;
+    float exitY = 0.0f;
+    if (!SweepAxis(box.x, box.width, motion.x, target.x, target.width, entryX, exitX) ||
+        !SweepAxis(box.y, box.height, motion.y, target.y, target.height, entryY, exitY))
+    {
+        return false;
+    }
+
+    const float entry = std::max(entryX, entryY);
+    const float exit = std::min(exitX, exitY);
+    if (entry < 0.0f || entry > 1.0f || entry >= exit)
+    {
+        return false;
+    }
+
+    hit.time = entry;
+    if (entryY >= entryX)
+    {
+        hit.normal = {0.0f, motion.y > 0.0f ? -1.0f : 1.0f};
+    }
+    else
+    {
+        hit.normal = {motion.x > 0.0f ? -1.0f : 1.0f, 0.0f};
+    }
+    return true;
+}
+
+bool CastBox(const PlatformStore& platforms, const SpatialGrid& grid, const Rectangle& box, Vector2 motion, CastHit& hit,
+             std::vector<int>& candidates)
+{
+    hit = CastHit{};
+    // Candidates come back in index order, so ties go to the lowest index.
+    grid.Query(GetSweptBounds(box, motion), candidates);
+    for (const int index : candidates)
+    {
+        SweepHit contact{};
+        if (SweepBox(box, motion, platforms.GetBounds(static_cast<std::size_t>(index)), contact) &&
+            (hit.platform < 0 || contact.time < hit.time))
+        {
+            hit.platform = index;
+            hit.time = contact.time;
+            hit.normal = contact.normal;
+        }
+    }
+    return hit.platform >= 0;
+}
+
+bool CastSegment(const PlatformStore& platforms, const SpatialGrid& grid, Vector2 from, Vector2 to, CastHit& hit,
+                 std::vector<int>& candidates)
+{
+    return CastBox(platforms, grid, Rectangle{from.x, from.y, 0.0f, 0.0f}, {to.x - from.x, to.y - from.y}, hit, candidates);
+}
+
+Rectangle GetSweptBounds(const Rectangle& box, Vector2 motion, float margin)
+{
+    const float left = std::min(box.x, box.x + motion.x) - margin;
+    const float top = std::min(box.y, box.y + motion.y) - margin;
+    const float right = std::max(box.x, box.x + motion.x) + box.width + margin;
+    const float bottom = std::max(box.y, box.y + motion.y) + box.height + margin;
+    return {left, top, right - left, bottom - top};
+}
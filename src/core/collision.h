@@ -0,0 +1,46 @@
+#pragma once
+
+#include <vector>
+
+#include "raylib.h"
+
+struct PlatformStore;
+class SpatialGrid;
+
+// Boxes that start this far inside a surface, or less, still count as just
+// touching it, which absorbs the rounding left behind by earlier snaps.
+constexpr float COLLISION_SKIN = 0.01f;
+
+struct SweepHit
+{
+    // Fraction of the motion covered before contact, in [0, 1].
+    float time{1.0f};
+    // Points away from the surface that was hit, along one axis.
+    Vector2 normal{};
+};
+
+// First contact of `box` moving by `motion` with a fixed `target`. Boxes that
+// already overlap by more than COLLISION_SKIN have no first contact and are
+// not reported; neither is motion that only slides along a touching face.
+// A tie between axes reports the vertical face.
+bool SweepBox(const Rectangle& box, Vector2 motion, const Rectangle& target, SweepHit& hit);
+
+struct CastHit
+{
+    // Platform index, or -1.
+    int platform{-1};
+    float time{1.0f};
+    Vector2 normal{};
+};
+
+// First platform `box` touches moving by `motion`, as the platforms stand now.
+// Platforms the box starts inside are ignored. The grid is queried into
+// `candidates`, so threads with buffers of their own can cast at once.
+bool CastBox(const PlatformStore& platforms, const SpatialGrid& grid, const Rectangle& box, Vector2 motion, CastHit& hit,
+             std::vector<int>& candidates);
+// CastBox for a point; nothing between `from` and `to` when it returns false.
+bool CastSegment(const PlatformStore& platforms, const SpatialGrid& grid, Vector2 from, Vector2 to, CastHit& hit,
+                 std::vector<int>& candidates);
+
+// The area `box` covers moving by `motion`, widened by `margin` on every side.
+Rectangle GetSweptBounds(const Rectangle& box, Vector2 motion, float margin = 0.0f);
@@ -0,0 +1,85 @@
+#include "effects.h"
+
+#include <algorithm>
+
+#include "random.h"
+
+namespace
+{
+    constexpr float DUST_GRAVITY = 420.0f;
+    constexpr float SPARKLE_GRAVITY = -60.0f;
+    constexpr float HIT_GRAVITY = 640.0f;
+    constexpr int SPARKLES_PER_COIN = 14;
+    constexpr int HIT_PARTICLES = 24;
+}
+
+void InitEffects(EffectState& effects, Random& rng)
+{
+    effects.dust.Seed(rng.NextU32());
+    effects.sparkle.Seed(rng.NextU32());
+    effects.hit.Seed(rng.NextU32());
+    ClearEffects(effects);
+}
+
+void ClearEffects(EffectState& effects)
+{
+    effects.dust.Clear();
+    effects.sparkle.Clear();
+    effects.hit.Clear();
+}
+
+void UpdateEffects(EffectState& effects, float dt)
+{
+    ParticleForces forces{};
+
+    forces.acceleration = {0.0f, DUST_GRAVITY};
+    effects.dust.Update(forces, dt);
+
+    forces.acceleration = {0.0f, SPARKLE_GRAVITY};
+    effects.sparkle.Update(forces, dt);
+
+    forces.acceleration = {0.0f, HIT_GRAVITY};
+    effects.hit.Update(forces, dt);
+}
+
+void EmitLandingDust(EffectState& effects, Vector2 feet, float impactSpeed)
+{
+    // Harder landings kick up more and faster dust.
+    const float strength = std::clamp(impactSpeed / 600.0f, 0.2f, 1.0f);
+
+    ParticleEmitter emitter{};
+    emitter.area = {feet.x - 14.0f, feet.y - 3.0f, 28.0f, 3.0f};
+    emitter.minVelocity = {-120.0f * strength, -110.0f * strength};
+    emitter.maxVelocity = {120.0f * strength, -20.0f};
+    emitter.minLife = 0.25f;
+    emitter.maxLife = 0.55f;
+    emitter.minSize = 2.0f;
+    emitter.maxSize = 4.5f;
+    effects.dust.Spawn(emitter, 6 + static_cast<int>(strength * 14.0f));
+}
+
+void EmitCoinSparkle(EffectState& effects, Vector2 position, int coins)
+{
+    ParticleEmitter emitter{};
+    emitter.area = {position.x - 8.0f, position.y - 8.0f, 16.0f, 16.0f};
+    emitter.minVelocity = {-150.0f, -170.0f};
+    emitter.maxVelocity = {150.0f, 90.0f};
+    emitter.minLife = 0.3f;
+    emitter.maxLife = 0.7f;
+    emitter.minSize = 2.0f;
+    emitter.maxSize = 4.0f;
+    effects.sparkle.Spawn(emitter, SPARKLES_PER_COIN * std::max(coins, 1));
+}
+
+void EmitEnemyHit(EffectState& effects, Vector2 position)
+{
+    ParticleEmitter emitter{};
+    emitter.area = {position.x - 10.0f, position.y - 12.0f, 20.0f, 24.0f};
+    emitter.minVelocity = {-260.0f, -320.0f};
+    emitter.maxVelocity = {260.0f, 40.0f};
+    emitter.minLife = 0.35f;
+    emitter.maxLife = 0.6f;
+    emitter.minSize = 3.0f;
+    emitter.maxSize = 5.5f;
+    effects.hit.Spawn(emitter, HIT_PARTICLES);
+}
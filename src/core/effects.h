@@ -0,0 +1,26 @@
+#pragma once
+
+#include "raylib.h"
+
+#include "particles.h"
+
+class Random;
+
+constexpr int EFFECT_PARTICLE_CAPACITY = 2048;
+
+// World-space gameplay effects. Purely visual: nothing reads them back into
+// the simulation, and each system draws from its own RNG.
+struct EffectState
+{
+    ParticleSystem dust{EFFECT_PARTICLE_CAPACITY};
+    ParticleSystem sparkle{EFFECT_PARTICLE_CAPACITY};
+    ParticleSystem hit{EFFECT_PARTICLE_CAPACITY};
+};
+
+void InitEffects(EffectState& effects, Random& rng);
+void ClearEffects(EffectState& effects);
+void UpdateEffects(EffectState& effects, float dt);
+
+void EmitLandingDust(EffectState& effects, Vector2 feet, float impactSpeed);
+void EmitCoinSparkle(EffectState& effects, Vector2 position, int coins);
+void EmitEnemyHit(EffectState& effects, Vector2 position);
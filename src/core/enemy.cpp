@@ -0,0 +1,187 @@
+#include "enemy.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "entity_store.h"
+#include "geometry.h"
+#include "job_system.h"
+#include "player.h"
+#include "profiler.h"
+#include "spatial_grid.h"
+
+namespace
+{
+    constexpr std::size_t PATROL_JOB_GRAIN = 4096;
+
+    // Steps to cover `distance`, counting the one that clamps onto the end.
+    int GetPatrolLegLength(double distance, float stride)
+    {
+        return static_cast<int>(distance / static_cast<double>(stride)) + 1;
+    }
+}
+
+PatrolLeg GetPatrolLeg(float x, float direction, int ticks, float stride, float left, float right)
+{
+    PatrolLeg leg{};
+    if (right <= left)
+    {
+        leg.from = left;
+        return leg;
+    }
+
+    leg.from = std::min(std::max(x, left), right);
+    leg.direction = direction < 0.0f ? -1.0f : 1.0f;
+    if (stride <= 0.0f)
+    {
+        return leg;
+    }
+
+    const double ahead = leg.direction > 0.0f ? static_cast<double>(right) - leg.from : static_cast<double>(leg.from) - left;
+    leg.length = GetPatrolLegLength(ahead, stride);
+    leg.ticks = std::max(ticks, 0);
+    if (leg.ticks < leg.length)
+    {
+        return leg;
+    }
+
+    const int length = GetPatrolLegLength(static_cast<double>(right) - left, stride);
+    const int sinceTurn = leg.ticks - leg.length;
+    const int laps = sinceTurn / length;
+    leg.direction = laps % 2 == 0 ? -leg.direction : leg.direction;
+    leg.from = leg.direction > 0.0f ? left : right;
+    leg.ticks = sinceTurn - laps * length;
+    leg.length = length;
+    return leg;
+}
+
+void StepPatrolLeg(PatrolLeg& leg, float stride, float left, float right)
+{
+    if (leg.length == 0 || ++leg.ticks < leg.length)
+    {
+        return;
+    }
+
+    leg.direction = -leg.direction;
+    leg.from = leg.direction > 0.0f ? left : right;
+    leg.ticks = 0;
+    leg.length = GetPatrolLegLength(static_cast<double>(right) - left, stride);
+}
+
+float GetPatrolX(const PatrolLeg& leg, float stride)
+{
+    // In double, so the same leg gives the same x however it was reached.
+    return static_cast<float>(static_cast<double>(leg.from) + static_cast<double>(leg.direction) * stride * leg.ticks);
+}
+
+void MoveEnemies(EnemyStore& enemies, SpatialGrid& grid, float dt, const LodFocus& focus)
+{
+    SKYBOUND_PROFILE_SCOPE("MoveEnemies");
+    enemies.Advance(dt);
+    const int clock = enemies.clock;
+
+    enemies.lod = LodCounts{};
+    enemies.due.clear();
+    for (std::size_t i = 0; i < enemies.Size(); ++i)
+    {
+        const LodTier tier = GetLodTier(focus, enemies.leftLimit[i], enemies.rightLimit[i]);
+        if (IsLodDue(tier, clock, i, enemies.lod))
+        {
+            enemies.due.push_back(static_cast<int>(i));
+        }
+    }
+
+    const int* due = enemies.due.data();
+    const float* width = enemies.width.data();
+    const float* speed = enemies.speed.data();
+    const float* leftLimit = enemies.leftLimit.data();
+    const float* rightLimit = enemies.rightLimit.data();
+    int* updatedTick = enemies.updatedTick.data();
+    float* legFrom = enemies.legFrom.data();
+    float* direction = enemies.direction.data();
+    int* legTicks = enemies.legTicks.data();
+    int* legLength = enemies.legLength.data();
+    float* x = enemies.x.data();
+    float* previousX = enemies.previousX.data();
+    const EnemyStore* store = &enemies;
+
+    // Rows that were updated last tick take one step along their leg; the
+    // rest are solved from their anchors. Both land on the same leg, so the
+    // same x. Rows are independent, so large sets split across workers.
+    ParallelFor(enemies.due.size(), PATROL_JOB_GRAIN, [=](std::size_t begin, std::size_t end)
+    {
+        for (std::size_t k = begin; k < end; ++k)
+        {
+            const std::size_t i = static_cast<std::size_t>(due[k]);
+            const float stride = speed[i] * dt;
+            PatrolLeg leg{legFrom[i], direction[i], legTicks[i], legLength[i]};
+            if (updatedTick[i] == clock - 1)
+            {
+                previousX[i] = x[i];
+                StepPatrolLeg(leg, stride, leftLimit[i], rightLimit[i] - width[i]);
+            }
+            else
+            {
+                previousX[i] = GetPatrolX(store->GetLegAt(i, clock - 1), stride);
+                leg = store->GetLegAt(i, clock);
+            }
+
+            legFrom[i] = leg.from;
+            direction[i] = leg.direction;
+            legTicks[i] = leg.ticks;
+            legLength[i] = leg.length;
+            x[i] = GetPatrolX(leg, stride);
+            updatedTick[i] = clock;
+        }
+    });
+
+    for (const int index : enemies.due)
+    {
+        grid.Update(index, enemies.GetBounds(static_cast<std::size_t>(index)));
+    }
+}
+
+void ResolveEnemyHits(const EnemyStore& enemies, const SpatialGrid& grid, Player& player)
+{
+    SKYBOUND_PROFILE_SCOPE("ResolveEnemyHits");
+    if (player.invincibilityTimer > 0.0f)
+    {
+        return;
+    }
+
+    // A hit grants invincibility, so at most the first overlapping enemy in index
+    // order applies, exactly as when the check was interleaved with movement.
+    const Rectangle playerBounds = GetPlayerBounds(player);
+    for (const int index : grid.Query(playerBounds))
+    {
+        const std::size_t enemy = static_cast<std::size_t>(index);
+        if (!RectsOverlap(enemies.GetBounds(enemy), playerBounds))
+        {
+            continue;
+        }
+
+        player.lives = std::max(0, player.lives - enemies.damage[enemy]);
+        player.invincibilityTimer = 1.0f;
+
+        if (player.velocity.y < 0.0f)
+        {
+            player.velocity.y = 0.0f;
+        }
+
+        player.position.x = player.previousPosition.x;
+        player.position.y = player.previousPosition.y;
+        player.velocity.x = 0.0f;
+        player.velocity.y = 0.0f;
+        player.comboCount = 0;
+        player.comboTimer = 0.0f;
+        break;
+    }
+}
+
+void UpdateEnemies(EnemyStore& enemies, SpatialGrid& grid, Player& player, float dt)
+{
+    SKYBOUND_PROFILE_SCOPE("UpdateEnemies");
+
+    MoveEnemies(enemies, grid, dt);
+    ResolveEnemyHits(enemies, grid, player);
+}
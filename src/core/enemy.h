@@ -0,0 +1,48 @@
+#pragma once
+
+#include <vector>
+
+#include "raylib.h"
+
+#include "lod.h"
+
+class SpatialGrid;
+struct EnemyStore;
+
+struct Enemy
+{
+    Rectangle bounds{};
+    float speed{80.0f};
+    float leftLimit{0.0f};
+    float rightLimit{0.0f};
+    int damage{1};
+    int direction{1};
+    // Ticks since bounds.x and direction were read; see `age` on Platform.
+    int age{0};
+};
+
+// Patrols every enemy due this tick and refreshes its grid cell; independent
+// of the player, so it can run alongside the player update.
+void MoveEnemies(EnemyStore& enemies, SpatialGrid& grid, float dt, const LodFocus& focus = LodFocus{});
+// Applies at most one hit from an enemy overlapping the player.
+void ResolveEnemyHits(const EnemyStore& enemies, const SpatialGrid& grid, struct Player& player);
+void UpdateEnemies(EnemyStore& enemies, SpatialGrid& grid, struct Player& player, float dt);
+
+// A patrol's place on its walk: `ticks` steps from `from` towards
+// `direction`, with the clamp onto the far end and the turn coming on step
+// `length`. Every later leg runs end to end. Patrols that do not move have
+// length 0 and stay at `from`.
+struct PatrolLeg
+{
+    float from{0.0f};
+    float direction{1.0f};
+    int ticks{0};
+    int length{0};
+};
+
+// The leg a patrol that was at `x` facing `direction` is on `ticks` steps of
+// `stride` later, for limits [left, right]. Solved rather than stepped, so any
+// number of skipped ticks lands exactly where StepPatrolLeg would have.
+PatrolLeg GetPatrolLeg(float x, float direction, int ticks, float stride, float left, float right);
+void StepPatrolLeg(PatrolLeg& leg, float stride, float left, float right);
+float GetPatrolX(const PatrolLeg& leg, float stride);
@@ -0,0 +1,309 @@
+#include "entity_store.h"
+
+#include <algorithm>
+
+void PlatformStore::Clear()
+{
+    x.clear();
+    y.clear();
+    width.clear();
+    height.clear();
+    moverRow.clear();
+
+    moverPlatform.clear();
+    moverStartX.clear();
+    moverStartY.clear();
+    moverEndX.clear();
+    moverEndY.clear();
+    moverTravelTime.clear();
+    moverAnchorTimer.clear();
+    moverAnchorTick.clear();
+    moverUpdatedTick.clear();
+    moverLeft.clear();
+    moverRight.clear();
+    moverX.clear();
+    moverY.clear();
+    moverPreviousX.clear();
+    moverPreviousY.clear();
+    moverDue.clear();
+    maxMoverStep = 0.0f;
+    lod = LodCounts{};
+}
+
+void PlatformStore::Reserve(std::size_t platforms, std::size_t movers)
+{
+    x.reserve(platforms);
+    y.reserve(platforms);
+    width.reserve(platforms);
+    height.reserve(platforms);
+    moverRow.reserve(platforms);
+
+    moverPlatform.reserve(movers);
+    moverStartX.reserve(movers);
+    moverStartY.reserve(movers);
+    moverEndX.reserve(movers);
+    moverEndY.reserve(movers);
+    moverTravelTime.reserve(movers);
+    moverAnchorTimer.reserve(movers);
+    moverAnchorTick.reserve(movers);
+    moverUpdatedTick.reserve(movers);
+    moverLeft.reserve(movers);
+    moverRight.reserve(movers);
+    moverX.reserve(movers);
+    moverY.reserve(movers);
+    moverPreviousX.reserve(movers);
+    moverPreviousY.reserve(movers);
+    moverDue.reserve(movers);
+}
+
+void PlatformStore::Push(const Platform& platform)
+{
+    const int index = static_cast<int>(x.size());
+    x.push_back(platform.bounds.x);
+    y.push_back(platform.bounds.y);
+    width.push_back(platform.bounds.width);
+    height.push_back(platform.bounds.height);
+
+    if (!platform.moving || platform.travelTime <= 0.0f)
+    {
+        moverRow.push_back(-1);
+        return;
+    }
+
+    const std::size_t mover = moverPlatform.size();
+    moverRow.push_back(static_cast<int>(mover));
+    moverPlatform.push_back(index);
+    moverStartX.push_back(platform.startPosition.x);
+    moverStartY.push_back(platform.startPosition.y);
+    moverEndX.push_back(platform.endPosition.x);
+    moverEndY.push_back(platform.endPosition.y);
+    moverTravelTime.push_back(platform.travelTime);
+    moverAnchorTimer.push_back(platform.timer);
+    moverAnchorTick.push_back(clock - platform.age);
+    moverUpdatedTick.push_back(clock);
+    moverLeft.push_back(std::min(platform.startPosition.x, platform.endPosition.x));
+    moverRight.push_back(std::max(platform.startPosition.x, platform.endPosition.x) + platform.bounds.width);
+
+    const Vector2 position = GetMoverPositionAt(mover, clock);
+    x.back() = position.x;
+    y.back() = position.y;
+    moverX.push_back(position.x);
+    moverY.push_back(position.y);
+    moverPreviousX.push_back(position.x);
+    moverPreviousY.push_back(position.y);
+}
+
+void PlatformStore::Advance(float step)
+{
+    if (step != clockStep)
+    {
+        // Timers are taken again as of now, at the old step. Before the first
+        // step there is no motion to carry over.
+        if (clockStep != 0.0f)
+        {
+            for (std::size_t i = 0; i < MoverCount(); ++i)
+            {
+                moverAnchorTimer[i] = AdvanceMoverTimer(moverAnchorTimer[i], GetAge(i), clockStep, moverTravelTime[i]);
+                moverAnchorTick[i] = clock;
+            }
+        }
+        clockStep = step;
+        for (std::size_t i = 0; i < MoverCount(); ++i)
+        {
+            const Vector2 position = GetMoverPositionAt(i, clock);
+            moverX[i] = position.x;
+            moverY[i] = position.y;
+            moverUpdatedTick[i] = clock;
+        }
+    }
+    ++clock;
+}
+
+Vector2 PlatformStore::GetMoverPositionAt(std::size_t mover, int tick) const
+{
+    const float timer = AdvanceMoverTimer(moverAnchorTimer[mover], tick - moverAnchorTick[mover], clockStep, moverTravelTime[mover]);
+    return GetMoverPosition({moverStartX[mover], moverStartY[mover]}, {moverEndX[mover], moverEndY[mover]}, moverTravelTime[mover], timer);
+}
+
+Rectangle PlatformStore::GetInterpolatedBounds(std::size_t index, float alpha) const
+{
+    const int row = moverRow[index];
+    if (row < 0)
+    {
+        return GetBounds(index);
+    }
+
+    const std::size_t mover = static_cast<std::size_t>(row);
+    return {moverPreviousX[mover] + (x[index] - moverPreviousX[mover]) * alpha,
+            moverPreviousY[mover] + (y[index] - moverPreviousY[mover]) * alpha,
+            width[index],
+            height[index]};
+}
+
+Vector2 PlatformStore::GetStep(std::size_t index) const
+{
+    const int row = moverRow[index];
+    if (row < 0)
+    {
+        return {0.0f, 0.0f};
+    }
+
+    const std::size_t mover = static_cast<std::size_t>(row);
+    return {x[index] - moverPreviousX[mover], y[index] - moverPreviousY[mover]};
+}
+
+Platform PlatformStore::Get(std::size_t index) const
+{
+    Platform platform{};
+    platform.bounds = GetBounds(index);
+
+    const int row = moverRow[index];
+    if (row < 0)
+    {
+        // Static platforms never read their path, so it collapses onto the bounds.
+        platform.startPosition = {platform.bounds.x, platform.bounds.y};
+        platform.endPosition = platform.startPosition;
+        return platform;
+    }
+
+    const std::size_t mover = static_cast<std::size_t>(row);
+    const Vector2 position = GetMoverPositionAt(mover, clock);
+    platform.bounds.x = position.x;
+    platform.bounds.y = position.y;
+    platform.startPosition = {moverStartX[mover], moverStartY[mover]};
+    platform.endPosition = {moverEndX[mover], moverEndY[mover]};
+    platform.travelTime = moverTravelTime[mover];
+    platform.timer = moverAnchorTimer[mover];
+    platform.age = GetAge(mover);
+    platform.moving = true;
+    return platform;
+}
+
+void EnemyStore::Clear()
+{
+    x.clear();
+    y.clear();
+    width.clear();
+    height.clear();
+    speed.clear();
+    leftLimit.clear();
+    rightLimit.clear();
+    legFrom.clear();
+    direction.clear();
+    legTicks.clear();
+    legLength.clear();
+    damage.clear();
+    anchorX.clear();
+    anchorDirection.clear();
+    anchorTick.clear();
+    updatedTick.clear();
+    previousX.clear();
+    due.clear();
+    lod = LodCounts{};
+}
+
+void EnemyStore::Reserve(std::size_t enemies)
+{
+    x.reserve(enemies);
+    y.reserve(enemies);
+    width.reserve(enemies);
+    height.reserve(enemies);
+    speed.reserve(enemies);
+    leftLimit.reserve(enemies);
+    rightLimit.reserve(enemies);
+    legFrom.reserve(enemies);
+    direction.reserve(enemies);
+    legTicks.reserve(enemies);
+    legLength.reserve(enemies);
+    damage.reserve(enemies);
+    anchorX.reserve(enemies);
+    anchorDirection.reserve(enemies);
+    anchorTick.reserve(enemies);
+    updatedTick.reserve(enemies);
+    previousX.reserve(enemies);
+    due.reserve(enemies);
+}
+
+void EnemyStore::Push(const Enemy& enemy)
+{
+    const std::size_t index = y.size();
+    y.push_back(enemy.bounds.y);
+    width.push_back(enemy.bounds.width);
+    height.push_back(enemy.bounds.height);
+    speed.push_back(enemy.speed);
+    leftLimit.push_back(enemy.leftLimit);
+    rightLimit.push_back(enemy.rightLimit);
+    damage.push_back(enemy.damage);
+    anchorX.push_back(enemy.bounds.x);
+    anchorDirection.push_back(enemy.direction < 0 ? -1.0f : 1.0f);
+    anchorTick.push_back(clock - enemy.age);
+
+    x.push_back(0.0f);
+    legFrom.push_back(0.0f);
+    direction.push_back(0.0f);
+    legTicks.push_back(0);
+    legLength.push_back(0);
+    updatedTick.push_back(clock);
+    SetLeg(index, GetLegAt(index, clock), clock);
+    previousX.push_back(x[index]);
+}
+
+void EnemyStore::Advance(float step)
+{
+    if (step != clockStep)
+    {
+        // Legs depend on the step, so they are solved again from anchors as
+        // of now. Before the first step there is no motion to carry over.
+        if (clockStep != 0.0f)
+        {
+            for (std::size_t i = 0; i < Size(); ++i)
+            {
+                const PatrolLeg leg = GetLegAt(i, clock);
+                anchorX[i] = GetPatrolX(leg, GetStride(i));
+                anchorDirection[i] = leg.direction;
+                anchorTick[i] = clock;
+            }
+        }
+        clockStep = step;
+        for (std::size_t i = 0; i < Size(); ++i)
+        {
+            SetLeg(i, GetLegAt(i, clock), clock);
+        }
+    }
+    ++clock;
+}
+
+PatrolLeg EnemyStore::GetLegAt(std::size_t index, int tick) const
+{
+    return GetPatrolLeg(anchorX[index], anchorDirection[index], tick - anchorTick[index], GetStride(index),
+                        leftLimit[index], GetRightStop(index));
+}
+
+void EnemyStore::SetLeg(std::size_t index, const PatrolLeg& leg, int tick)
+{
+    legFrom[index] = leg.from;
+    direction[index] = leg.direction;
+    legTicks[index] = leg.ticks;
+    legLength[index] = leg.length;
+    x[index] = GetPatrolX(leg, GetStride(index));
+    updatedTick[index] = tick;
+}
+
+Rectangle EnemyStore::GetInterpolatedBounds(std::size_t index, float alpha) const
+{
+    return {previousX[index] + (x[index] - previousX[index]) * alpha, y[index], width[index], height[index]};
+}
+
+Enemy EnemyStore::Get(std::size_t index) const
+{
+    Enemy enemy{};
+    enemy.bounds = GetBounds(index);
+    enemy.bounds.x = anchorX[index];
+    enemy.speed = speed[index];
+    enemy.leftLimit = leftLimit[index];
+    enemy.rightLimit = rightLimit[index];
+    enemy.damage = damage[index];
+    enemy.direction = anchorDirection[index] < 0.0f ? -1 : 1;
+    enemy.age = GetAge(index);
+    return enemy;
+}
@@ -0,0 +1,132 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include "raylib.h"
+
+#include "platform.h"
+#include "enemy.h"
+#include "lod.h"
+
+// Structure-of-arrays storage for the simulation's active entities. Platform
+// and Enemy remain the authoring/streaming types; while an entity is live its
+// fields are split into columns so the per-tick kernels walk contiguous floats
+// and the compiler can vectorise them.
+
+// Every platform has bounds columns. Moving platforms also own one row in the
+// mover columns, so the interpolation kernel never strides over static ground.
+struct PlatformStore
+{
+    std::vector<float> x{};
+    std::vector<float> y{};
+    std::vector<float> width{};
+    std::vector<float> height{};
+
+    std::vector<int> moverPlatform{};
+    std::vector<float> moverStartX{};
+    std::vector<float> moverStartY{};
+    std::vector<float> moverEndX{};
+    std::vector<float> moverEndY{};
+    std::vector<float> moverTravelTime{};
+    // Timer as of the clock tick in moverAnchorTick; see Platform::age.
+    std::vector<float> moverAnchorTimer{};
+    std::vector<int> moverAnchorTick{};
+    // Clock tick moverX/moverY were last brought up to date on.
+    std::vector<int> moverUpdatedTick{};
+    // Horizontal extent of the whole path, for LOD scheduling.
+    std::vector<float> moverLeft{};
+    std::vector<float> moverRight{};
+    std::vector<float> moverX{};
+    std::vector<float> moverY{};
+    // Position the tick before moverUpdatedTick, for render interpolation.
+    std::vector<float> moverPreviousX{};
+    std::vector<float> moverPreviousY{};
+    // Movers due in the current UpdatePlatforms.
+    std::vector<int> moverDue{};
+    // The longest way any mover travelled on either axis in the latest
+    // UpdatePlatforms, so sweeps can widen their broadphase query to match.
+    float maxMoverStep{0.0f};
+    // UpdatePlatforms calls so far and the step they took. Kept across
+    // Clear; only differences between ticks matter.
+    int clock{0};
+    float clockStep{0.0f};
+    LodCounts lod{};
+
+    std::size_t Size() const { return x.size(); }
+    std::size_t MoverCount() const { return moverPlatform.size(); }
+    bool IsMoving(std::size_t index) const { return moverRow[index] >= 0; }
+
+    void Clear();
+    void Reserve(std::size_t platforms, std::size_t movers);
+    void Push(const Platform& platform);
+    // Starts a tick of `step`; a step unlike the last one re-anchors every mover.
+    void Advance(float step);
+    int GetAge(std::size_t mover) const { return clock - moverAnchorTick[mover]; }
+    // Where a mover is on `tick`, however long ago it was last updated.
+    Vector2 GetMoverPositionAt(std::size_t mover, int tick) const;
+
+    Rectangle GetBounds(std::size_t index) const { return {x[index], y[index], width[index], height[index]}; }
+    // Bounds blended between the last two ticks; alpha 1 is the current tick.
+    Rectangle GetInterpolatedBounds(std::size_t index, float alpha) const;
+    // How far the platform moved the last time it was updated; zero for static ones.
+    Vector2 GetStep(std::size_t index) const;
+    // Exact as of the current tick, even for movers that are behind.
+    Platform Get(std::size_t index) const;
+
+private:
+    // Row in the mover columns for each platform, -1 for static ones.
+    std::vector<int> moverRow{};
+};
+
+struct EnemyStore
+{
+    std::vector<float> x{};
+    std::vector<float> y{};
+    std::vector<float> width{};
+    std::vector<float> height{};
+    std::vector<float> speed{};
+    std::vector<float> leftLimit{};
+    std::vector<float> rightLimit{};
+    // The PatrolLeg x and direction come from.
+    std::vector<float> legFrom{};
+    std::vector<float> direction{};
+    std::vector<int> legTicks{};
+    std::vector<int> legLength{};
+    std::vector<int> damage{};
+    // Position and direction as of the clock tick in anchorTick; see Enemy::age.
+    std::vector<float> anchorX{};
+    std::vector<float> anchorDirection{};
+    std::vector<int> anchorTick{};
+    // Clock tick x and the leg were last brought up to date on.
+    std::vector<int> updatedTick{};
+    // x the tick before updatedTick; patrols never move vertically.
+    std::vector<float> previousX{};
+    // Enemies due in the current MoveEnemies.
+    std::vector<int> due{};
+    // MoveEnemies calls so far and the step they took; as on PlatformStore.
+    int clock{0};
+    float clockStep{0.0f};
+    LodCounts lod{};
+
+    std::size_t Size() const { return x.size(); }
+
+    void Clear();
+    void Reserve(std::size_t enemies);
+    void Push(const Enemy& enemy);
+    // Starts a tick of `step`; a step unlike the last one re-anchors every enemy.
+    void Advance(float step);
+    int GetAge(std::size_t index) const { return clock - anchorTick[index]; }
+    float GetStride(std::size_t index) const { return speed[index] * clockStep; }
+    // Rightmost x the enemy's left edge reaches.
+    float GetRightStop(std::size_t index) const { return rightLimit[index] - width[index]; }
+    PatrolLeg GetLeg(std::size_t index) const { return {legFrom[index], direction[index], legTicks[index], legLength[index]}; }
+    // Where an enemy is on `tick`, however long ago it was last updated.
+    PatrolLeg GetLegAt(std::size_t index, int tick) const;
+    // Moves the enemy to `leg`, as of `tick`.
+    void SetLeg(std::size_t index, const PatrolLeg& leg, int tick);
+
+    Rectangle GetBounds(std::size_t index) const { return {x[index], y[index], width[index], height[index]}; }
+    Rectangle GetInterpolatedBounds(std::size_t index, float alpha) const;
+    Enemy Get(std::size_t index) const;
+};
@@ -0,0 +1,11 @@
+#pragma once
+
+#include "raylib.h"
+
+// Same test as raylib's CheckCollisionRecs, kept here so the simulation never
+// has to link against raylib itself.
+inline bool RectsOverlap(const Rectangle& a, const Rectangle& b)
+{
+    return a.x < b.x + b.width && a.x + a.width > b.x &&
+           a.y < b.y + b.height && a.y + a.height > b.y;
+}
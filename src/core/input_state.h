@@ -0,0 +1,21 @@
+#pragma once
+
+// One tick's worth of player intent. Filled by PollInputState in the game shell,
+// or synthesised directly by headless runners.
+struct InputState
+{
+    bool moveLeft{false};
+    bool moveRight{false};
+    bool jumpPressed{false};
+    bool confirmPressed{false};
+    bool pausePressed{false};
+    bool restartPressed{false};
+    bool openSettings{false};
+    bool toggleHighContrast{false};
+    bool toggleLargeHud{false};
+    bool toggleTimeTrial{false};
+    bool cycleBindings{false};
+    bool toggleProfiler{false};
+    // Held, like the move buttons.
+    bool rewindHeld{false};
+};
@@ -0,0 +1,292 @@
+#include "job_system.h"
+
+#include <algorithm>
+#include <cassert>
+
+namespace
+{
+    // Without deterministic mode, ranges split into about this many chunks per
+    // thread, so a slow chunk can be balanced by stealing the others.
+    constexpr std::size_t CHUNKS_PER_THREAD = 4;
+
+    // Index of the worker running on this thread, or -1 for any other thread.
+    thread_local int currentWorker = -1;
+}
+
+int GetDefaultWorkerCount()
+{
+    return std::max(0, static_cast<int>(std::thread::hardware_concurrency()) - 2);
+}
+
+JobSystem& JobSystem::Get()
+{
+    static JobSystem jobSystem;
+    return jobSystem;
+}
+
+JobSystem::~JobSystem()
+{
+    Stop();
+}
+
+void JobSystem::Start(int workerCount, bool deterministicMode)
+{
+    Stop();
+    deterministic = deterministicMode;
+    if (workerCount <= 0)
+    {
+        return;
+    }
+
+    for (int i = 0; i <= workerCount; ++i)
+    {
+        queues.push_back(std::make_unique<JobQueue>());
+    }
+
+    running.store(true);
+    workers.reserve(static_cast<std::size_t>(workerCount));
+    for (int i = 0; i < workerCount; ++i)
+    {
+        workers.emplace_back(&JobSystem::WorkerMain, this, i);
+    }
+}
+
+void JobSystem::Stop()
+{
+    running.store(false);
+    {
+        const std::lock_guard<std::mutex> lock(sleepMutex);
+        wakeWorkers.notify_all();
+    }
+
+    for (std::thread& worker : workers)
+    {
+        worker.join();
+    }
+    workers.clear();
+    queues.clear();
+    queuedJobs.store(0);
+}
+
+void JobSystem::Submit(const Job& job)
+{
+    job.counter->pending.fetch_add(1, std::memory_order_relaxed);
+
+    if (workers.empty())
+    {
+        Execute(job);
+        return;
+    }
+
+    JobQueue& queue = currentWorker >= 0 ? *queues[static_cast<std::size_t>(currentWorker)] : *queues.back();
+    {
+        const std::lock_guard<std::mutex> lock(queue.mutex);
+        queue.jobs.push_back(job);
+    }
+
+    // Both sides use sequentially consistent operations: a worker counts itself
+    // as sleeping before checking for jobs, and a submitter publishes the job
+    // before checking for sleepers, so one of them always sees the other.
+    queuedJobs.fetch_add(1);
+    if (sleepingWorkers.load() > 0)
+    {
+        const std::lock_guard<std::mutex> lock(sleepMutex);
+        wakeWorkers.notify_one();
+    }
+}
+
+void JobSystem::Wait(JobCounter& counter)
+{
+    while (counter.pending.load(std::memory_order_acquire) > 0)
+    {
+        Job job{};
+        if (TryTakeJob(job))
+        {
+            Execute(job);
+        }
+        else
+        {
+            std::this_thread::yield();
+        }
+    }
+}
+
+void JobSystem::Dispatch(std::size_t count, std::size_t grain, JobFunction function, void* context)
+{
+    if (count == 0)
+    {
+        return;
+    }
+
+    grain = std::max<std::size_t>(grain, 1);
+    if (workers.empty() || count <= grain)
+    {
+        function(context, 0, count);
+        return;
+    }
+
+    std::size_t chunk = grain;
+    if (!deterministic)
+    {
+        const std::size_t chunks = (workers.size() + 1) * CHUNKS_PER_THREAD;
+        chunk = std::max(grain, (count + chunks - 1) / chunks);
+    }
+
+    JobCounter counter{};
+    for (std::size_t begin = 0; begin < count; begin += chunk)
+    {
+        Submit({function, context, begin, std::min(begin + chunk, count), &counter});
+    }
+    Wait(counter);
+}
+
+bool JobSystem::TryTakeJob(Job& job)
+{
+    if (queues.empty())
+    {
+        return false;
+    }
+
+    const std::size_t queueCount = queues.size();
+    const std::size_t own = currentWorker >= 0 ? static_cast<std::size_t>(currentWorker) : queueCount - 1;
+
+    // Newest first from our own queue, oldest first from everyone else's.
+    for (std::size_t offset = 0; offset < queueCount; ++offset)
+    {
+        JobQueue& queue = *queues[(own + offset) % queueCount];
+        const std::lock_guard<std::mutex> lock(queue.mutex);
+        if (queue.jobs.empty())
+        {
+            continue;
+        }
+
+        if (offset == 0)
+        {
+            job = queue.jobs.back();
+            queue.jobs.pop_back();
+        }
+        else
+        {
+            job = queue.jobs.front();
+            queue.jobs.pop_front();
+        }
+        queuedJobs.fetch_sub(1);
+        return true;
+    }
+
+    return false;
+}
+
+void JobSystem::Execute(const Job& job)
+{
+    job.function(job.context, job.begin, job.end);
+    job.counter->pending.fetch_sub(1, std::memory_order_release);
+}
+
+void JobSystem::WorkerMain(int index)
+{
+    currentWorker = index;
+
+    while (running.load())
+    {
+        Job job{};
+        if (TryTakeJob(job))
+        {
+            Execute(job);
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(sleepMutex);
+        sleepingWorkers.fetch_add(1);
+        wakeWorkers.wait(lock, [this]() { return queuedJobs.load() > 0 || !running.load(); });
+        sleepingWorkers.fetch_sub(1);
+    }
+}
+
+int TaskGraph::AddTask(TaskFunction function, void* context)
+{
+    // A task dropped here would silently never run.
+    assert(taskCount < TASK_GRAPH_CAPACITY && "TaskGraph is full; raise TASK_GRAPH_CAPACITY");
+    if (taskCount == TASK_GRAPH_CAPACITY)
+    {
+        return -1;
+    }
+
+    Task& task = tasks[static_cast<std::size_t>(taskCount)];
+    task.function = function;
+    task.context = context;
+    task.graph = this;
+    task.dependencies = 0;
+    task.successorCount = 0;
+    return taskCount++;
+}
+
+void TaskGraph::Precede(int before, int after)
+{
+    assert(before >= 0 && before < taskCount && after >= 0 && after < taskCount && before != after &&
+           "TaskGraph::Precede needs two different tasks returned by Add");
+    if (before < 0 || before >= taskCount || after < 0 || after >= taskCount || before == after)
+    {
+        return;
+    }
+
+    // Each edge is stored once, so there are never more successors than tasks.
+    Task& task = tasks[static_cast<std::size_t>(before)];
+    for (int i = 0; i < task.successorCount; ++i)
+    {
+        if (task.successors[static_cast<std::size_t>(i)] == after)
+        {
+            return;
+        }
+    }
+
+    task.successors[static_cast<std::size_t>(task.successorCount++)] = after;
+    tasks[static_cast<std::size_t>(after)].dependencies += 1;
+}
+
+void TaskGraph::Run(bool parallel)
+{
+    serial = !parallel;
+    for (int i = 0; i < taskCount; ++i)
+    {
+        Task& task = tasks[static_cast<std::size_t>(i)];
+        task.remaining.store(task.dependencies, std::memory_order_relaxed);
+    }
+
+    for (int i = 0; i < taskCount; ++i)
+    {
+        if (tasks[static_cast<std::size_t>(i)].dependencies == 0)
+        {
+            SubmitTask(i);
+        }
+    }
+
+    JobSystem::Get().Wait(counter);
+}
+
+void TaskGraph::SubmitTask(int index)
+{
+    if (serial)
+    {
+        RunTask(&tasks[static_cast<std::size_t>(index)], 0, 1);
+        return;
+    }
+
+    JobSystem::Get().Submit({&TaskGraph::RunTask, &tasks[static_cast<std::size_t>(index)], 0, 1, &counter});
+}
+
+void TaskGraph::RunTask(void* context, std::size_t, std::size_t)
+{
+    Task& task = *static_cast<Task*>(context);
+    task.function(task.context);
+
+    // Whoever finishes a task's last dependency schedules it.
+    for (int i = 0; i < task.successorCount; ++i)
+    {
+        const int successor = task.successors[static_cast<std::size_t>(i)];
+        if (task.graph->tasks[static_cast<std::size_t>(successor)].remaining.fetch_sub(1, std::memory_order_acq_rel) == 1)
+        {
+            task.graph->SubmitTask(successor);
+        }
+    }
+}
@@ -0,0 +1,147 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+// One worker per core left over once the main and simulation threads have theirs.
+int GetDefaultWorkerCount();
+
+using JobFunction = void (*)(void* context, std::size_t begin, std::size_t end);
+
+// Counts jobs still outstanding; Wait returns once it reaches zero.
+struct JobCounter
+{
+    std::atomic<int> pending{0};
+};
+
+struct Job
+{
+    JobFunction function{nullptr};
+    void* context{nullptr};
+    std::size_t begin{0};
+    std::size_t end{0};
+    JobCounter* counter{nullptr};
+};
+
+// Small work-stealing scheduler. Each worker owns a queue it pushes and pops at
+// the back; idle workers steal from the front of the others'. Threads that are
+// not workers (the simulation thread, the headless main loop) submit through a
+// shared queue and help run jobs while they wait, as do workers waiting on
+// nested work, so waiting never deadlocks.
+//
+// With no workers started every job runs on the calling thread, in order.
+// Kernels that go through here only write their own rows and combine any
+// per-chunk results in an order-independent way, so they give the same output
+// whatever the worker count. Deterministic mode also pins chunk boundaries to
+// the grain, rather than sizing chunks by worker count, so code that does
+// depend on chunking stays reproducible across machines.
+class JobSystem
+{
+public:
+    static JobSystem& Get();
+
+    // Call from one thread while no jobs are in flight.
+    void Start(int workerCount, bool deterministic);
+    void Stop();
+    int GetWorkerCount() const { return static_cast<int>(workers.size()); }
+    bool IsDeterministic() const { return deterministic; }
+
+    void Submit(const Job& job);
+    // Runs queued jobs on this thread until the counter drains.
+    void Wait(JobCounter& counter);
+
+    // Splits [0, count) into chunks of at least `grain` items, runs `function`
+    // on each and returns when all are done. Ranges no bigger than one grain
+    // run inline without touching the queues.
+    void Dispatch(std::size_t count, std::size_t grain, JobFunction function, void* context);
+
+private:
+    struct JobQueue
+    {
+        std::mutex mutex{};
+        std::deque<Job> jobs{};
+    };
+
+    JobSystem() = default;
+    ~JobSystem();
+
+    bool TryTakeJob(Job& job);
+    void Execute(const Job& job);
+    void WorkerMain(int index);
+
+    std::vector<std::thread> workers{};
+    // One queue per worker plus a last one shared by every other thread.
+    std::vector<std::unique_ptr<JobQueue>> queues{};
+    std::atomic<bool> running{false};
+    std::atomic<int> queuedJobs{0};
+    std::atomic<int> sleepingWorkers{0};
+    std::mutex sleepMutex{};
+    std::condition_variable wakeWorkers{};
+    bool deterministic{false};
+};
+
+// ParallelFor(count, grain, [&](std::size_t begin, std::size_t end) { ... });
+template <typename Function>
+void ParallelFor(std::size_t count, std::size_t grain, Function&& function)
+{
+    using Body = std::remove_reference_t<Function>;
+    JobSystem::Get().Dispatch(count,
+                              grain,
+                              [](void* context, std::size_t begin, std::size_t end) { (*static_cast<Body*>(context))(begin, end); },
+                              &function);
+}
+
+constexpr int TASK_GRAPH_CAPACITY = 16;
+
+// A fixed set of tasks with "runs before" edges, executed on the job system as
+// their dependencies complete. Built on the stack each time it is needed; the
+// callables passed to Add must outlive Run.
+class TaskGraph
+{
+public:
+    // Asserts past TASK_GRAPH_CAPACITY tasks.
+    template <typename Function>
+    int Add(Function& function)
+    {
+        return AddTask([](void* context) { (*static_cast<Function*>(context))(); }, &function);
+    }
+
+    // Asserts on an edge between anything but two tasks from Add. Repeating
+    // an edge has no effect.
+    void Precede(int before, int after);
+    // Runs every task and returns once all have finished. Serially, tasks run
+    // on this thread in dependency order, skipping the queues altogether;
+    // worth it when the tasks are too small to pay for handing them out.
+    void Run(bool parallel = true);
+
+private:
+    using TaskFunction = void (*)(void* context);
+
+    struct Task
+    {
+        TaskFunction function{nullptr};
+        void* context{nullptr};
+        TaskGraph* graph{nullptr};
+        int dependencies{0};
+        std::atomic<int> remaining{0};
+        std::array<int, TASK_GRAPH_CAPACITY> successors{};
+        int successorCount{0};
+    };
+
+    int AddTask(TaskFunction function, void* context);
+    void SubmitTask(int index);
+    static void RunTask(void* context, std::size_t begin, std::size_t end);
+
+    std::array<Task, TASK_GRAPH_CAPACITY> tasks{};
+    int taskCount{0};
+    bool serial{false};
+    JobCounter counter{};
+};
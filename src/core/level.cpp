@@ -0,0 +1,115 @@
+#include "level.h"
+
+#include <cstdio>
+#include <utility>
+
+#include "level_file.h"
+#include "level_generator.h"
+
+void BuildStaticGeometry(const LevelLayout& layout, StaticGeometry& geometry)
+{
+    geometry.platforms.clear();
+    for (const Platform& platform : layout.platforms)
+    {
+        if (!platform.moving)
+        {
+            geometry.platforms.push_back(platform.bounds);
+        }
+    }
+}
+
+LevelLayout MakeBuiltinLevel(LevelArena* arena)
+{
+    LevelLayout layout(arena);
+    layout.platforms.reserve(4);
+    layout.enemies.reserve(2);
+    layout.coins.reserve(3);
+
+    const float groundHeight = 64.0f;
+    layout.platforms.push_back({Rectangle{ -400.0f, 400.0f, 1200.0f, groundHeight }, { -400.0f, 400.0f }, { -400.0f, 400.0f }, 0.0f, 0.0f, false});
+    layout.platforms.push_back({Rectangle{ 150.0f, 320.0f, 160.0f, 24.0f }, {150.0f, 320.0f}, {150.0f, 320.0f}, 0.0f, 0.0f, false});
+    layout.platforms.push_back({Rectangle{ 380.0f, 260.0f, 160.0f, 24.0f }, {380.0f, 260.0f}, {500.0f, 260.0f}, 2.5f, 0.0f, true});
+    layout.platforms.push_back({Rectangle{ 640.0f, 180.0f, 180.0f, 24.0f }, {640.0f, 180.0f}, {820.0f, 200.0f}, 3.0f, 0.0f, true});
+
+    layout.enemies.push_back({Rectangle{220.0f, 364.0f, 32.0f, 32.0f}, 50.0f, 150.0f, 310.0f, 1, 1});
+    layout.enemies.push_back({Rectangle{420.0f, 214.0f, 32.0f, 32.0f}, 70.0f, 380.0f, 520.0f, 1, -1});
+
+    layout.coins.push_back({Vector2{180.0f, 290.0f}, 12.0f, false});
+    layout.coins.push_back({Vector2{420.0f, 230.0f}, 12.0f, false});
+    layout.coins.push_back({Vector2{700.0f, 150.0f}, 12.0f, false});
+
+    layout.spawnPoint = {0.0f, 352.0f};
+    return layout;
+}
+
+LevelLibrary::LevelLibrary() = default;
+LevelLibrary::~LevelLibrary() = default;
+LevelLibrary::LevelLibrary(LevelLibrary&& other) noexcept = default;
+LevelLibrary& LevelLibrary::operator=(LevelLibrary&& other) noexcept = default;
+
+int LevelLibrary::SetDirectory(const std::string& directory)
+{
+    files.clear();
+
+    for (int number = 1;; ++number)
+    {
+        char name[32];
+        std::snprintf(name, sizeof(name), "level%02d.skl", number);
+
+        std::string path = directory;
+        if (!path.empty() && path.back() != '/' && path.back() != '\\')
+        {
+            path += '/';
+        }
+        path += name;
+
+        MappedFile file;
+        LevelView view{};
+        if (!file.Open(path) || !OpenLevelView(file.GetData(), file.GetSize(), view))
+        {
+            break;
+        }
+
+        files.push_back(std::move(file));
+    }
+
+    return GetLevelCount();
+}
+
+void LevelLibrary::SetGeneration(std::uint32_t seed, const JumpLimits& limits)
+{
+    generator = std::make_unique<LevelGenerator>(seed, limits);
+}
+
+void LevelLibrary::Prefetch(int level)
+{
+    if (generator != nullptr && level > GetLevelCount())
+    {
+        generator->Prefetch(level);
+    }
+}
+
+LevelLayout LevelLibrary::Load(int level, LevelArena* arena)
+{
+    if (generator != nullptr && level > GetLevelCount())
+    {
+        LevelLayout layout(arena);
+        generator->Load(level, layout);
+        return layout;
+    }
+    if (files.empty())
+    {
+        return MakeBuiltinLevel(arena);
+    }
+
+    const int index = (level > 0 ? level - 1 : 0) % static_cast<int>(files.size());
+    const MappedFile& file = files[static_cast<std::size_t>(index)];
+
+    LevelView view{};
+    if (!OpenLevelView(file.GetData(), file.GetSize(), view))
+    {
+        return MakeBuiltinLevel(arena);
+    }
+
+    return MakeLevelLayout(view, arena);
+}
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "raylib.h"
+
+#include "platform.h"
+#include "enemy.h"
+#include "coin.h"
+#include "level_arena.h"
+#include "mapped_file.h"
+
+// Full description of a level before streaming splits it up.
+struct LevelLayout
+{
+    LevelLayout() = default;
+    // Storage comes from `arena`, or from the heap when it is null.
+    explicit LevelLayout(LevelArena* arena)
+        : platforms(ArenaAllocator<Platform>(arena)),
+          enemies(ArenaAllocator<Enemy>(arena)),
+          coins(ArenaAllocator<Coin>(arena))
+    {
+    }
+
+    LevelVector<Platform> platforms{};
+    LevelVector<Enemy> enemies{};
+    LevelVector<Coin> coins{};
+    Vector2 spawnPoint{};
+};
+
+// The platforms of a level that never move. Built once per level load and then
+// only shared read-only, so the renderer can keep it past the simulation tick.
+// That is also why it lives on the heap rather than in the level arena.
+struct StaticGeometry
+{
+    std::vector<Rectangle> platforms{};
+};
+
+// Refills `geometry`, reusing its storage.
+void BuildStaticGeometry(const LevelLayout& layout, StaticGeometry& geometry);
+
+// The original hand-placed layout, used when neither a level file nor the
+// generator can supply a level.
+LevelLayout MakeBuiltinLevel(LevelArena* arena = nullptr);
+
+class LevelGenerator;
+struct JumpLimits;
+
+// Maps every compiled level file (level01.skl, level02.skl, ...) in a directory
+// once, up front, so switching levels only copies records out of memory that
+// is already resident. Level numbers past the last file are generated once
+// SetGeneration has been called, and wrap around otherwise.
+class LevelLibrary
+{
+public:
+    LevelLibrary();
+    ~LevelLibrary();
+    LevelLibrary(LevelLibrary&& other) noexcept;
+    LevelLibrary& operator=(LevelLibrary&& other) noexcept;
+
+    int SetDirectory(const std::string& directory);
+    int GetLevelCount() const { return static_cast<int>(files.size()); }
+
+    void SetGeneration(std::uint32_t seed, const JumpLimits& limits);
+    // Starts generating `level` in the background if it has no file.
+    void Prefetch(int level);
+
+    // The layout's storage comes from `arena` when one is given.
+    LevelLayout Load(int level, LevelArena* arena = nullptr);
+
+    // Null until SetGeneration.
+    const LevelGenerator* GetGenerator() const { return generator.get(); }
+
+private:
+    std::vector<MappedFile> files{};
+    std::unique_ptr<LevelGenerator> generator{};
+};
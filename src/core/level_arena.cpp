@@ -0,0 +1,72 @@
+#include "level_arena.h"
+
+#include <algorithm>
+#include <utility>
+
+namespace
+{
+    std::size_t AlignUp(std::size_t value, std::size_t alignment)
+    {
+        return (value + alignment - 1) & ~(alignment - 1);
+    }
+}
+
+LevelArena::LevelArena(std::size_t blockSize)
+    : blockSize(blockSize)
+{
+}
+
+void* LevelArena::Allocate(std::size_t size, std::size_t alignment)
+{
+    size = std::max<std::size_t>(size, 1);
+
+    while (current < blocks.size())
+    {
+        const Block& block = blocks[current];
+        const std::size_t start = AlignUp(offset, alignment);
+        if (start + size <= block.size)
+        {
+            offset = start + size;
+            used += size;
+            return block.data.get() + start;
+        }
+        ++current;
+        offset = 0;
+    }
+
+    AddBlock(size + alignment);
+    return Allocate(size, alignment);
+}
+
+void LevelArena::Reset()
+{
+    if (blocks.size() > 1)
+    {
+        const std::size_t total = GetCapacity();
+        blocks.clear();
+        AddBlock(total);
+    }
+    current = 0;
+    offset = 0;
+    used = 0;
+}
+
+std::size_t LevelArena::GetCapacity() const
+{
+    std::size_t total = 0;
+    for (const Block& block : blocks)
+    {
+        total += block.size;
+    }
+    return total;
+}
+
+void LevelArena::AddBlock(std::size_t minimumSize)
+{
+    // new[] only guarantees max_align_t alignment, which covers every level type.
+    Block block{};
+    block.size = std::max(blockSize, minimumSize);
+    block.data.reset(new unsigned char[block.size]);
+    blocks.push_back(std::move(block));
+    blockAllocations += 1;
+}
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+constexpr std::size_t LEVEL_ARENA_BLOCK_SIZE = 256u * 1024u;
+
+// Bump allocator for data that lives exactly as long as one level. Allocation
+// is a pointer bump, individual frees do nothing, and Reset drops everything
+// at once while keeping the memory for the next level. When a level needed
+// more than one block, Reset merges them into one block of the combined size,
+// so from then on a level of that size loads without touching the heap.
+class LevelArena
+{
+public:
+    explicit LevelArena(std::size_t blockSize = LEVEL_ARENA_BLOCK_SIZE);
+
+    LevelArena(const LevelArena&) = delete;
+    LevelArena& operator=(const LevelArena&) = delete;
+
+    void* Allocate(std::size_t size, std::size_t alignment);
+    // Invalidates everything allocated so far.
+    void Reset();
+
+    std::size_t GetUsedBytes() const { return used; }
+    std::size_t GetCapacity() const;
+    // Heap blocks taken since construction; stays flat once levels fit.
+    int GetBlockAllocations() const { return blockAllocations; }
+
+private:
+    struct Block
+    {
+        std::unique_ptr<unsigned char[]> data{};
+        std::size_t size{0};
+    };
+
+    void AddBlock(std::size_t minimumSize);
+
+    std::size_t blockSize{LEVEL_ARENA_BLOCK_SIZE};
+    std::vector<Block> blocks{};
+    std::size_t current{0};
+    std::size_t offset{0};
+    std::size_t used{0};
+    int blockAllocations{0};
+};
+
+// Standard allocator over a LevelArena. A default-constructed one uses the
+// heap, so arena-backed containers still work where no level is being loaded
+// (the level compiler, tests of a single layout).
+template <typename T>
+class ArenaAllocator
+{
+public:
+    using value_type = T;
+    using propagate_on_container_copy_assignment = std::true_type;
+    using propagate_on_container_move_assignment = std::true_type;
+    using propagate_on_container_swap = std::true_type;
+
+    ArenaAllocator() = default;
+    explicit ArenaAllocator(LevelArena* arena) : arena(arena) {}
+    template <typename U>
+    ArenaAllocator(const ArenaAllocator<U>& other) : arena(other.GetArena()) {}
+
+    T* allocate(std::size_t count)
+    {
+        if (arena == nullptr)
+        {
+            return std::allocator<T>{}.allocate(count);
+        }
+        return static_cast<T*>(arena->Allocate(count * sizeof(T), alignof(T)));
+    }
+
+    void deallocate(T* pointer, std::size_t count)
+    {
+        if (arena == nullptr)
+        {
+            std::allocator<T>{}.deallocate(pointer, count);
+        }
+    }
+
+    LevelArena* GetArena() const { return arena; }
+
+private:
+    LevelArena* arena{nullptr};
+};
+
+template <typename T, typename U>
+bool operator==(const ArenaAllocator<T>& a, const ArenaAllocator<U>& b)
+{
+    return a.GetArena() == b.GetArena();
+}
+
+template <typename T, typename U>
+bool operator!=(const ArenaAllocator<T>& a, const ArenaAllocator<U>& b)
+{
+    return !(a == b);
+}
+
+template <typename T>
+using LevelVector = std::vector<T, ArenaAllocator<T>>;
@@ -0,0 +1,335 @@
+#include "level_file.h"
+
+#include <cstdio>
+#include <cstring>
+#include <sstream>
+#include <vector>
+
+namespace
+{
+    constexpr std::size_t SECTION_ALIGNMENT = 16;
+
+    std::size_t AlignSection(std::size_t offset)
+    {
+        return (offset + SECTION_ALIGNMENT - 1) & ~(SECTION_ALIGNMENT - 1);
+    }
+
+    bool SectionFits(std::uint32_t offset, std::uint32_t count, std::size_t recordSize, std::size_t fileSize)
+    {
+        if (count == 0)
+        {
+            return true;
+        }
+
+        if (offset % SECTION_ALIGNMENT != 0 || offset < sizeof(LevelFileHeader))
+        {
+            return false;
+        }
+
+        const std::size_t bytes = static_cast<std::size_t>(count) * recordSize;
+        return offset <= fileSize && bytes <= fileSize - offset;
+    }
+
+    bool ReadFloats(std::istringstream& line, float* values, int required, int optional)
+    {
+        for (int i = 0; i < required + optional; ++i)
+        {
+            if (!(line >> values[i]))
+            {
+                return i >= required && line.eof();
+            }
+        }
+        return true;
+    }
+}
+
+bool OpenLevelView(const unsigned char* data, std::size_t size, LevelView& view)
+{
+    view = LevelView{};
+
+    if (data == nullptr || size < sizeof(LevelFileHeader) ||
+        reinterpret_cast<std::uintptr_t>(data) % alignof(LevelFileHeader) != 0)
+    {
+        return false;
+    }
+
+    const auto* header = reinterpret_cast<const LevelFileHeader*>(data);
+    if (header->magic != LEVEL_FILE_MAGIC || header->version != LEVEL_FILE_VERSION ||
+        header->endianTag != LEVEL_FILE_ENDIAN_TAG || header->fileSize != size)
+    {
+        return false;
+    }
+
+    if (!SectionFits(header->platformOffset, header->platformCount, sizeof(LevelPlatformRecord), size) ||
+        !SectionFits(header->enemyOffset, header->enemyCount, sizeof(LevelEnemyRecord), size) ||
+        !SectionFits(header->coinOffset, header->coinCount, sizeof(LevelCoinRecord), size))
+    {
+        return false;
+    }
+
+    view.header = header;
+    view.platforms = reinterpret_cast<const LevelPlatformRecord*>(data + header->platformOffset);
+    view.enemies = reinterpret_cast<const LevelEnemyRecord*>(data + header->enemyOffset);
+    view.coins = reinterpret_cast<const LevelCoinRecord*>(data + header->coinOffset);
+    return true;
+}
+
+LevelLayout MakeLevelLayout(const LevelView& view, LevelArena* arena)
+{
+    LevelLayout layout(arena);
+    if (view.header == nullptr)
+    {
+        return layout;
+    }
+
+    layout.spawnPoint = {view.header->spawnX, view.header->spawnY};
+
+    layout.platforms.resize(view.header->platformCount);
+    for (std::uint32_t i = 0; i < view.header->platformCount; ++i)
+    {
+        const LevelPlatformRecord& record = view.platforms[i];
+        Platform& platform = layout.platforms[i];
+        platform.bounds = {record.x, record.y, record.width, record.height};
+        platform.startPosition = {record.startX, record.startY};
+        platform.endPosition = {record.endX, record.endY};
+        platform.travelTime = record.travelTime;
+        platform.timer = 0.0f;
+        platform.moving = record.moving != 0;
+    }
+
+    layout.enemies.resize(view.header->enemyCount);
+    for (std::uint32_t i = 0; i < view.header->enemyCount; ++i)
+    {
+        const LevelEnemyRecord& record = view.enemies[i];
+        Enemy& enemy = layout.enemies[i];
+        enemy.bounds = {record.x, record.y, record.width, record.height};
+        enemy.speed = record.speed;
+        enemy.leftLimit = record.leftLimit;
+        enemy.rightLimit = record.rightLimit;
+        enemy.damage = record.damage;
+        enemy.direction = record.direction;
+    }
+
+    layout.coins.resize(view.header->coinCount);
+    for (std::uint32_t i = 0; i < view.header->coinCount; ++i)
+    {
+        const LevelCoinRecord& record = view.coins[i];
+        layout.coins[i] = {Vector2{record.x, record.y}, record.radius, false};
+    }
+
+    return layout;
+}
+
+bool ParseLevelText(const std::string& text, LevelLayout& layout, std::string& error)
+{
+    layout = LevelLayout{};
+    bool hasSpawn = false;
+
+    std::istringstream input(text);
+    std::string rawLine;
+    int lineNumber = 0;
+
+    while (std::getline(input, rawLine))
+    {
+        ++lineNumber;
+
+        const std::size_t comment = rawLine.find('#');
+        std::istringstream line(rawLine.substr(0, comment));
+
+        std::string keyword;
+        if (!(line >> keyword))
+        {
+            continue;
+        }
+
+        float values[9]{};
+        bool ok = false;
+
+        if (keyword == "spawn")
+        {
+            ok = ReadFloats(line, values, 2, 0);
+            layout.spawnPoint = {values[0], values[1]};
+            hasSpawn = ok;
+        }
+        else if (keyword == "platform")
+        {
+            ok = ReadFloats(line, values, 4, 0);
+            layout.platforms.push_back({Rectangle{values[0], values[1], values[2], values[3]},
+                                        {values[0], values[1]},
+                                        {values[0], values[1]},
+                                        0.0f,
+                                        0.0f,
+                                        false});
+        }
+        else if (keyword == "moving")
+        {
+            ok = ReadFloats(line, values, 7, 0) && values[6] > 0.0f;
+            layout.platforms.push_back({Rectangle{values[0], values[1], values[2], values[3]},
+                                        {values[0], values[1]},
+                                        {values[4], values[5]},
+                                        values[6],
+                                        0.0f,
+                                        true});
+        }
+        else if (keyword == "enemy")
+        {
+            values[7] = 1.0f;
+            values[8] = 1.0f;
+            ok = ReadFloats(line, values, 7, 2) && values[5] <= values[6];
+            layout.enemies.push_back({Rectangle{values[0], values[1], values[2], values[3]},
+                                      values[4],
+                                      values[5],
+                                      values[6],
+                                      static_cast<int>(values[7]),
+                                      values[8] < 0.0f ? -1 : 1});
+        }
+        else if (keyword == "coin")
+        {
+            values[2] = 12.0f;
+            ok = ReadFloats(line, values, 2, 1);
+            layout.coins.push_back({Vector2{values[0], values[1]}, values[2], false});
+        }
+        else
+        {
+            error = "line " + std::to_string(lineNumber) + ": unknown keyword '" + keyword + "'";
+            return false;
+        }
+
+        std::string trailing;
+        if (!ok || (line >> trailing))
+        {
+            error = "line " + std::to_string(lineNumber) + ": malformed '" + keyword + "' entry";
+            return false;
+        }
+    }
+
+    if (!hasSpawn)
+    {
+        error = "missing 'spawn' entry";
+        return false;
+    }
+
+    return true;
+}
+
+std::string FormatLevelText(const LevelLayout& layout)
+{
+    std::string text;
+    char line[256];
+
+    text += "# SkyBound level\n";
+    std::snprintf(line, sizeof(line), "spawn %g %g\n\n", layout.spawnPoint.x, layout.spawnPoint.y);
+    text += line;
+
+    for (const Platform& platform : layout.platforms)
+    {
+        const Rectangle& b = platform.bounds;
+        if (platform.moving)
+        {
+            std::snprintf(line, sizeof(line), "moving %g %g %g %g %g %g %g\n",
+                          platform.startPosition.x, platform.startPosition.y, b.width, b.height,
+                          platform.endPosition.x, platform.endPosition.y, platform.travelTime);
+        }
+        else
+        {
+            std::snprintf(line, sizeof(line), "platform %g %g %g %g\n", b.x, b.y, b.width, b.height);
+        }
+        text += line;
+    }
+
+    text += "\n";
+    for (const Enemy& enemy : layout.enemies)
+    {
+        const Rectangle& b = enemy.bounds;
+        std::snprintf(line, sizeof(line), "enemy %g %g %g %g %g %g %g %d %d\n",
+                      b.x, b.y, b.width, b.height, enemy.speed, enemy.leftLimit, enemy.rightLimit,
+                      enemy.damage, enemy.direction);
+        text += line;
+    }
+
+    text += "\n";
+    for (const Coin& coin : layout.coins)
+    {
+        std::snprintf(line, sizeof(line), "coin %g %g %g\n", coin.position.x, coin.position.y, coin.radius);
+        text += line;
+    }
+
+    return text;
+}
+
+bool WriteLevelFile(const std::string& path, const LevelLayout& layout)
+{
+    LevelFileHeader header{};
+    header.magic = LEVEL_FILE_MAGIC;
+    header.version = LEVEL_FILE_VERSION;
+    header.endianTag = LEVEL_FILE_ENDIAN_TAG;
+    header.spawnX = layout.spawnPoint.x;
+    header.spawnY = layout.spawnPoint.y;
+    header.platformCount = static_cast<std::uint32_t>(layout.platforms.size());
+    header.enemyCount = static_cast<std::uint32_t>(layout.enemies.size());
+    header.coinCount = static_cast<std::uint32_t>(layout.coins.size());
+
+    std::size_t offset = AlignSection(sizeof(LevelFileHeader));
+    header.platformOffset = static_cast<std::uint32_t>(offset);
+    offset = AlignSection(offset + layout.platforms.size() * sizeof(LevelPlatformRecord));
+    header.enemyOffset = static_cast<std::uint32_t>(offset);
+    offset = AlignSection(offset + layout.enemies.size() * sizeof(LevelEnemyRecord));
+    header.coinOffset = static_cast<std::uint32_t>(offset);
+    offset = AlignSection(offset + layout.coins.size() * sizeof(LevelCoinRecord));
+    header.fileSize = static_cast<std::uint32_t>(offset);
+
+    std::vector<unsigned char> buffer(offset, 0);
+    std::memcpy(buffer.data(), &header, sizeof(header));
+
+    for (std::size_t i = 0; i < layout.platforms.size(); ++i)
+    {
+        const Platform& platform = layout.platforms[i];
+        LevelPlatformRecord record{};
+        record.x = platform.bounds.x;
+        record.y = platform.bounds.y;
+        record.width = platform.bounds.width;
+        record.height = platform.bounds.height;
+        record.startX = platform.startPosition.x;
+        record.startY = platform.startPosition.y;
+        record.endX = platform.endPosition.x;
+        record.endY = platform.endPosition.y;
+        record.travelTime = platform.travelTime;
+        record.moving = platform.moving ? 1u : 0u;
+        std::memcpy(buffer.data() + header.platformOffset + i * sizeof(record), &record, sizeof(record));
+    }
+
+    for (std::size_t i = 0; i < layout.enemies.size(); ++i)
+    {
+        const Enemy& enemy = layout.enemies[i];
+        LevelEnemyRecord record{};
+        record.x = enemy.bounds.x;
+        record.y = enemy.bounds.y;
+        record.width = enemy.bounds.width;
+        record.height = enemy.bounds.height;
+        record.speed = enemy.speed;
+        record.leftLimit = enemy.leftLimit;
+        record.rightLimit = enemy.rightLimit;
+        record.damage = enemy.damage;
+        record.direction = enemy.direction;
+        std::memcpy(buffer.data() + header.enemyOffset + i * sizeof(record), &record, sizeof(record));
+    }
+
+    for (std::size_t i = 0; i < layout.coins.size(); ++i)
+    {
+        const Coin& coin = layout.coins[i];
+        LevelCoinRecord record{};
+        record.x = coin.position.x;
+        record.y = coin.position.y;
+        record.radius = coin.radius;
+        std::memcpy(buffer.data() + header.coinOffset + i * sizeof(record), &record, sizeof(record));
+    }
+
+    std::FILE* file = std::fopen(path.c_str(), "wb");
+    if (file == nullptr)
+    {
+        return false;
+    }
+
+    const bool ok = std::fwrite(buffer.data(), 1, buffer.size(), file) == buffer.size();
+    return std::fclose(file) == 0 && ok;
+}
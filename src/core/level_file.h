@@ -0,0 +1,80 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "level.h"
+
+// Compiled level format (.skl). Little-endian, every section 16-byte aligned,
+// records are fixed-size so a mapped file is read in place: loading is header
+// validation plus pointer fixup, never a parse. Bump LEVEL_FILE_VERSION when
+// any record changes.
+constexpr std::uint32_t LEVEL_FILE_MAGIC = 0x4C424B53u; // "SKBL"
+constexpr std::uint32_t LEVEL_FILE_VERSION = 1;
+constexpr std::uint32_t LEVEL_FILE_ENDIAN_TAG = 0x01020304u;
+
+struct LevelFileHeader
+{
+    std::uint32_t magic;
+    std::uint32_t version;
+    std::uint32_t endianTag;
+    std::uint32_t fileSize;
+    float spawnX;
+    float spawnY;
+    std::uint32_t platformCount;
+    std::uint32_t platformOffset;
+    std::uint32_t enemyCount;
+    std::uint32_t enemyOffset;
+    std::uint32_t coinCount;
+    std::uint32_t coinOffset;
+    std::uint32_t reserved[4];
+};
+
+struct LevelPlatformRecord
+{
+    float x, y, width, height;
+    float startX, startY, endX, endY;
+    float travelTime;
+    std::uint32_t moving;
+    std::uint32_t reserved[2];
+};
+
+struct LevelEnemyRecord
+{
+    float x, y, width, height;
+    float speed;
+    float leftLimit;
+    float rightLimit;
+    std::int32_t damage;
+    std::int32_t direction;
+    std::uint32_t reserved[3];
+};
+
+struct LevelCoinRecord
+{
+    float x, y, radius;
+    std::uint32_t reserved;
+};
+
+static_assert(sizeof(LevelFileHeader) == 64, "LevelFileHeader layout changed");
+static_assert(sizeof(LevelPlatformRecord) == 48, "LevelPlatformRecord layout changed");
+static_assert(sizeof(LevelEnemyRecord) == 48, "LevelEnemyRecord layout changed");
+static_assert(sizeof(LevelCoinRecord) == 16, "LevelCoinRecord layout changed");
+
+// Typed pointers into a compiled level that lives somewhere else (usually a
+// MappedFile). Only valid while that memory is.
+struct LevelView
+{
+    const LevelFileHeader* header{nullptr};
+    const LevelPlatformRecord* platforms{nullptr};
+    const LevelEnemyRecord* enemies{nullptr};
+    const LevelCoinRecord* coins{nullptr};
+};
+
+bool OpenLevelView(const unsigned char* data, std::size_t size, LevelView& view);
+LevelLayout MakeLevelLayout(const LevelView& view, LevelArena* arena = nullptr);
+
+bool ParseLevelText(const std::string& text, LevelLayout& layout, std::string& error);
+std::string FormatLevelText(const LevelLayout& layout);
+bool WriteLevelFile(const std::string& path, const LevelLayout& layout);
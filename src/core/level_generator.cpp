@@ -0,0 +1,548 @@
+#include "level_generator.h"
+
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <cmath>
+#include <utility>
+#include <vector>
+
+#include "random.h"
+#include "weather.h"
+
+namespace
+{
+    // The slowest supported tick rate; a coarse step loses up to half a step
+    // of rise at the apex.
+    constexpr float COARSEST_TICK = 1.0f / 30.0f;
+    constexpr float JUMP_SAFETY = 0.85f;
+    // Moving platforms are checked at this many points along their path.
+    constexpr int PATH_SAMPLES = 9;
+
+    constexpr int GENERATOR_MAX_ATTEMPTS = 4;
+    constexpr float GROUND_TOP = 400.0f;
+    constexpr float GROUND_THICKNESS = 64.0f;
+    constexpr float PLATFORM_THICKNESS = 24.0f;
+    constexpr float LEVEL_MARGIN = 400.0f;
+    constexpr float CHAIN_START_X = 240.0f;
+    // Narrow enough to read as one jump, wide enough to fall through.
+    constexpr float MIN_GAP = 48.0f;
+    constexpr float ENEMY_SIZE = 32.0f;
+    constexpr float COIN_RADIUS = 12.0f;
+    constexpr int FALLBACK_STEPS = 6;
+    constexpr float FALLBACK_STEP_WIDTH = 200.0f;
+
+    float Lerp(float a, float b, float t)
+    {
+        return a + (b - a) * t;
+    }
+
+    int SampleCount(const Platform& platform)
+    {
+        return platform.moving ? PATH_SAMPLES : 1;
+    }
+
+    Rectangle PlatformAt(const Platform& platform, int sample)
+    {
+        if (!platform.moving)
+        {
+            return platform.bounds;
+        }
+        const float t = static_cast<float>(sample) / static_cast<float>(PATH_SAMPLES - 1);
+        return {Lerp(platform.startPosition.x, platform.endPosition.x, t),
+                Lerp(platform.startPosition.y, platform.endPosition.y, t),
+                platform.bounds.width,
+                platform.bounds.height};
+    }
+
+    bool CanJump(const Rectangle& from, const Rectangle& to, const JumpLimits& limits)
+    {
+        const float rise = from.y - to.y;
+        const float gap = std::max({0.0f, to.x - (from.x + from.width), from.x - (to.x + to.width)});
+        const float maxGap = limits.MaxGap(rise);
+        if (maxGap < 0.0f || gap > maxGap)
+        {
+            return false;
+        }
+        if (gap <= 0.0f && rise > 0.0f)
+        {
+            // Directly underneath: the take-off surface has to reach out past
+            // the target, or the jump ends against its underside.
+            return from.x <= to.x - limits.playerWidth || from.x + from.width >= to.x + to.width + limits.playerWidth;
+        }
+        return true;
+    }
+
+    bool CanJumpBetween(const Platform& from, const Platform& to, const JumpLimits& limits)
+    {
+        for (int a = 0; a < SampleCount(from); ++a)
+        {
+            for (int b = 0; b < SampleCount(to); ++b)
+            {
+                if (CanJump(PlatformAt(from, a), PlatformAt(to, b), limits))
+                {
+                    return true;
+                }
+            }
+        }
+        return false;
+    }
+
+    // Marks everything reachable from `start` along jumps, or against them
+    // when `reverse` is set.
+    void FloodJumps(const LevelLayout& layout, const JumpLimits& limits, std::size_t start, bool reverse, std::vector<char>& reached)
+    {
+        reached.assign(layout.platforms.size(), 0);
+        std::vector<std::size_t> open{start};
+        reached[start] = 1;
+        while (!open.empty())
+        {
+            const std::size_t current = open.back();
+            open.pop_back();
+            for (std::size_t next = 0; next < layout.platforms.size(); ++next)
+            {
+                if (reached[next])
+                {
+                    continue;
+                }
+                const Platform& from = layout.platforms[reverse ? next : current];
+                const Platform& to = layout.platforms[reverse ? current : next];
+                if (CanJumpBetween(from, to, limits))
+                {
+                    reached[next] = 1;
+                    open.push_back(next);
+                }
+            }
+        }
+    }
+
+    bool CanCollect(const Coin& coin, const Platform& platform, const JumpLimits& limits)
+    {
+        for (int sample = 0; sample < SampleCount(platform); ++sample)
+        {
+            const Rectangle surface = PlatformAt(platform, sample);
+            const float reach = limits.playerWidth + coin.radius;
+            if (coin.position.x >= surface.x - reach && coin.position.x <= surface.x + surface.width + reach &&
+                coin.position.y + coin.radius >= surface.y - limits.playerHeight - limits.maxRise &&
+                coin.position.y - coin.radius <= surface.y)
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    std::uint32_t AttemptSeed(std::uint32_t seed, int level, int attempt)
+    {
+        return seed ^ (static_cast<std::uint32_t>(level) * 0x9E3779B9u) ^ (static_cast<std::uint32_t>(attempt) * 0x85EBCA6Bu);
+    }
+
+    void BuildAttempt(Random& rng, int level, const JumpLimits& limits, LevelLayout& out)
+    {
+        out.platforms.clear();
+        out.enemies.clear();
+        out.coins.clear();
+        out.spawnPoint = {0.0f, GROUND_TOP - limits.playerHeight};
+
+        // 0 at level 1, 1 from level 16 on.
+        const float difficulty = std::min(static_cast<float>(level - 1) / 15.0f, 1.0f);
+        const int chainLength = std::min(6 + 3 * level, GENERATED_MAX_PLATFORMS - 1);
+        const int maxTier = std::min(2 + level / 2, 5);
+        // Heights come in tiers one comfortable jump apart. Tier 1 can be
+        // jumped onto from the ground; from tier 2 up there is room to walk
+        // underneath, so a fall never leaves the player boxed in.
+        const float tierStep = limits.maxRise * 0.92f;
+
+        // The ground comes first and is sized once the chain is laid out.
+        out.platforms.push_back({Rectangle{-LEVEL_MARGIN, GROUND_TOP, 0.0f, GROUND_THICKNESS}, {-LEVEL_MARGIN, GROUND_TOP}, {-LEVEL_MARGIN, GROUND_TOP}, 0.0f, 0.0f, false});
+
+        int previousTier = 0;
+        // Where the next jump starts from: the right edge of the previous
+        // platform, at the far end of its path when it moves.
+        float previousRight = CHAIN_START_X - MIN_GAP;
+        std::vector<std::size_t> staticPlatforms{};
+        staticPlatforms.reserve(static_cast<std::size_t>(chainLength));
+
+        for (int i = 0; i < chainLength; ++i)
+        {
+            int tier = std::max(1, std::min(previousTier + rng.Range(-1, 1), maxTier));
+            float rise = static_cast<float>(tier - previousTier) * tierStep;
+            if (limits.MaxGap(rise) < MIN_GAP)
+            {
+                tier = std::max(previousTier, 1);
+                rise = static_cast<float>(tier - previousTier) * tierStep;
+            }
+            // Off the ground any gap will do; the ground runs underneath.
+            const float maxGap = previousTier == 0 ? MIN_GAP : limits.MaxGap(rise);
+            const float gap = rng.Uniform(MIN_GAP, MIN_GAP + std::max(maxGap - MIN_GAP, 0.0f) * Lerp(0.6f, 1.0f, difficulty));
+            const float y = GROUND_TOP - static_cast<float>(tier) * tierStep;
+            const float x = previousRight + gap;
+
+            const bool moving = i > 0 && rng.Uniform(0.0f, 1.0f) < Lerp(0.15f, 0.4f, difficulty);
+            if (moving)
+            {
+                // A ferry: one jump gets on at the near end of its path, the
+                // next gets off at the far end.
+                const float width = rng.Uniform(Lerp(140.0f, 90.0f, difficulty), Lerp(180.0f, 120.0f, difficulty));
+                const float range = rng.Uniform(80.0f, Lerp(140.0f, 260.0f, difficulty));
+                const float speed = rng.Uniform(60.0f, Lerp(80.0f, 120.0f, difficulty));
+                out.platforms.push_back({Rectangle{x, y, width, PLATFORM_THICKNESS}, {x, y}, {x + range, y}, range / speed, 0.0f, true});
+                previousRight = x + range + width;
+            }
+            else
+            {
+                const float width = rng.Uniform(Lerp(200.0f, 110.0f, difficulty), Lerp(280.0f, 170.0f, difficulty));
+                staticPlatforms.push_back(out.platforms.size());
+                out.platforms.push_back({Rectangle{x, y, width, PLATFORM_THICKNESS}, {x, y}, {x, y}, 0.0f, 0.0f, false});
+                previousRight = x + width;
+            }
+            previousTier = tier;
+        }
+
+        const float levelEnd = previousRight + LEVEL_MARGIN;
+        out.platforms[0].bounds.width = levelEnd + LEVEL_MARGIN;
+
+        // Patrols on the ground, clear of the spawn point, and on the wider
+        // static platforms.
+        const int enemyCount = std::min(level + 1, 24);
+        const float patrolSpeed = std::min(50.0f + 6.0f * static_cast<float>(level), 150.0f);
+        for (int i = 0; i < enemyCount; ++i)
+        {
+            Enemy enemy{};
+            enemy.speed = patrolSpeed * rng.Uniform(0.8f, 1.2f);
+            enemy.direction = rng.Range(0, 1) == 0 ? -1 : 1;
+            const Platform* host = nullptr;
+            if (i % 2 == 1 && !staticPlatforms.empty())
+            {
+                const Platform& candidate = out.platforms[staticPlatforms[static_cast<std::size_t>(rng.Range(0, static_cast<int>(staticPlatforms.size()) - 1))]];
+                if (candidate.bounds.width >= 140.0f)
+                {
+                    host = &candidate;
+                }
+            }
+
+            if (host != nullptr)
+            {
+                enemy.leftLimit = host->bounds.x;
+                enemy.rightLimit = host->bounds.x + host->bounds.width - ENEMY_SIZE;
+                enemy.bounds = {enemy.leftLimit, host->bounds.y - ENEMY_SIZE, ENEMY_SIZE, ENEMY_SIZE};
+            }
+            else
+            {
+                enemy.leftLimit = rng.Uniform(CHAIN_START_X + 200.0f, std::max(levelEnd - 400.0f, CHAIN_START_X + 200.0f));
+                enemy.rightLimit = enemy.leftLimit + rng.Uniform(150.0f, 320.0f);
+                enemy.bounds = {enemy.leftLimit, GROUND_TOP - ENEMY_SIZE, ENEMY_SIZE, ENEMY_SIZE};
+            }
+            out.enemies.push_back(enemy);
+        }
+
+        // Coins spread along the chain, always including its last static
+        // platform, each within a jump of the surface below it.
+        const int staticCount = static_cast<int>(staticPlatforms.size());
+        const int coinCount = std::min(3 + level, staticCount);
+        for (int i = 0; i < coinCount; ++i)
+        {
+            const int pick = (i + 1) * staticCount / coinCount - 1;
+            const Rectangle& surface = out.platforms[staticPlatforms[static_cast<std::size_t>(pick)]].bounds;
+            const float x = surface.x + rng.Uniform(16.0f, surface.width - 16.0f);
+            const float y = surface.y - limits.playerHeight * 0.5f - rng.Uniform(0.0f, limits.maxRise * 0.6f);
+            out.coins.push_back({Vector2{x, y}, COIN_RADIUS, false});
+        }
+    }
+
+    // What a level falls back to when every attempt fails: steps one tier
+    // above a ground that runs under all of them, each with a coin on top.
+    // Every step is a single rise of less than maxRise straight off the
+    // ground and a drop back onto it, so it passes CheckLevelReachability
+    // whatever the jump limits.
+    void BuildFallbackLevel(const JumpLimits& limits, LevelLayout& out)
+    {
+        out.platforms.clear();
+        out.enemies.clear();
+        out.coins.clear();
+        out.spawnPoint = {0.0f, GROUND_TOP - limits.playerHeight};
+
+        const float stepY = GROUND_TOP - limits.maxRise * 0.92f;
+        const float stepSpacing = FALLBACK_STEP_WIDTH + std::max(MIN_GAP, limits.playerWidth * 2.0f);
+        const float levelEnd = CHAIN_START_X + static_cast<float>(FALLBACK_STEPS) * stepSpacing + LEVEL_MARGIN;
+        out.platforms.push_back({Rectangle{-LEVEL_MARGIN, GROUND_TOP, levelEnd + LEVEL_MARGIN, GROUND_THICKNESS}, {-LEVEL_MARGIN, GROUND_TOP}, {-LEVEL_MARGIN, GROUND_TOP}, 0.0f, 0.0f, false});
+        for (int i = 0; i < FALLBACK_STEPS; ++i)
+        {
+            const float x = CHAIN_START_X + static_cast<float>(i) * stepSpacing;
+            out.platforms.push_back({Rectangle{x, stepY, FALLBACK_STEP_WIDTH, PLATFORM_THICKNESS}, {x, stepY}, {x, stepY}, 0.0f, 0.0f, false});
+            out.coins.push_back({Vector2{x + FALLBACK_STEP_WIDTH * 0.5f, stepY - limits.playerHeight * 0.5f}, COIN_RADIUS, false});
+        }
+
+        Enemy enemy{};
+        enemy.speed = 60.0f;
+        enemy.direction = 1;
+        enemy.leftLimit = CHAIN_START_X + stepSpacing;
+        enemy.rightLimit = enemy.leftLimit + 240.0f;
+        enemy.bounds = {enemy.leftLimit, GROUND_TOP - ENEMY_SIZE, ENEMY_SIZE, ENEMY_SIZE};
+        out.enemies.push_back(enemy);
+
+        assert(CheckLevelReachability(out, limits) && "fallback level must be reachable");
+    }
+}
+
+float JumpLimits::MaxGap(float rise) const
+{
+    if (rise > maxRise)
+    {
+        return -1.0f;
+    }
+    const float discriminant = std::max(jumpSpeed * jumpSpeed - 2.0f * gravity * rise, 0.0f);
+    const float airTime = (jumpSpeed + std::sqrt(discriminant)) / gravity;
+    return runSpeed * airTime * JUMP_SAFETY;
+}
+
+JumpLimits MakeJumpLimits(const Player& player, float gravity)
+{
+    JumpLimits limits{};
+    limits.jumpSpeed = player.jumpStrength;
+    limits.runSpeed = player.speed;
+    limits.gravity = gravity + MAX_WEATHER_DOWNFORCE;
+    limits.playerWidth = player.width;
+    limits.playerHeight = player.height;
+    const float apex = limits.jumpSpeed * limits.jumpSpeed / (2.0f * limits.gravity) - limits.jumpSpeed * COARSEST_TICK * 0.5f;
+    limits.maxRise = std::max(apex, 0.0f) * JUMP_SAFETY;
+    return limits;
+}
+
+bool CheckLevelReachability(const LevelLayout& layout, const JumpLimits& limits)
+{
+    // The spawn point stands on the highest platform under the player's feet.
+    const float feet = layout.spawnPoint.y + limits.playerHeight;
+    std::size_t start = layout.platforms.size();
+    for (std::size_t i = 0; i < layout.platforms.size(); ++i)
+    {
+        const Rectangle& bounds = layout.platforms[i].bounds;
+        const bool under = bounds.x < layout.spawnPoint.x + limits.playerWidth && bounds.x + bounds.width > layout.spawnPoint.x;
+        if (under && bounds.y >= feet - 1.0f && (start == layout.platforms.size() || bounds.y < layout.platforms[start].bounds.y))
+        {
+            start = i;
+        }
+    }
+    if (start == layout.platforms.size())
+    {
+        return false;
+    }
+
+    std::vector<char> reachable{};
+    std::vector<char> returns{};
+    FloodJumps(layout, limits, start, false, reachable);
+    FloodJumps(layout, limits, start, true, returns);
+    for (std::size_t i = 0; i < layout.platforms.size(); ++i)
+    {
+        if (reachable[i] && !returns[i])
+        {
+            return false;
+        }
+    }
+
+    for (const Coin& coin : layout.coins)
+    {
+        bool collectable = false;
+        for (std::size_t i = 0; i < layout.platforms.size() && !collectable; ++i)
+        {
+            collectable = reachable[i] && CanCollect(coin, layout.platforms[i], limits);
+        }
+        if (!collectable)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool GenerateLevel(std::uint32_t seed, int level, const JumpLimits& limits, LevelLayout& out)
+{
+    level = std::max(level, 1);
+    for (int attempt = 0; attempt < GENERATOR_MAX_ATTEMPTS; ++attempt)
+    {
+        Random rng(AttemptSeed(seed, level, attempt));
+        BuildAttempt(rng, level, limits, out);
+        if (CheckLevelReachability(out, limits))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+LevelGenerator::LevelGenerator(std::uint32_t seed, const JumpLimits& limits)
+    : seed(seed),
+      limits(limits)
+{
+}
+
+LevelGenerator::~LevelGenerator()
+{
+    {
+        const std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    if (worker.joinable())
+    {
+        worker.join();
+    }
+}
+
+void LevelGenerator::Prefetch(int level)
+{
+    {
+        const std::lock_guard<std::mutex> lock(mutex);
+        if (FindEntry(level) != nullptr)
+        {
+            return;
+        }
+        Entry* entry = TakeEntry();
+        if (entry == nullptr)
+        {
+            // Every slot is busy; the level is built on demand instead.
+            return;
+        }
+        entry->level = level;
+        entry->ready = false;
+        entry->queued = true;
+
+        if (!worker.joinable())
+        {
+            worker = std::thread(&LevelGenerator::WorkerMain, this);
+        }
+    }
+    wake.notify_one();
+}
+
+void LevelGenerator::Load(int level, LevelLayout& out)
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    Entry* entry = FindEntry(level);
+    if (entry != nullptr && !entry->queued)
+    {
+        stats.prefetched += 1;
+        if (!entry->ready)
+        {
+            stats.waited += 1;
+            finished.wait(lock, [entry]() { return entry->ready; });
+        }
+    }
+    else
+    {
+        // Never requested, or the worker has not got to it yet: build it here
+        // rather than wait behind whatever the worker is doing.
+        entry = entry != nullptr ? entry : TakeEntry();
+        if (entry == nullptr)
+        {
+            lock.unlock();
+            if (!GenerateLevel(seed, level, limits, out))
+            {
+                BuildFallbackLevel(limits, out);
+            }
+            return;
+        }
+        entry->level = level;
+        entry->ready = false;
+        entry->queued = false;
+        entry->building = true;
+        lock.unlock();
+        Generate(*entry);
+        lock.lock();
+    }
+
+    entry->lastUse = ++useCounter;
+    out.platforms.assign(entry->layout.platforms.begin(), entry->layout.platforms.end());
+    out.enemies.assign(entry->layout.enemies.begin(), entry->layout.enemies.end());
+    out.coins.assign(entry->layout.coins.begin(), entry->layout.coins.end());
+    out.spawnPoint = entry->layout.spawnPoint;
+}
+
+LevelGeneratorStats LevelGenerator::GetStats() const
+{
+    const std::lock_guard<std::mutex> lock(mutex);
+    return stats;
+}
+
+LevelGenerator::Entry* LevelGenerator::FindEntry(int level)
+{
+    for (Entry& entry : entries)
+    {
+        if ((entry.ready || entry.queued || entry.building) && entry.level == level)
+        {
+            return &entry;
+        }
+    }
+    return nullptr;
+}
+
+LevelGenerator::Entry* LevelGenerator::FindQueued()
+{
+    for (Entry& entry : entries)
+    {
+        if (entry.queued)
+        {
+            return &entry;
+        }
+    }
+    return nullptr;
+}
+
+LevelGenerator::Entry* LevelGenerator::TakeEntry()
+{
+    // An empty slot, else the least recently used finished one.
+    Entry* best = nullptr;
+    for (Entry& entry : entries)
+    {
+        if (entry.queued || entry.building)
+        {
+            continue;
+        }
+        if (!entry.ready)
+        {
+            return &entry;
+        }
+        if (best == nullptr || entry.lastUse < best->lastUse)
+        {
+            best = &entry;
+        }
+    }
+    return best;
+}
+
+void LevelGenerator::Generate(Entry& entry)
+{
+    // Runs without the lock: nothing else touches an entry while it builds.
+    const auto start = std::chrono::steady_clock::now();
+    if (!GenerateLevel(seed, entry.level, limits, entry.layout))
+    {
+        BuildFallbackLevel(limits, entry.layout);
+    }
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    const std::lock_guard<std::mutex> lock(mutex);
+    entry.ready = true;
+    entry.building = false;
+    stats.generated += 1;
+    stats.lastGenerationSeconds = seconds;
+    finished.notify_all();
+}
+
+void LevelGenerator::WorkerMain()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    for (;;)
+    {
+        wake.wait(lock, [this]() { return stopping || FindQueued() != nullptr; });
+        if (stopping)
+        {
+            return;
+        }
+        Entry* next = FindQueued();
+        next->queued = false;
+        next->building = true;
+        lock.unlock();
+        Generate(*next);
+        lock.lock();
+    }
+}
@@ -0,0 +1,112 @@
+#pragma once
+
+#include <array>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+
+#include "level.h"
+#include "player.h"
+
+// Generated levels cached per library: the one being played, the next one and
+// level 1, which every game over returns to.
+constexpr int LEVEL_GENERATOR_CACHE_SIZE = 3;
+constexpr int GENERATED_MAX_PLATFORMS = 160;
+
+// What a player can jump, planned for the worst case: storm downforce on top
+// of gravity, the coarsest tick rate and a safety margin.
+struct JumpLimits
+{
+    float jumpSpeed{0.0f};
+    float runSpeed{0.0f};
+    float gravity{0.0f};
+    float playerWidth{0.0f};
+    float playerHeight{0.0f};
+    // Highest a landing surface may sit above the take-off surface.
+    float maxRise{0.0f};
+
+    // Widest horizontal gap that can be cleared landing `rise` higher (lower
+    // when negative); negative when `rise` is out of reach.
+    float MaxGap(float rise) const;
+};
+
+JumpLimits MakeJumpLimits(const Player& player, float gravity);
+
+// True when every coin can be collected and no platform strands the player:
+// every platform reachable from the spawn point can also get back to it.
+// Moving platforms count as reachable at any point of their path, since the
+// player can wait for them.
+bool CheckLevelReachability(const LevelLayout& layout, const JumpLimits& limits);
+
+// Builds level `level` from `seed` into `out`, reusing its storage. A ground
+// floor runs under the whole level; above it, a chain of platforms climbs and
+// drops in steps the player can always jump, with moving platforms ferrying
+// across the wider gaps. Length, gaps, platform count, enemies and coins all
+// grow with the level number. False if no attempt passed
+// CheckLevelReachability.
+bool GenerateLevel(std::uint32_t seed, int level, const JumpLimits& limits, LevelLayout& out);
+
+struct LevelGeneratorStats
+{
+    int generated{0};
+    // Levels that were ready, or being built, when they were needed.
+    int prefetched{0};
+    // Of those, how many were still being built and had to be waited for.
+    int waited{0};
+    double lastGenerationSeconds{0.0};
+};
+
+// Generates levels on a worker thread of its own ahead of when they are
+// needed. The output depends only on the seed and level number, never on
+// timing, so a level built ahead and one built on demand are identical.
+// A level no attempt could generate is replaced by a plain row of steps that
+// passes CheckLevelReachability by construction.
+class LevelGenerator
+{
+public:
+    LevelGenerator(std::uint32_t seed, const JumpLimits& limits);
+    ~LevelGenerator();
+
+    LevelGenerator(const LevelGenerator&) = delete;
+    LevelGenerator& operator=(const LevelGenerator&) = delete;
+
+    // Starts building `level` in the background, unless it is cached or
+    // already under way. Never blocks.
+    void Prefetch(int level);
+    // Copies `level` into `out`: from the cache, waiting if the worker is
+    // still on it, or built right here if it was never requested.
+    void Load(int level, LevelLayout& out);
+
+    LevelGeneratorStats GetStats() const;
+
+private:
+    struct Entry
+    {
+        int level{0};
+        bool ready{false};
+        // Waiting for the worker to pick it up.
+        bool queued{false};
+        bool building{false};
+        std::uint64_t lastUse{0};
+        LevelLayout layout{};
+    };
+
+    Entry* FindEntry(int level);
+    Entry* FindQueued();
+    // Null when every slot is queued or building.
+    Entry* TakeEntry();
+    void Generate(Entry& entry);
+    void WorkerMain();
+
+    std::uint32_t seed{0};
+    JumpLimits limits{};
+    mutable std::mutex mutex{};
+    std::condition_variable wake{};
+    std::condition_variable finished{};
+    std::array<Entry, LEVEL_GENERATOR_CACHE_SIZE> entries{};
+    std::uint64_t useCounter{0};
+    bool stopping{false};
+    LevelGeneratorStats stats{};
+    std::thread worker{};
+};
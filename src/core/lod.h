@@ -0,0 +1,74 @@
+#pragma once
+
+#include <cstddef>
+
+// Moving entities are scheduled by how far their whole path is from the
+// player. Motion is a closed form of the ticks since each entity's anchor, so
+// an entity brought up to date after skipping ticks lands exactly where one
+// stepped every tick would have; only how often the work is done changes.
+
+// Within this of the focus everything runs every tick. Never less than the
+// view is wide, so nothing on screen can run below full rate.
+constexpr float LOD_FULL_RATE_DISTANCE = 1600.0f;
+// Beyond the full-rate range by more than this, entities are not updated at
+// all until they come back into range.
+constexpr float LOD_REDUCED_BAND = 1000.0f;
+// Reduced-rate entities are brought up to date every this many ticks,
+// staggered by row so the work spreads evenly.
+constexpr int LOD_REDUCED_INTERVAL = 4;
+
+enum class LodTier : unsigned char
+{
+    Full,
+    Reduced,
+    Dormant
+};
+
+// Where the simulation is watched from. The default runs everything at full rate.
+struct LodFocus
+{
+    float x{0.0f};
+    float fullRateDistance{LOD_FULL_RATE_DISTANCE};
+    bool enabled{false};
+};
+
+// How many entities were in each tier on the latest update.
+struct LodCounts
+{
+    int full{0};
+    int reduced{0};
+    int dormant{0};
+};
+
+// Tier of an entity that only ever moves within [left, right].
+inline LodTier GetLodTier(const LodFocus& focus, float left, float right)
+{
+    if (!focus.enabled)
+    {
+        return LodTier::Full;
+    }
+
+    const float distance = focus.x < left ? left - focus.x : (focus.x > right ? focus.x - right : 0.0f);
+    if (distance <= focus.fullRateDistance)
+    {
+        return LodTier::Full;
+    }
+    return distance <= focus.fullRateDistance + LOD_REDUCED_BAND ? LodTier::Reduced : LodTier::Dormant;
+}
+
+// Whether the entity in `row` is brought up to date on tick `clock`, counting it in `counts`.
+inline bool IsLodDue(LodTier tier, int clock, std::size_t row, LodCounts& counts)
+{
+    switch (tier)
+    {
+        case LodTier::Full:
+            ++counts.full;
+            return true;
+        case LodTier::Reduced:
+            ++counts.reduced;
+            return (static_cast<unsigned>(clock) + static_cast<unsigned>(row)) % LOD_REDUCED_INTERVAL == 0;
+        default:
+            ++counts.dormant;
+            return false;
+    }
+}
@@ -0,0 +1,54 @@
+#include "loopback_transport.h"
+
+#include <cstring>
+
+LoopbackTransport::LoopbackTransport(const LinkConditions& conditions, std::uint32_t seed)
+    : conditions(conditions),
+      rng(seed)
+{
+    inFlight.reserve(LOOPBACK_MAX_IN_FLIGHT);
+}
+
+void LoopbackTransport::Send(int from, const unsigned char* data, std::size_t size, double now)
+{
+    sent += 1;
+    const bool lost = conditions.loss > 0.0f && rng.Uniform(0.0f, 1.0f) < conditions.loss;
+    const double delay = conditions.latency + static_cast<double>(rng.Uniform(0.0f, 1.0f)) * conditions.jitter;
+    if (lost || size > LOOPBACK_MAX_PACKET_BYTES || inFlight.size() >= LOOPBACK_MAX_IN_FLIGHT)
+    {
+        dropped += 1;
+        return;
+    }
+
+    Packet packet{};
+    packet.deliverAt = now + delay;
+    packet.to = 1 - from;
+    packet.size = size;
+    std::memcpy(packet.data.data(), data, size);
+    inFlight.push_back(packet);
+}
+
+bool LoopbackTransport::Receive(int to, double now, std::vector<unsigned char>& packet)
+{
+    // A handful of packets are ever in flight, so a scan beats keeping a heap.
+    std::size_t earliest = inFlight.size();
+    for (std::size_t i = 0; i < inFlight.size(); ++i)
+    {
+        const Packet& candidate = inFlight[i];
+        if (candidate.to == to && candidate.deliverAt <= now &&
+            (earliest == inFlight.size() || candidate.deliverAt < inFlight[earliest].deliverAt))
+        {
+            earliest = i;
+        }
+    }
+    if (earliest == inFlight.size())
+    {
+        return false;
+    }
+
+    const Packet& delivered = inFlight[earliest];
+    packet.assign(delivered.data.begin(), delivered.data.begin() + static_cast<std::ptrdiff_t>(delivered.size));
+    inFlight[earliest] = inFlight.back();
+    inFlight.pop_back();
+    return true;
+}
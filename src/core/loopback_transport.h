@@ -0,0 +1,57 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "random.h"
+
+constexpr std::size_t LOOPBACK_MAX_PACKET_BYTES = 512;
+constexpr std::size_t LOOPBACK_MAX_IN_FLIGHT = 1024;
+
+struct LinkConditions
+{
+    // One way, in seconds.
+    double latency{0.05};
+    // Each packet is delayed by up to this much on top of the latency, so
+    // packets can arrive out of order.
+    double jitter{0.01};
+    // Chance in [0, 1] that a packet is silently dropped.
+    float loss{0.0f};
+};
+
+// In-process stand-in for a UDP socket pair between two endpoints, 0 and 1.
+// Packets are delivered after the link's latency plus a random jitter, may be
+// reordered or dropped, and are never duplicated. Time is whatever clock the
+// caller passes in, so a headless run is as reproducible as its seed.
+class LoopbackTransport
+{
+public:
+    explicit LoopbackTransport(const LinkConditions& conditions, std::uint32_t seed = Random::DEFAULT_SEED);
+
+    // Queues a packet for the other endpoint; oversized packets and packets
+    // beyond the in-flight limit are dropped, as a full socket buffer would.
+    void Send(int from, const unsigned char* data, std::size_t size, double now);
+    // Takes the earliest packet for `to` due by `now`; false when none is.
+    bool Receive(int to, double now, std::vector<unsigned char>& packet);
+
+    const LinkConditions& GetConditions() const { return conditions; }
+    int GetSentCount() const { return sent; }
+    int GetDroppedCount() const { return dropped; }
+
+private:
+    struct Packet
+    {
+        double deliverAt{0.0};
+        int to{0};
+        std::size_t size{0};
+        std::array<unsigned char, LOOPBACK_MAX_PACKET_BYTES> data{};
+    };
+
+    LinkConditions conditions{};
+    Random rng;
+    std::vector<Packet> inFlight{};
+    int sent{0};
+    int dropped{0};
+};
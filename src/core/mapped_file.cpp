@@ -0,0 +1,175 @@
+#include "mapped_file.h"
+
+#include <cstdio>
+#include <utility>
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+    bool ReadWholeFile(const std::string& path, std::vector<unsigned char>& buffer)
+    {
+        std::FILE* file = std::fopen(path.c_str(), "rb");
+        if (file == nullptr)
+        {
+            return false;
+        }
+
+        buffer.clear();
+        unsigned char chunk[4096];
+        std::size_t read = 0;
+        while ((read = std::fread(chunk, 1, sizeof(chunk), file)) > 0)
+        {
+            buffer.insert(buffer.end(), chunk, chunk + read);
+        }
+
+        const bool ok = std::ferror(file) == 0;
+        std::fclose(file);
+        return ok;
+    }
+
+    const unsigned char* MapWholeFile(const std::string& path, std::size_t& size)
+    {
+#if defined(_WIN32)
+        HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file == INVALID_HANDLE_VALUE)
+        {
+            return nullptr;
+        }
+
+        LARGE_INTEGER fileSize{};
+        if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0)
+        {
+            CloseHandle(file);
+            return nullptr;
+        }
+
+        HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        CloseHandle(file);
+        if (mapping == nullptr)
+        {
+            return nullptr;
+        }
+
+        void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+        CloseHandle(mapping);
+        if (view == nullptr)
+        {
+            return nullptr;
+        }
+
+        size = static_cast<std::size_t>(fileSize.QuadPart);
+        return static_cast<const unsigned char*>(view);
+#else
+        const int fd = open(path.c_str(), O_RDONLY);
+        if (fd < 0)
+        {
+            return nullptr;
+        }
+
+        struct stat info{};
+        if (fstat(fd, &info) != 0 || info.st_size <= 0)
+        {
+            close(fd);
+            return nullptr;
+        }
+
+        void* view = mmap(nullptr, static_cast<std::size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+        close(fd);
+        if (view == MAP_FAILED)
+        {
+            return nullptr;
+        }
+
+        size = static_cast<std::size_t>(info.st_size);
+        return static_cast<const unsigned char*>(view);
+#endif
+    }
+
+    void UnmapWholeFile(const unsigned char* data, std::size_t size)
+    {
+#if defined(_WIN32)
+        (void)size;
+        UnmapViewOfFile(data);
+#else
+        munmap(const_cast<unsigned char*>(data), size);
+#endif
+    }
+}
+
+MappedFile::~MappedFile()
+{
+    Close();
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept
+{
+    *this = std::move(other);
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept
+{
+    if (this != &other)
+    {
+        Close();
+        mapped = other.mapped;
+        size = other.size;
+        fallback = std::move(other.fallback);
+        data = mapped ? other.data : fallback.data();
+        if (!mapped && fallback.empty())
+        {
+            data = nullptr;
+        }
+
+        other.data = nullptr;
+        other.size = 0;
+        other.mapped = false;
+    }
+    return *this;
+}
+
+bool MappedFile::Open(const std::string& path)
+{
+    Close();
+
+    std::size_t mappedSize = 0;
+    if (const unsigned char* view = MapWholeFile(path, mappedSize))
+    {
+        data = view;
+        size = mappedSize;
+        mapped = true;
+        return true;
+    }
+
+    if (!ReadWholeFile(path, fallback) || fallback.empty())
+    {
+        fallback.clear();
+        return false;
+    }
+
+    data = fallback.data();
+    size = fallback.size();
+    return true;
+}
+
+void MappedFile::Close()
+{
+    if (mapped && data != nullptr)
+    {
+        UnmapWholeFile(data, size);
+    }
+
+    data = nullptr;
+    size = 0;
+    mapped = false;
+    fallback.clear();
+}
@@ -0,0 +1,224 @@
+#include "particles.h"
+
+#include <algorithm>
+#include <atomic>
+
+#include "job_system.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define SKYBOUND_PARTICLES_SSE2 1
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define SKYBOUND_PARTICLES_NEON 1
+#endif
+
+namespace
+{
+    // Below this many live particles a hand-off to workers costs more than it saves.
+    constexpr std::size_t PARTICLE_JOB_GRAIN = 4096;
+}
+
+ParticleSystem::ParticleSystem(int capacity, std::uint32_t seed)
+    : x(static_cast<std::size_t>(std::max(capacity, 0))),
+      y(x.size()),
+      velocityX(x.size()),
+      velocityY(x.size()),
+      life(x.size()),
+      startLife(x.size()),
+      size(x.size()),
+      rng(seed)
+{
+}
+
+void ParticleSystem::Seed(std::uint32_t seed)
+{
+    rng.Seed(seed);
+}
+
+void ParticleSystem::Clear()
+{
+    count = 0;
+}
+
+int ParticleSystem::Spawn(const ParticleEmitter& emitter, int requested)
+{
+    const int spawned = std::clamp(requested, 0, GetCapacity() - count);
+    const int end = count + spawned;
+
+    for (int i = count; i < end; ++i)
+    {
+        x[i] = rng.Uniform(emitter.area.x, emitter.area.x + emitter.area.width);
+        y[i] = rng.Uniform(emitter.area.y, emitter.area.y + emitter.area.height);
+        velocityX[i] = rng.Uniform(emitter.minVelocity.x, emitter.maxVelocity.x);
+        velocityY[i] = rng.Uniform(emitter.minVelocity.y, emitter.maxVelocity.y);
+        life[i] = rng.Uniform(emitter.minLife, emitter.maxLife);
+        startLife[i] = life[i];
+        size[i] = rng.Uniform(emitter.minSize, emitter.maxSize);
+    }
+
+    count = end;
+    return spawned;
+}
+
+void ParticleSystem::Update(const ParticleForces& forces, float dt)
+{
+    // Chunks integrate independently; only the earliest expiry is kept, which
+    // does not depend on how the range was split.
+    std::atomic<int> earliest{count};
+    ParallelFor(static_cast<std::size_t>(count), PARTICLE_JOB_GRAIN, [&](std::size_t begin, std::size_t end)
+    {
+        const int chunkFirst = Integrate(forces, dt, static_cast<int>(begin), static_cast<int>(end));
+        int current = earliest.load(std::memory_order_relaxed);
+        while (chunkFirst < current && !earliest.compare_exchange_weak(current, chunkFirst, std::memory_order_relaxed))
+        {
+        }
+    });
+
+    const int first = earliest.load(std::memory_order_relaxed);
+    if (first < count)
+    {
+        Recycle(forces, first);
+    }
+}
+
+int ParticleSystem::Integrate(const ParticleForces& forces, float dt, int begin, int end)
+{
+    const float accelerationX = forces.acceleration.x * dt;
+    const float accelerationY = forces.acceleration.y * dt;
+    const float scale = forces.speedScale * dt;
+    const float driftX = forces.drift.x * dt;
+    const float driftY = forces.drift.y * dt;
+    const float floorY = forces.floor;
+    const float wrapMin = forces.wrapMinX;
+    const float wrapMax = forces.wrapMaxX;
+    const float wrapSpan = wrapMax - wrapMin;
+
+    float* px = x.data();
+    float* py = y.data();
+    float* vx = velocityX.data();
+    float* vy = velocityY.data();
+    float* remaining = life.data();
+    const float* extent = size.data();
+    int first = end;
+
+    // The vector paths and the scalar tail evaluate the same expressions in the
+    // same order, so results do not depend on which path a particle falls in.
+    int i = begin;
+#if defined(SKYBOUND_PARTICLES_SSE2)
+    const __m128 ax = _mm_set1_ps(accelerationX);
+    const __m128 ay = _mm_set1_ps(accelerationY);
+    const __m128 s = _mm_set1_ps(scale);
+    const __m128 dx = _mm_set1_ps(driftX);
+    const __m128 dy = _mm_set1_ps(driftY);
+    const __m128 step = _mm_set1_ps(dt);
+    const __m128 bottom = _mm_set1_ps(floorY);
+    const __m128 left = _mm_set1_ps(wrapMin);
+    const __m128 right = _mm_set1_ps(wrapMax);
+    const __m128 span = _mm_set1_ps(wrapSpan);
+    const __m128 zero = _mm_setzero_ps();
+    for (; i + 4 <= end; i += 4)
+    {
+        const __m128 velX = _mm_add_ps(_mm_loadu_ps(vx + i), ax);
+        const __m128 velY = _mm_add_ps(_mm_loadu_ps(vy + i), ay);
+        const __m128 moved = _mm_add_ps(_mm_loadu_ps(px + i), _mm_add_ps(_mm_mul_ps(velX, s), dx));
+        const __m128 posY = _mm_add_ps(_mm_loadu_ps(py + i), _mm_add_ps(_mm_mul_ps(velY, s), dy));
+        const __m128 lifeLeft = _mm_sub_ps(_mm_loadu_ps(remaining + i), step);
+
+        const __m128 wrapUp = _mm_and_ps(_mm_cmplt_ps(moved, left), span);
+        const __m128 wrapDown = _mm_and_ps(_mm_cmpgt_ps(moved, right), span);
+        _mm_storeu_ps(px + i, _mm_add_ps(moved, _mm_sub_ps(wrapUp, wrapDown)));
+        _mm_storeu_ps(py + i, posY);
+        _mm_storeu_ps(vx + i, velX);
+        _mm_storeu_ps(vy + i, velY);
+        _mm_storeu_ps(remaining + i, lifeLeft);
+
+        const __m128 expired = _mm_or_ps(_mm_cmple_ps(lifeLeft, zero),
+                                         _mm_cmpgt_ps(_mm_sub_ps(posY, _mm_loadu_ps(extent + i)), bottom));
+        const int mask = _mm_movemask_ps(expired);
+        if (mask != 0 && first == end)
+        {
+            first = i + (mask & 1 ? 0 : mask & 2 ? 1 : mask & 4 ? 2 : 3);
+        }
+    }
+#elif defined(SKYBOUND_PARTICLES_NEON)
+    const float32x4_t ax = vdupq_n_f32(accelerationX);
+    const float32x4_t ay = vdupq_n_f32(accelerationY);
+    const float32x4_t s = vdupq_n_f32(scale);
+    const float32x4_t dx = vdupq_n_f32(driftX);
+    const float32x4_t dy = vdupq_n_f32(driftY);
+    const float32x4_t step = vdupq_n_f32(dt);
+    const float32x4_t bottom = vdupq_n_f32(floorY);
+    const float32x4_t left = vdupq_n_f32(wrapMin);
+    const float32x4_t right = vdupq_n_f32(wrapMax);
+    const uint32x4_t span = vreinterpretq_u32_f32(vdupq_n_f32(wrapSpan));
+    const float32x4_t zero = vdupq_n_f32(0.0f);
+    for (; i + 4 <= end; i += 4)
+    {
+        // Separate multiply and add rather than vmlaq, which may fuse.
+        const float32x4_t velX = vaddq_f32(vld1q_f32(vx + i), ax);
+        const float32x4_t velY = vaddq_f32(vld1q_f32(vy + i), ay);
+        const float32x4_t moved = vaddq_f32(vld1q_f32(px + i), vaddq_f32(vmulq_f32(velX, s), dx));
+        const float32x4_t posY = vaddq_f32(vld1q_f32(py + i), vaddq_f32(vmulq_f32(velY, s), dy));
+        const float32x4_t lifeLeft = vsubq_f32(vld1q_f32(remaining + i), step);
+
+        const float32x4_t wrapUp = vreinterpretq_f32_u32(vandq_u32(vcltq_f32(moved, left), span));
+        const float32x4_t wrapDown = vreinterpretq_f32_u32(vandq_u32(vcgtq_f32(moved, right), span));
+        vst1q_f32(px + i, vaddq_f32(moved, vsubq_f32(wrapUp, wrapDown)));
+        vst1q_f32(py + i, posY);
+        vst1q_f32(vx + i, velX);
+        vst1q_f32(vy + i, velY);
+        vst1q_f32(remaining + i, lifeLeft);
+
+        const uint32x4_t expired = vorrq_u32(vcleq_f32(lifeLeft, zero),
+                                             vcgtq_f32(vsubq_f32(posY, vld1q_f32(extent + i)), bottom));
+        if (first == end && (vgetq_lane_u32(expired, 0) | vgetq_lane_u32(expired, 1) |
+                               vgetq_lane_u32(expired, 2) | vgetq_lane_u32(expired, 3)) != 0)
+        {
+            first = i + (vgetq_lane_u32(expired, 0) ? 0 : vgetq_lane_u32(expired, 1) ? 1 : vgetq_lane_u32(expired, 2) ? 2 : 3);
+        }
+    }
+#endif
+    for (; i < end; ++i)
+    {
+        vx[i] += accelerationX;
+        vy[i] += accelerationY;
+        const float moved = px[i] + (vx[i] * scale + driftX);
+        py[i] = py[i] + (vy[i] * scale + driftY);
+        remaining[i] -= dt;
+
+        const float wrapUp = moved < wrapMin ? wrapSpan : 0.0f;
+        const float wrapDown = moved > wrapMax ? wrapSpan : 0.0f;
+        px[i] = moved + (wrapUp - wrapDown);
+
+        if (first == end && (remaining[i] <= 0.0f || py[i] - extent[i] > floorY))
+        {
+            first = i;
+        }
+    }
+
+    return first;
+}
+
+void ParticleSystem::Recycle(const ParticleForces& forces, int first)
+{
+    int i = first;
+    while (i < count)
+    {
+        const bool expired = life[i] <= 0.0f || y[i] - size[i] > forces.floor;
+        if (!expired)
+        {
+            ++i;
+            continue;
+        }
+
+        --count;
+        x[i] = x[count];
+        y[i] = y[count];
+        velocityX[i] = velocityX[count];
+        velocityY[i] = velocityY[count];
+        life[i] = life[count];
+        startLife[i] = startLife[count];
+        size[i] = size[count];
+    }
+}
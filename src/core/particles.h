@@ -0,0 +1,77 @@
+#pragma once
+
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "raylib.h"
+
+#include "random.h"
+
+// Everything acting on a particle system for one update.
+struct ParticleForces
+{
+    Vector2 acceleration{};
+    // Added to the position rate independently of each particle's velocity.
+    Vector2 drift{};
+    // Scales every particle's velocity when integrating position.
+    float speedScale{1.0f};
+    // Particles whose top edge (y - size) passes below this are recycled.
+    float floor{std::numeric_limits<float>::infinity()};
+    // Positions leaving [wrapMinX, wrapMaxX] re-enter from the other side.
+    float wrapMinX{-std::numeric_limits<float>::infinity()};
+    float wrapMaxX{std::numeric_limits<float>::infinity()};
+};
+
+// Spawn distribution; every value is drawn uniformly from its range.
+struct ParticleEmitter
+{
+    Rectangle area{};
+    Vector2 minVelocity{};
+    Vector2 maxVelocity{};
+    float minLife{1.0f};
+    float maxLife{1.0f};
+    float minSize{1.0f};
+    float maxSize{1.0f};
+};
+
+// Fixed-capacity particle pool stored as columns. Spawning appends in bulk,
+// expired particles are recycled by moving the last live one into their slot,
+// and nothing allocates after construction. Each system owns its RNG so effects
+// never perturb the gameplay random stream.
+class ParticleSystem
+{
+public:
+    explicit ParticleSystem(int capacity = 0, std::uint32_t seed = Random::DEFAULT_SEED);
+
+    void Seed(std::uint32_t seed);
+    void Clear();
+
+    // Returns how many were spawned; a full pool drops the rest.
+    int Spawn(const ParticleEmitter& emitter, int count);
+    void Update(const ParticleForces& forces, float dt);
+
+    int GetCount() const { return count; }
+    int GetCapacity() const { return static_cast<int>(x.size()); }
+    const float* GetX() const { return x.data(); }
+    const float* GetY() const { return y.data(); }
+    const float* GetLife() const { return life.data(); }
+    const float* GetStartLife() const { return startLife.data(); }
+    const float* GetSize() const { return size.data(); }
+
+private:
+    // Advances particles [begin, end); returns the first one there to recycle,
+    // or end when none expired.
+    int Integrate(const ParticleForces& forces, float dt, int begin, int end);
+    void Recycle(const ParticleForces& forces, int first);
+
+    std::vector<float> x{};
+    std::vector<float> y{};
+    std::vector<float> velocityX{};
+    std::vector<float> velocityY{};
+    std::vector<float> life{};
+    std::vector<float> startLife{};
+    std::vector<float> size{};
+    int count{0};
+    Random rng{};
+};
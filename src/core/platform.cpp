@@ -0,0 +1,103 @@
+#include "platform.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "entity_store.h"
+#include "job_system.h"
+#include "spatial_grid.h"
+
+namespace
+{
+    constexpr std::size_t MOVER_JOB_GRAIN = 4096;
+}
+
+float AdvanceMoverTimer(float timer, int ticks, float step, float travelTime)
+{
+    // In double and from the anchor each time, so a timer brought up to date
+    // after skipping ticks reads exactly what stepping every tick would.
+    const double period = 2.0 * static_cast<double>(travelTime);
+    const double elapsed = static_cast<double>(timer) + static_cast<double>(ticks) * static_cast<double>(step);
+    return static_cast<float>(elapsed - period * std::floor(elapsed / period));
+}
+
+Vector2 GetMoverPosition(Vector2 start, Vector2 end, float travelTime, float timer)
+{
+    const float phase = 1.0f - std::fabs(1.0f - timer / travelTime);
+    return {start.x + (end.x - start.x) * phase, start.y + (end.y - start.y) * phase};
+}
+
+void UpdatePlatforms(PlatformStore& platforms, SpatialGrid& grid, float dt, const LodFocus& focus)
+{
+    platforms.Advance(dt);
+    const int clock = platforms.clock;
+
+    platforms.lod = LodCounts{};
+    platforms.moverDue.clear();
+    for (std::size_t i = 0; i < platforms.MoverCount(); ++i)
+    {
+        const LodTier tier = GetLodTier(focus, platforms.moverLeft[i], platforms.moverRight[i]);
+        if (IsLodDue(tier, clock, i, platforms.lod))
+        {
+            platforms.moverDue.push_back(static_cast<int>(i));
+        }
+    }
+
+    const int* due = platforms.moverDue.data();
+    const float* startX = platforms.moverStartX.data();
+    const float* startY = platforms.moverStartY.data();
+    const float* endX = platforms.moverEndX.data();
+    const float* endY = platforms.moverEndY.data();
+    const float* travelTime = platforms.moverTravelTime.data();
+    const float* anchorTimer = platforms.moverAnchorTimer.data();
+    const int* anchorTick = platforms.moverAnchorTick.data();
+    int* updatedTick = platforms.moverUpdatedTick.data();
+    float* positionX = platforms.moverX.data();
+    float* positionY = platforms.moverY.data();
+    float* previousX = platforms.moverPreviousX.data();
+    float* previousY = platforms.moverPreviousY.data();
+
+    // Rows are independent, so large sets split across workers chunk by chunk.
+    ParallelFor(platforms.moverDue.size(), MOVER_JOB_GRAIN, [=](std::size_t begin, std::size_t end)
+    {
+        for (std::size_t k = begin; k < end; ++k)
+        {
+            const std::size_t i = static_cast<std::size_t>(due[k]);
+            const Vector2 start{startX[i], startY[i]};
+            const Vector2 finish{endX[i], endY[i]};
+            const int ticks = clock - anchorTick[i];
+            if (updatedTick[i] == clock - 1)
+            {
+                previousX[i] = positionX[i];
+                previousY[i] = positionY[i];
+            }
+            else
+            {
+                const float timer = AdvanceMoverTimer(anchorTimer[i], ticks - 1, dt, travelTime[i]);
+                const Vector2 previous = GetMoverPosition(start, finish, travelTime[i], timer);
+                previousX[i] = previous.x;
+                previousY[i] = previous.y;
+            }
+
+            const float timer = AdvanceMoverTimer(anchorTimer[i], ticks, dt, travelTime[i]);
+            const Vector2 position = GetMoverPosition(start, finish, travelTime[i], timer);
+            positionX[i] = position.x;
+            positionY[i] = position.y;
+            updatedTick[i] = clock;
+        }
+    });
+
+    // The grid is shared, so its maintenance stays on one thread. Movers that
+    // were not due keep their cells, which are out of reach of the focus.
+    float maxStep = 0.0f;
+    for (const int row : platforms.moverDue)
+    {
+        const std::size_t i = static_cast<std::size_t>(row);
+        const std::size_t index = static_cast<std::size_t>(platforms.moverPlatform[i]);
+        platforms.x[index] = platforms.moverX[i];
+        platforms.y[index] = platforms.moverY[i];
+        grid.Update(static_cast<int>(index), platforms.GetBounds(index));
+        maxStep = std::max({maxStep, std::fabs(platforms.moverX[i] - platforms.moverPreviousX[i]), std::fabs(platforms.moverY[i] - platforms.moverPreviousY[i])});
+    }
+    platforms.maxMoverStep = maxStep;
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <vector>
+
+#include "raylib.h"
+
+#include "lod.h"
+
+class SpatialGrid;
+struct PlatformStore;
+
+struct Platform
+{
+    Rectangle bounds{};
+    Vector2 startPosition{};
+    Vector2 endPosition{};
+    float travelTime{0.0f};
+    float timer{0.0f};
+    bool moving{false};
+    // Ticks since `timer` was read. The platform is wherever the pair puts
+    // it, so it can skip ticks without drifting.
+    int age{0};
+};
+
+// A moving platform ping-pongs between its start and end positions, taking
+// travelTime seconds each way. Its timer wraps every round trip.
+void UpdatePlatforms(PlatformStore& platforms, SpatialGrid& grid, float dt, const LodFocus& focus = LodFocus{});
+
+// Timer `ticks` steps of `step` after it read `timer`, wrapped to the round trip.
+float AdvanceMoverTimer(float timer, int ticks, float step, float travelTime);
+Vector2 GetMoverPosition(Vector2 start, Vector2 end, float travelTime, float timer);
+
+
@@ -0,0 +1,173 @@
+#include "player.h"
+
+#include <algorithm>
+
+#include "collision.h"
+#include "entity_store.h"
+#include "input_state.h"
+#include "profiler.h"
+#include "spatial_grid.h"
+
+namespace
+{
+    // Contacts resolved per step; landing and then running into a wall takes
+    // two, a corner three.
+    constexpr int MAX_SWEEP_PASSES = 4;
+}
+
+Rectangle GetPlayerBounds(const Player& player)
+{
+    return {player.position.x, player.position.y, player.width, player.height};
+}
+
+Vector2 GetPlayerCentre(const Player& player)
+{
+    return {player.position.x + player.width * 0.5f, player.position.y + player.height * 0.5f};
+}
+
+Vector2 GetInterpolatedPlayerPosition(const Player& player, float alpha)
+{
+    return {player.previousPosition.x + (player.position.x - player.previousPosition.x) * alpha,
+            player.previousPosition.y + (player.position.y - player.previousPosition.y) * alpha};
+}
+
+void ResetPlayer(Player& player, Vector2 spawnPosition)
+{
+    player.position = spawnPosition;
+    player.previousPosition = spawnPosition;
+    player.velocity = {0.0f, 0.0f};
+    player.grounded = false;
+    player.invincibilityTimer = 0.0f;
+    player.comboCount = 0;
+    player.comboTimer = 0.0f;
+}
+
+void ApplyPlayerInput(Player& player, const InputState& input, float)
+{
+    if (input.moveLeft || input.moveRight)
+    {
+        player.velocity.x = 0.0f;
+        if (input.moveLeft)
+        {
+            player.velocity.x -= player.speed;
+        }
+
+        if (input.moveRight)
+        {
+            player.velocity.x += player.speed;
+        }
+    }
+    else
+    {
+        const float damping = player.grounded ? 0.85f : 0.95f;
+        player.velocity.x *= damping;
+    }
+
+    if (player.grounded && input.jumpPressed)
+    {
+        player.velocity.y = -player.jumpStrength;
+        player.grounded = false;
+    }
+}
+
+void UpdatePlayerPhysics(Player& player, float gravity, float dt, Vector2 externalForce)
+{
+    player.previousPosition = player.position;
+    player.velocity.x += externalForce.x * dt;
+    player.velocity.y += externalForce.y * dt;
+    player.velocity.y += gravity * dt;
+    player.position.x += player.velocity.x * dt;
+    player.position.y += player.velocity.y * dt;
+    player.invincibilityTimer = std::max(0.0f, player.invincibilityTimer - dt);
+    player.comboTimer = std::max(0.0f, player.comboTimer - dt);
+}
+
+void ResolvePlayerPlatforms(Player& player, const PlatformStore& platforms, const SpatialGrid& grid)
+{
+    SKYBOUND_PROFILE_SCOPE("ResolvePlayerPlatforms");
+
+    // The step is replayed from the previous position: the player stops at
+    // the first contact, drops the blocked part of the motion and carries on
+    // along the surface. Platforms are swept along their own step too, so
+    // neither a long step nor a fast platform can pass through.
+    player.grounded = false;
+    Vector2 position = player.previousPosition;
+    Vector2 motion{player.position.x - position.x, player.position.y - position.y};
+    float elapsed = 0.0f;
+
+    // Every pass moves the player along `motion` or with a platform, so this
+    // covers all of them.
+    const Rectangle start{position.x, position.y, player.width, player.height};
+    const std::vector<int>& candidates = grid.Query(GetSweptBounds(start, motion, platforms.maxMoverStep));
+
+    for (int pass = 0; pass < MAX_SWEEP_PASSES; ++pass)
+    {
+        const float remaining = 1.0f - elapsed;
+        const Rectangle bounds{position.x, position.y, player.width, player.height};
+        SweepHit first{};
+        int firstIndex = -1;
+        Vector2 firstStep{};
+        for (const int index : candidates)
+        {
+            // Where the platform stood at `elapsed`, and how it moves relative
+            // to the player from there.
+            const Vector2 step = platforms.GetStep(static_cast<std::size_t>(index));
+            Rectangle target = platforms.GetBounds(static_cast<std::size_t>(index));
+            target.x -= step.x * remaining;
+            target.y -= step.y * remaining;
+            const Vector2 relative{(motion.x - step.x) * remaining, (motion.y - step.y) * remaining};
+
+            SweepHit hit{};
+            if (SweepBox(bounds, relative, target, hit) && (firstIndex < 0 || hit.time < first.time))
+            {
+                first = hit;
+                firstIndex = index;
+                firstStep = step;
+            }
+        }
+
+        if (firstIndex < 0)
+        {
+            position.x += motion.x * remaining;
+            position.y += motion.y * remaining;
+            break;
+        }
+
+        elapsed += remaining * first.time;
+        const float left = 1.0f - elapsed;
+        const Rectangle surface = platforms.GetBounds(static_cast<std::size_t>(firstIndex));
+        const float surfaceX = surface.x - firstStep.x * left;
+        const float surfaceY = surface.y - firstStep.y * left;
+        position.x += motion.x * remaining * first.time;
+        position.y += motion.y * remaining * first.time;
+
+        // Snapping onto the face keeps rounding from building up tick to tick.
+        if (first.normal.y < 0.0f)
+        {
+            position.y = surfaceY - player.height;
+            motion.y = firstStep.y;
+            player.velocity.y = 0.0f;
+            player.grounded = true;
+        }
+        else if (first.normal.y > 0.0f)
+        {
+            position.y = surfaceY + surface.height;
+            motion.y = firstStep.y;
+            player.velocity.y = 0.0f;
+        }
+        else if (first.normal.x < 0.0f)
+        {
+            position.x = surfaceX - player.width;
+            motion.x = firstStep.x;
+            player.velocity.x = 0.0f;
+        }
+        else
+        {
+            position.x = surfaceX + surface.width;
+            motion.x = firstStep.x;
+            player.velocity.x = 0.0f;
+        }
+    }
+
+    player.position = position;
+}
@@ -4,8 +4,9 @@
 
 #include "raylib.h"
 
-struct Platform;
+struct PlatformStore;
 struct InputState;
+class SpatialGrid;
 
 struct Player
 {
@@ -28,8 +29,11 @@ struct Player
 };
 
 Rectangle GetPlayerBounds(const Player& player);
+Vector2 GetPlayerCentre(const Player& player);
+// Position blended from the start of the latest physics step; alpha 1 is current.
+Vector2 GetInterpolatedPlayerPosition(const Player& player, float alpha);
 void ResetPlayer(Player& player, Vector2 spawnPosition);
 void ApplyPlayerInput(Player& player, const InputState& input, float dt);
 void UpdatePlayerPhysics(Player& player, float gravity, float dt, Vector2 externalForce);
-void ResolvePlayerPlatforms(Player& player, const std::vector<Platform>& platforms);
+void ResolvePlayerPlatforms(Player& player, const PlatformStore& platforms, const SpatialGrid& grid);
 
@@ -0,0 +1,306 @@
+#include "profiler.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace
+{
+    constexpr std::size_t TRACE_FLUSH_BYTES = 64 * 1024;
+}
+
+FrameProfiler& FrameProfiler::Get()
+{
+    static FrameProfiler profiler;
+    return profiler;
+}
+
+FrameProfiler::FrameProfiler()
+{
+    epoch = Clock::now();
+    frameStart = epoch;
+}
+
+FrameProfiler::~FrameProfiler()
+{
+    StopTrace();
+}
+
+FrameProfiler::ThreadProfile& FrameProfiler::GetThreadProfile()
+{
+    thread_local ThreadProfile* current = nullptr;
+    if (current != nullptr)
+    {
+        return *current;
+    }
+
+    auto profile = std::make_unique<ThreadProfile>();
+    ProfileNode root{};
+    root.name = "Frame";
+    profile->nodes.push_back(root);
+    profile->stack.reserve(32);
+    profile->starts.reserve(32);
+
+    const std::lock_guard<std::mutex> lock(threadsMutex);
+    profile->traceId = static_cast<int>(threads.size()) + 1;
+    profile->ownsFrame = std::this_thread::get_id() == owner;
+    if (profile->ownsFrame)
+    {
+        profile->name = "Main";
+    }
+    else
+    {
+        profile->name = "Thread " + std::to_string(profile->traceId);
+    }
+    if (IsTracing())
+    {
+        AppendThreadName(profile->traceEvents, *profile);
+    }
+    current = profile.get();
+    threads.push_back(std::move(profile));
+    return *current;
+}
+
+void FrameProfiler::SetThreadName(const char* name)
+{
+    ThreadProfile& thread = GetThreadProfile();
+    const std::lock_guard<std::mutex> lock(thread.mutex);
+    thread.name = name;
+    if (IsTracing())
+    {
+        AppendThreadName(thread.traceEvents, thread);
+    }
+}
+
+void FrameProfiler::BeginScope(const char* name)
+{
+    ThreadProfile& thread = GetThreadProfile();
+    const int parent = thread.stack.empty() ? 0 : thread.stack.back();
+    {
+        const std::lock_guard<std::mutex> lock(thread.mutex);
+        thread.stack.push_back(FindOrAddChild(thread.nodes, parent, name));
+    }
+    thread.starts.push_back(Clock::now());
+}
+
+void FrameProfiler::EndScope()
+{
+    ThreadProfile& thread = GetThreadProfile();
+    if (thread.stack.empty())
+    {
+        return;
+    }
+
+    const Clock::time_point end = Clock::now();
+    const Clock::time_point start = thread.starts.back();
+    {
+        const std::lock_guard<std::mutex> lock(thread.mutex);
+        ProfileNode& node = thread.nodes[static_cast<std::size_t>(thread.stack.back())];
+        node.frameNanoseconds += std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+        node.frameCalls += 1;
+
+        if (IsTracing())
+        {
+            AppendTraceEvent(thread.traceEvents, thread.traceId, node.name, start, end);
+        }
+    }
+
+    thread.stack.pop_back();
+    thread.starts.pop_back();
+}
+
+void FrameProfiler::EndFrame()
+{
+    GetThreadProfile();
+
+    const Clock::time_point now = Clock::now();
+    historyCount = std::min(historyCount + 1, PROFILER_HISTORY_FRAMES);
+
+    const std::lock_guard<std::mutex> threadsLock(threadsMutex);
+    for (const std::unique_ptr<ThreadProfile>& thread : threads)
+    {
+        const std::lock_guard<std::mutex> lock(thread->mutex);
+        std::vector<ProfileNode>& nodes = thread->nodes;
+        ProfileNode& root = nodes.front();
+        if (thread->ownsFrame)
+        {
+            root.frameNanoseconds = std::chrono::duration_cast<std::chrono::nanoseconds>(now - frameStart).count();
+            if (IsTracing())
+            {
+                AppendTraceEvent(thread->traceEvents, thread->traceId, root.name, frameStart, now);
+            }
+        }
+        else
+        {
+            // Other threads have no frame of their own; theirs is the time
+            // they spent in scopes.
+            root.frameNanoseconds = 0;
+            for (int child = root.firstChild; child >= 0; child = nodes[static_cast<std::size_t>(child)].nextSibling)
+            {
+                root.frameNanoseconds += nodes[static_cast<std::size_t>(child)].frameNanoseconds;
+            }
+        }
+        root.frameCalls = 1;
+
+        for (ProfileNode& node : nodes)
+        {
+            node.historyMs[static_cast<std::size_t>(historyIndex)] = static_cast<float>(node.frameNanoseconds) * 1.0e-6f;
+            node.lastCalls = node.frameCalls;
+            node.frameNanoseconds = 0;
+            node.frameCalls = 0;
+
+            float total = 0.0f;
+            float peak = 0.0f;
+            for (int i = 0; i < historyCount; ++i)
+            {
+                total += node.historyMs[static_cast<std::size_t>(i)];
+                peak = std::max(peak, node.historyMs[static_cast<std::size_t>(i)]);
+            }
+            node.averageMs = total / static_cast<float>(historyCount);
+            node.peakMs = peak;
+        }
+
+        if (traceFile != nullptr)
+        {
+            traceBuffer += thread->traceEvents;
+        }
+        thread->traceEvents.clear();
+    }
+    frameStart = now;
+    historyIndex = (historyIndex + 1) % PROFILER_HISTORY_FRAMES;
+
+    if (traceFile != nullptr && traceBuffer.size() >= TRACE_FLUSH_BYTES)
+    {
+        std::fwrite(traceBuffer.data(), 1, traceBuffer.size(), traceFile);
+        traceBuffer.clear();
+    }
+}
+
+void FrameProfiler::GetThreads(std::vector<ProfileThreadSnapshot>& out)
+{
+    const std::lock_guard<std::mutex> threadsLock(threadsMutex);
+    out.resize(threads.size());
+    for (std::size_t i = 0; i < threads.size(); ++i)
+    {
+        const std::lock_guard<std::mutex> lock(threads[i]->mutex);
+        out[i].name = threads[i]->name;
+        out[i].nodes = threads[i]->nodes;
+    }
+}
+
+bool FrameProfiler::StartTrace(const std::string& path)
+{
+    StopTrace();
+
+    traceFile = std::fopen(path.c_str(), "wb");
+    if (traceFile == nullptr)
+    {
+        return false;
+    }
+
+    traceBuffer.clear();
+    traceBuffer.reserve(TRACE_FLUSH_BYTES * 2);
+    // Every event after this one starts with its separator, so events from
+    // different threads can be spliced together in any order.
+    traceBuffer += "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n"
+                   "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"args\":{\"name\":\"SkyBound\"}}";
+
+    const std::lock_guard<std::mutex> threadsLock(threadsMutex);
+    for (const std::unique_ptr<ThreadProfile>& thread : threads)
+    {
+        const std::lock_guard<std::mutex> lock(thread->mutex);
+        thread->traceEvents.clear();
+        AppendThreadName(thread->traceEvents, *thread);
+    }
+    tracing.store(true, std::memory_order_relaxed);
+    return true;
+}
+
+void FrameProfiler::StopTrace()
+{
+    if (traceFile == nullptr)
+    {
+        return;
+    }
+
+    tracing.store(false, std::memory_order_relaxed);
+    {
+        const std::lock_guard<std::mutex> threadsLock(threadsMutex);
+        for (const std::unique_ptr<ThreadProfile>& thread : threads)
+        {
+            const std::lock_guard<std::mutex> lock(thread->mutex);
+            traceBuffer += thread->traceEvents;
+            thread->traceEvents.clear();
+        }
+    }
+    traceBuffer += "\n]}\n";
+    std::fwrite(traceBuffer.data(), 1, traceBuffer.size(), traceFile);
+    std::fclose(traceFile);
+    traceFile = nullptr;
+    traceBuffer.clear();
+}
+
+int FrameProfiler::FindOrAddChild(std::vector<ProfileNode>& nodes, int parent, const char* name)
+{
+    int last = -1;
+    for (int child = nodes[static_cast<std::size_t>(parent)].firstChild; child >= 0;
+         child = nodes[static_cast<std::size_t>(child)].nextSibling)
+    {
+        // Identical literals in different translation units need not share an address.
+        const char* childName = nodes[static_cast<std::size_t>(child)].name;
+        if (childName == name || std::strcmp(childName, name) == 0)
+        {
+            return child;
+        }
+        last = child;
+    }
+
+    ProfileNode node{};
+    node.name = name;
+    node.parent = parent;
+    node.depth = nodes[static_cast<std::size_t>(parent)].depth + 1;
+
+    const int index = static_cast<int>(nodes.size());
+    nodes.push_back(node);
+    if (last < 0)
+    {
+        nodes[static_cast<std::size_t>(parent)].firstChild = index;
+    }
+    else
+    {
+        nodes[static_cast<std::size_t>(last)].nextSibling = index;
+    }
+    return index;
+}
+
+void FrameProfiler::AppendTraceEvent(std::string& out, int traceId, const char* name, Clock::time_point start, Clock::time_point end) const
+{
+    const double startUs = std::chrono::duration<double, std::micro>(start - epoch).count();
+    const double durationUs = std::chrono::duration<double, std::micro>(end - start).count();
+
+    char event[256];
+    const int length = std::snprintf(event,
+                                     sizeof(event),
+                                     ",\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}",
+                                     name,
+                                     traceId,
+                                     startUs,
+                                     durationUs);
+    if (length > 0)
+    {
+        out.append(event, std::min(static_cast<std::size_t>(length), sizeof(event) - 1));
+    }
+}
+
+void FrameProfiler::AppendThreadName(std::string& out, const ThreadProfile& thread)
+{
+    char event[160];
+    const int length = std::snprintf(event,
+                                     sizeof(event),
+                                     ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"%s\"}}",
+                                     thread.traceId,
+                                     thread.name.c_str());
+    if (length > 0)
+    {
+        out.append(event, std::min(static_cast<std::size_t>(length), sizeof(event) - 1));
+    }
+}
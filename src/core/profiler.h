@@ -0,0 +1,133 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Hierarchical scoped timers. SKYBOUND_PROFILE_SCOPE compiles to nothing unless
+// SKYBOUND_PROFILER_ENABLED is set, which CMake does outside Release builds.
+#ifndef SKYBOUND_PROFILER_ENABLED
+#define SKYBOUND_PROFILER_ENABLED 0
+#endif
+
+constexpr int PROFILER_HISTORY_FRAMES = 120;
+
+struct ProfileNode
+{
+    const char* name{nullptr};
+    int parent{-1};
+    int depth{0};
+    int firstChild{-1};
+    int nextSibling{-1};
+    std::int64_t frameNanoseconds{0};
+    int frameCalls{0};
+    std::array<float, PROFILER_HISTORY_FRAMES> historyMs{};
+    float averageMs{0.0f};
+    float peakMs{0.0f};
+    int lastCalls{0};
+};
+
+// One thread's scope tree as of the latest EndFrame.
+struct ProfileThreadSnapshot
+{
+    std::string name{};
+    std::vector<ProfileNode> nodes{};
+};
+
+// Every thread that opens a scope gets a tree of its own. Node 0 of the
+// thread that first used the profiler (the main thread) is the whole frame,
+// measured between EndFrame calls; on other threads it is the sum of their
+// top-level scopes. EndFrame, on the main thread, closes the frame for all
+// of them, so the simulation thread and job workers are timed per rendered
+// frame.
+class FrameProfiler
+{
+public:
+    static FrameProfiler& Get();
+
+    void BeginScope(const char* name);
+    void EndScope();
+    // Closes the current frame: folds each thread's time into its rolling
+    // window and flushes buffered trace events. Main thread only.
+    void EndFrame();
+    // Names the calling thread in the overlay and trace.
+    void SetThreadName(const char* name);
+
+    // Streams every scope from now on as a Chrome/Perfetto trace event, one
+    // track per thread.
+    bool StartTrace(const std::string& path);
+    void StopTrace();
+    bool IsTracing() const { return tracing.load(std::memory_order_relaxed); }
+
+    // Main thread only; reuses the vectors already in `threads`.
+    void GetThreads(std::vector<ProfileThreadSnapshot>& threads);
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct ThreadProfile
+    {
+        std::string name{};
+        int traceId{0};
+        bool ownsFrame{false};
+        // Guards nodes and traceEvents, which EndFrame reads from the main thread.
+        std::mutex mutex{};
+        std::vector<ProfileNode> nodes{};
+        std::string traceEvents{};
+        // Only ever touched by the owning thread.
+        std::vector<int> stack{};
+        std::vector<Clock::time_point> starts{};
+    };
+
+    FrameProfiler();
+    ~FrameProfiler();
+
+    ThreadProfile& GetThreadProfile();
+    static int FindOrAddChild(std::vector<ProfileNode>& nodes, int parent, const char* name);
+    void AppendTraceEvent(std::string& out, int traceId, const char* name, Clock::time_point start, Clock::time_point end) const;
+    static void AppendThreadName(std::string& out, const ThreadProfile& thread);
+
+    std::thread::id owner{std::this_thread::get_id()};
+    // Guards the list itself; profiles live until the profiler does.
+    std::mutex threadsMutex{};
+    std::vector<std::unique_ptr<ThreadProfile>> threads{};
+    Clock::time_point frameStart{};
+    Clock::time_point epoch{};
+    int historyIndex{0};
+    int historyCount{0};
+    std::atomic<bool> tracing{false};
+    std::FILE* traceFile{nullptr};
+    std::string traceBuffer{};
+};
+
+class ProfileScope
+{
+public:
+    explicit ProfileScope(const char* name)
+    {
+        FrameProfiler::Get().BeginScope(name);
+    }
+
+    ~ProfileScope()
+    {
+        FrameProfiler::Get().EndScope();
+    }
+
+    ProfileScope(const ProfileScope&) = delete;
+    ProfileScope& operator=(const ProfileScope&) = delete;
+};
+
+#if SKYBOUND_PROFILER_ENABLED
+#define SKYBOUND_PROFILE_JOIN_INNER(a, b) a##b
+#define SKYBOUND_PROFILE_JOIN(a, b) SKYBOUND_PROFILE_JOIN_INNER(a, b)
+#define SKYBOUND_PROFILE_SCOPE(name) const ProfileScope SKYBOUND_PROFILE_JOIN(profileScope, __LINE__)(name)
+#else
+#define SKYBOUND_PROFILE_SCOPE(name) static_cast<void>(0)
+#endif
@@ -0,0 +1,48 @@
+#include "random.h"
+
+#include <utility>
+
+Random::Random(std::uint32_t seed)
+{
+    Seed(seed);
+}
+
+void Random::Seed(std::uint32_t newSeed)
+{
+    seed = newSeed;
+
+    // splitmix64 scramble so nearby seeds do not produce correlated streams
+    std::uint64_t z = static_cast<std::uint64_t>(newSeed) + 0x9E3779B97F4A7C15ull;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    state = z ^ (z >> 31);
+    if (state == 0)
+    {
+        state = 0x9E3779B97F4A7C15ull;
+    }
+}
+
+std::uint32_t Random::NextU32()
+{
+    state ^= state >> 12;
+    state ^= state << 25;
+    state ^= state >> 27;
+    return static_cast<std::uint32_t>((state * 0x2545F4914F6CDD1Dull) >> 32);
+}
+
+int Random::Range(int min, int max)
+{
+    if (min > max)
+    {
+        std::swap(min, max);
+    }
+
+    const std::uint64_t span = static_cast<std::uint64_t>(static_cast<std::int64_t>(max) - min) + 1u;
+    return static_cast<int>(min + static_cast<std::int64_t>((static_cast<std::uint64_t>(NextU32()) * span) >> 32));
+}
+
+float Random::Uniform(float min, float max)
+{
+    const float unit = static_cast<float>(NextU32() >> 8) * (1.0f / 16777216.0f);
+    return min + (max - min) * unit;
+}
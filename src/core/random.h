@@ -0,0 +1,29 @@
+#pragma once
+
+#include <cstdint>
+
+// Seedable xorshift generator used by the simulation instead of raylib's global
+// GetRandomValue, so runs can be reproduced from a single seed.
+class Random
+{
+public:
+    static constexpr std::uint32_t DEFAULT_SEED = 0x5EEDB0D5u;
+
+    explicit Random(std::uint32_t seed = DEFAULT_SEED);
+
+    void Seed(std::uint32_t seed);
+    std::uint32_t GetSeed() const { return seed; }
+    // The generator's position, for saving and restoring simulation state.
+    std::uint64_t GetState() const { return state; }
+    void SetState(std::uint64_t newState) { state = newState; }
+
+    std::uint32_t NextU32();
+    int Range(int min, int max);
+
+    // Uniform in [min, max) from the top 24 bits; no division or modulo.
+    float Uniform(float min, float max);
+
+private:
+    std::uint32_t seed{DEFAULT_SEED};
+    std::uint64_t state{0};
+};
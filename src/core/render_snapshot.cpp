@@ -0,0 +1,99 @@
+#include "render_snapshot.h"
+
+#include <algorithm>
+
+#include "geometry.h"
+
+void CaptureParticles(const ParticleSystem& particles, ParticleSnapshot& snapshot)
+{
+    const std::size_t count = static_cast<std::size_t>(particles.GetCount());
+    snapshot.x.assign(particles.GetX(), particles.GetX() + count);
+    snapshot.y.assign(particles.GetY(), particles.GetY() + count);
+    snapshot.size.assign(particles.GetSize(), particles.GetSize() + count);
+
+    snapshot.fade.resize(count);
+    const float* life = particles.GetLife();
+    const float* startLife = particles.GetStartLife();
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        snapshot.fade[i] = std::clamp(life[i] / startLife[i], 0.0f, 1.0f);
+    }
+}
+
+void CaptureRenderSnapshot(const Simulation& simulation, std::uint64_t tick, const Rectangle& area, RenderSnapshot& snapshot)
+{
+    snapshot.tick = tick;
+    snapshot.state = simulation.GetState();
+    snapshot.player = simulation.GetPlayer();
+    snapshot.level = simulation.GetLevel();
+    snapshot.levelSerial = simulation.GetLevelSerial();
+    snapshot.timeTrialMode = simulation.IsTimeTrialMode();
+    snapshot.timeTrialActive = simulation.IsTimeTrialActive();
+    snapshot.timeTrialTimer = simulation.GetTimeTrialTimer();
+    snapshot.bestTimeTrial = simulation.GetBestTimeTrial();
+    snapshot.achievements = simulation.GetAchievements();
+    snapshot.rewinding = simulation.IsRewinding();
+    snapshot.rewindFrames = simulation.GetRewindBuffer().GetFrameCount();
+
+    const WeatherState& weather = simulation.GetWeather();
+    snapshot.weather.current = weather.current;
+    snapshot.weather.rainIntensity = weather.rainIntensity;
+    snapshot.weather.windCurrent = weather.windCurrent;
+    snapshot.weather.lightningFlashTimer = weather.lightningFlashTimer;
+    CaptureParticles(weather.rain, snapshot.weather.rain);
+
+    if (snapshot.staticGeometry != simulation.GetStaticGeometry())
+    {
+        snapshot.staticGeometry = simulation.GetStaticGeometry();
+    }
+
+    // Interpolated bounds trail the latest tick, so test those against the area.
+    const PlatformStore& platforms = simulation.GetPlatforms();
+    snapshot.platforms.clear();
+    for (const int index : simulation.GetPlatformGrid().Query(area))
+    {
+        const std::size_t platform = static_cast<std::size_t>(index);
+        if (!platforms.IsMoving(platform))
+        {
+            continue;
+        }
+
+        const Rectangle previous = platforms.GetInterpolatedBounds(platform, 0.0f);
+        if (RectsOverlap(platforms.GetBounds(platform), area) || RectsOverlap(previous, area))
+        {
+            snapshot.platforms.push_back({platforms.GetBounds(platform), {previous.x, previous.y}});
+        }
+    }
+
+    const EnemyStore& enemies = simulation.GetEnemies();
+    snapshot.enemies.clear();
+    for (const int index : simulation.GetEnemyGrid().Query(area))
+    {
+        const std::size_t enemy = static_cast<std::size_t>(index);
+        const Rectangle previous = enemies.GetInterpolatedBounds(enemy, 0.0f);
+        if (RectsOverlap(enemies.GetBounds(enemy), area) || RectsOverlap(previous, area))
+        {
+            snapshot.enemies.push_back({enemies.GetBounds(enemy), {previous.x, previous.y}});
+        }
+    }
+
+    const std::vector<Coin>& coins = simulation.GetCoins();
+    snapshot.coins.clear();
+    for (const int index : simulation.GetCoinGrid().Query(area))
+    {
+        const Coin& coin = coins[static_cast<std::size_t>(index)];
+        if (!coin.collected && RectsOverlap(GetCoinBounds(coin), area))
+        {
+            snapshot.coins.push_back({coin.position, coin.radius});
+        }
+    }
+
+    snapshot.broadphaseEntities = static_cast<int>(platforms.MoverCount()) +
+                                  simulation.GetEnemyGrid().GetEntityCount() +
+                                  simulation.GetCoinGrid().GetEntityCount();
+
+    const EffectState& effects = simulation.GetEffects();
+    CaptureParticles(effects.dust, snapshot.dust);
+    CaptureParticles(effects.sparkle, snapshot.sparkle);
+    CaptureParticles(effects.hit, snapshot.hit);
+}
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "raylib.h"
+
+#include "particles.h"
+#include "player.h"
+#include "simulation.h"
+#include "weather.h"
+
+// Live particles only, with the fade over their lifetime already applied.
+struct ParticleSnapshot
+{
+    std::vector<float> x{};
+    std::vector<float> y{};
+    std::vector<float> size{};
+    std::vector<float> fade{};
+
+    int GetCount() const { return static_cast<int>(x.size()); }
+};
+
+// The weather fields the HUD and the rain overlay draw from.
+struct WeatherSnapshot
+{
+    WeatherType current{WeatherType::Clear};
+    float rainIntensity{0.0f};
+    float windCurrent{0.0f};
+    float lightningFlashTimer{0.0f};
+    ParticleSnapshot rain{};
+};
+
+// Bounds on the latest tick plus the top-left corner one tick earlier.
+struct SnapshotRect
+{
+    Rectangle bounds{};
+    Vector2 previous{};
+
+    Rectangle Interpolate(float alpha) const
+    {
+        return {previous.x + (bounds.x - previous.x) * alpha,
+                previous.y + (bounds.y - previous.y) * alpha,
+                bounds.width,
+                bounds.height};
+    }
+};
+
+struct SnapshotCoin
+{
+    Vector2 position{};
+    float radius{0.0f};
+};
+
+// Everything drawing needs from one simulation tick, copied out so the renderer
+// never touches a Simulation that may be mid-update on another thread. Entities
+// are only captured around the requested area; the vectors keep their capacity
+// between captures, so refilling a snapshot stops allocating once warmed up.
+struct RenderSnapshot
+{
+    // Ticks simulated so far, and the timing of the ones behind this snapshot;
+    // the last group is filled in by whoever drives the simulation.
+    std::uint64_t tick{0};
+    float tickStep{0.0f};
+    // Accumulated time towards the next tick, as a fraction of a step.
+    float tickProgress{0.0f};
+    double captureSeconds{0.0};
+    int substeps{0};
+    float dilatedSeconds{0.0f};
+
+    GameState state{GameState::Menu};
+    Player player{};
+    int level{1};
+    std::uint32_t levelSerial{0};
+    bool timeTrialMode{false};
+    bool timeTrialActive{false};
+    float timeTrialTimer{0.0f};
+    float bestTimeTrial{-1.0f};
+    AchievementState achievements{};
+    WeatherSnapshot weather{};
+    bool rewinding{false};
+    // Ticks of history left to rewind through.
+    int rewindFrames{0};
+
+    // The level's fixed platforms, shared rather than copied; `platforms` below
+    // holds only the moving ones.
+    std::shared_ptr<const StaticGeometry> staticGeometry{};
+    std::vector<SnapshotRect> platforms{};
+    std::vector<SnapshotRect> enemies{};
+    std::vector<SnapshotCoin> coins{};
+    // Live-drawn entities the broadphase holds in total, captured or not, for
+    // culling stats.
+    int broadphaseEntities{0};
+
+    ParticleSnapshot dust{};
+    ParticleSnapshot sparkle{};
+    ParticleSnapshot hit{};
+};
+
+void CaptureParticles(const ParticleSystem& particles, ParticleSnapshot& snapshot);
+void CaptureRenderSnapshot(const Simulation& simulation, std::uint64_t tick, const Rectangle& area, RenderSnapshot& snapshot);
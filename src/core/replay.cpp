@@ -0,0 +1,178 @@
+#include "replay.h"
+
+#include <cstdio>
+#include <cstring>
+
+#include "mapped_file.h"
+
+namespace
+{
+    // Bit order is part of the file format; append new buttons at the end.
+    bool InputState::* const REPLAY_BUTTONS[] = {
+        &InputState::moveLeft,
+        &InputState::moveRight,
+        &InputState::jumpPressed,
+        &InputState::confirmPressed,
+        &InputState::pausePressed,
+        &InputState::restartPressed,
+        &InputState::openSettings,
+        &InputState::toggleHighContrast,
+        &InputState::toggleLargeHud,
+        &InputState::toggleTimeTrial,
+        &InputState::cycleBindings,
+        &InputState::toggleProfiler,
+        &InputState::rewindHeld,
+    };
+}
+
+std::uint32_t PackInputState(const InputState& input)
+{
+    std::uint32_t buttons = 0;
+    std::uint32_t bit = 1;
+    for (bool InputState::* const button : REPLAY_BUTTONS)
+    {
+        buttons |= input.*button ? bit : 0u;
+        bit <<= 1;
+    }
+    return buttons;
+}
+
+InputState UnpackInputState(std::uint32_t buttons)
+{
+    InputState input{};
+    std::uint32_t bit = 1;
+    for (bool InputState::* const button : REPLAY_BUTTONS)
+    {
+        input.*button = (buttons & bit) != 0;
+        bit <<= 1;
+    }
+    return input;
+}
+
+void ReplayRecorder::Begin(std::uint32_t newSeed, float newStep)
+{
+    runs.clear();
+    seed = newSeed;
+    step = newStep;
+    tickCount = 0;
+    recording = true;
+}
+
+void ReplayRecorder::Record(const InputState& input)
+{
+    if (!recording)
+    {
+        return;
+    }
+
+    const std::uint32_t buttons = PackInputState(input);
+    if (!runs.empty() && runs.back().buttons == buttons)
+    {
+        runs.back().ticks += 1;
+    }
+    else
+    {
+        runs.push_back({buttons, 1});
+    }
+    tickCount += 1;
+}
+
+bool ReplayRecorder::Save(const std::string& path) const
+{
+    ReplayFileHeader header{};
+    header.magic = REPLAY_FILE_MAGIC;
+    header.version = REPLAY_FILE_VERSION;
+    header.endianTag = REPLAY_FILE_ENDIAN_TAG;
+    header.seed = seed;
+    header.step = step;
+    header.tickCount = tickCount;
+    header.runCount = static_cast<std::uint32_t>(runs.size());
+
+    std::FILE* file = std::fopen(path.c_str(), "wb");
+    if (file == nullptr)
+    {
+        return false;
+    }
+
+    bool ok = std::fwrite(&header, sizeof(header), 1, file) == 1;
+    if (ok && !runs.empty())
+    {
+        ok = std::fwrite(runs.data(), sizeof(ReplayRun), runs.size(), file) == runs.size();
+    }
+    return std::fclose(file) == 0 && ok;
+}
+
+bool ReplayPlayer::Load(const std::string& path)
+{
+    loaded = false;
+    runs.clear();
+
+    MappedFile file;
+    if (!file.Open(path) || file.GetSize() < sizeof(ReplayFileHeader))
+    {
+        return false;
+    }
+
+    ReplayFileHeader header{};
+    std::memcpy(&header, file.GetData(), sizeof(header));
+    if (header.magic != REPLAY_FILE_MAGIC || header.version != REPLAY_FILE_VERSION ||
+        header.endianTag != REPLAY_FILE_ENDIAN_TAG || !(header.step > 0.0f))
+    {
+        return false;
+    }
+
+    const std::size_t available = (file.GetSize() - sizeof(header)) / sizeof(ReplayRun);
+    if (header.runCount > available)
+    {
+        return false;
+    }
+
+    runs.resize(header.runCount);
+    if (!runs.empty())
+    {
+        std::memcpy(runs.data(), file.GetData() + sizeof(header), runs.size() * sizeof(ReplayRun));
+    }
+
+    std::uint64_t total = 0;
+    for (const ReplayRun& entry : runs)
+    {
+        total += entry.ticks;
+    }
+    if (total != header.tickCount)
+    {
+        runs.clear();
+        return false;
+    }
+
+    seed = header.seed;
+    step = header.step;
+    tickCount = header.tickCount;
+    loaded = true;
+    Rewind();
+    return true;
+}
+
+InputState ReplayPlayer::Next()
+{
+    if (IsFinished())
+    {
+        return {};
+    }
+
+    while (runTick >= runs[run].ticks)
+    {
+        run += 1;
+        runTick = 0;
+    }
+
+    runTick += 1;
+    tick += 1;
+    return UnpackInputState(runs[run].buttons);
+}
+
+void ReplayPlayer::Rewind()
+{
+    tick = 0;
+    run = 0;
+    runTick = 0;
+}
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "input_state.h"
+
+// Recorded session (.skr). Little-endian: a header, then run-length encoded
+// input masks, one run per stretch of identical ticks. Together with the seed
+// and step this reproduces a run exactly, provided the same compiled levels
+// are loaded. New buttons take the next free bit, which older files simply
+// leave clear; bump REPLAY_FILE_VERSION if a bit changes meaning.
+constexpr std::uint32_t REPLAY_FILE_MAGIC = 0x52424B53u; // "SKBR"
+constexpr std::uint32_t REPLAY_FILE_VERSION = 1;
+constexpr std::uint32_t REPLAY_FILE_ENDIAN_TAG = 0x01020304u;
+
+struct ReplayFileHeader
+{
+    std::uint32_t magic;
+    std::uint32_t version;
+    std::uint32_t endianTag;
+    std::uint32_t seed;
+    float step;
+    std::uint32_t tickCount;
+    std::uint32_t runCount;
+    std::uint32_t reserved;
+};
+
+struct ReplayRun
+{
+    std::uint32_t buttons;
+    std::uint32_t ticks;
+};
+
+static_assert(sizeof(ReplayFileHeader) == 32, "ReplayFileHeader layout changed");
+static_assert(sizeof(ReplayRun) == 8, "ReplayRun layout changed");
+
+std::uint32_t PackInputState(const InputState& input);
+InputState UnpackInputState(std::uint32_t buttons);
+
+// Collects the input fed to every simulation tick.
+class ReplayRecorder
+{
+public:
+    void Begin(std::uint32_t seed, float step);
+    void Record(const InputState& input);
+    bool Save(const std::string& path) const;
+
+    bool IsRecording() const { return recording; }
+    std::uint32_t GetTickCount() const { return tickCount; }
+
+private:
+    std::vector<ReplayRun> runs{};
+    std::uint32_t seed{0};
+    float step{0.0f};
+    std::uint32_t tickCount{0};
+    bool recording{false};
+};
+
+// Hands back one recorded InputState per tick, then empty input once finished.
+class ReplayPlayer
+{
+public:
+    bool Load(const std::string& path);
+    InputState Next();
+    void Rewind();
+
+    bool IsLoaded() const { return loaded; }
+    bool IsFinished() const { return tick >= tickCount; }
+    std::uint32_t GetSeed() const { return seed; }
+    float GetStep() const { return step; }
+    std::uint32_t GetTick() const { return tick; }
+    std::uint32_t GetTickCount() const { return tickCount; }
+
+private:
+    std::vector<ReplayRun> runs{};
+    std::uint32_t seed{0};
+    float step{0.0f};
+    std::uint32_t tickCount{0};
+    std::uint32_t tick{0};
+    std::size_t run{0};
+    std::uint32_t runTick{0};
+    bool loaded{false};
+};
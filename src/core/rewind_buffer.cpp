@@ -0,0 +1,323 @@
+#include "rewind_buffer.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace
+{
+    // Deltas are a series of runs: a header word holding how many words are
+    // unchanged (low half) and how many changed words follow (high half), then
+    // those words XORed with their previous value. Trailing unchanged words are
+    // left out. A partial last word is zero-padded.
+    constexpr std::uint32_t MAX_RUN_WORDS = 0xFFFFu;
+
+    std::size_t WordCount(std::size_t bytes)
+    {
+        return (bytes + 3) / 4;
+    }
+
+    std::uint32_t LoadWord(const unsigned char* bytes, std::size_t size, std::size_t word)
+    {
+        std::uint32_t value = 0;
+        const std::size_t offset = word * 4;
+        if (offset + 4 <= size)
+        {
+            std::memcpy(&value, bytes + offset, 4);
+        }
+        else
+        {
+            std::memcpy(&value, bytes + offset, size - offset);
+        }
+        return value;
+    }
+
+    void StoreWord(unsigned char* bytes, std::size_t size, std::size_t word, std::uint32_t value)
+    {
+        const std::size_t offset = word * 4;
+        if (offset + 4 <= size)
+        {
+            std::memcpy(bytes + offset, &value, 4);
+        }
+        else
+        {
+            std::memcpy(bytes + offset, &value, size - offset);
+        }
+    }
+
+    // Both states are `size` bytes. Always writes at least one header, so no
+    // record is ever empty.
+    void EncodeDelta(const unsigned char* previous, const unsigned char* current, std::size_t size, std::vector<unsigned char>& out)
+    {
+        const std::size_t words = WordCount(size);
+        // Worst case: every other word changed, one header per changed word.
+        out.resize((words + 1) * 8);
+        unsigned char* cursor = out.data();
+
+        std::size_t word = 0;
+        do
+        {
+            std::uint32_t unchanged = 0;
+            while (word < words && unchanged < MAX_RUN_WORDS &&
+                   LoadWord(previous, size, word) == LoadWord(current, size, word))
+            {
+                ++unchanged;
+                ++word;
+            }
+            if (word == words && cursor != out.data())
+            {
+                break;
+            }
+
+            unsigned char* header = cursor;
+            cursor += 4;
+            std::uint32_t changed = 0;
+            while (word < words && changed < MAX_RUN_WORDS)
+            {
+                const std::uint32_t difference = LoadWord(previous, size, word) ^ LoadWord(current, size, word);
+                if (difference == 0)
+                {
+                    break;
+                }
+                std::memcpy(cursor, &difference, 4);
+                cursor += 4;
+                ++changed;
+                ++word;
+            }
+
+            const std::uint32_t run = unchanged | (changed << 16);
+            std::memcpy(header, &run, 4);
+        } while (word < words);
+
+        out.resize(static_cast<std::size_t>(cursor - out.data()));
+    }
+}
+
+RewindBuffer::RewindBuffer(std::size_t memoryBudget, int maxFrames)
+    : storage(memoryBudget),
+      records(static_cast<std::size_t>(maxFrames + REWIND_KEYFRAME_INTERVAL))
+{
+}
+
+void RewindBuffer::Clear()
+{
+    firstRecord = 0;
+    recordCount = 0;
+    oldestGroupSize = 0;
+    framesSinceKeyframe = 0;
+    usedBytes = 0;
+    lastFrameBytes = 0;
+}
+
+void RewindBuffer::Push(const std::vector<unsigned char>& state, int windowFrames)
+{
+    if (state.empty())
+    {
+        return;
+    }
+
+    bool keyframe = recordCount == 0 || state.size() != latest.size() || framesSinceKeyframe + 1 >= REWIND_KEYFRAME_INTERVAL;
+    if (!keyframe)
+    {
+        EncodeDelta(latest.data(), state.data(), state.size(), scratch);
+        keyframe = scratch.size() >= state.size();
+    }
+
+    // Keep whole groups while dropping the oldest still leaves the window full.
+    const int capacity = static_cast<int>(records.size());
+    while (recordCount > 0)
+    {
+        const bool lastGroup = oldestGroupSize == recordCount;
+        if (lastGroup || (recordCount < capacity && recordCount - oldestGroupSize + 1 < windowFrames))
+        {
+            break;
+        }
+        DropOldestGroup();
+    }
+    if (recordCount >= capacity)
+    {
+        // One group fills the whole ring; only a keyframe can start afresh.
+        Clear();
+        keyframe = true;
+    }
+
+    if (keyframe)
+    {
+        if (!Store(state.data(), state.size(), true))
+        {
+            // Larger than the whole budget: no history at all.
+            Clear();
+            return;
+        }
+        framesSinceKeyframe = 0;
+    }
+    else
+    {
+        if (!Store(scratch.data(), scratch.size(), false))
+        {
+            Clear();
+            if (!Store(state.data(), state.size(), true))
+            {
+                return;
+            }
+            keyframe = true;
+        }
+        framesSinceKeyframe = keyframe ? 0 : framesSinceKeyframe + 1;
+    }
+
+    lastFrameBytes = RecordAt(recordCount - 1).size;
+    latest.assign(state.begin(), state.end());
+}
+
+bool RewindBuffer::StepBack(std::vector<unsigned char>& state)
+{
+    if (recordCount < 2)
+    {
+        return false;
+    }
+
+    const Record newest = RecordAt(recordCount - 1);
+    if (newest.keyframe)
+    {
+        Decode(recordCount - 2, latest);
+    }
+    else
+    {
+        ApplyDelta(storage.data() + newest.offset, newest.size, latest);
+    }
+    if (oldestGroupSize == recordCount)
+    {
+        oldestGroupSize -= 1;
+    }
+    recordCount -= 1;
+    usedBytes -= newest.size;
+
+    framesSinceKeyframe = 0;
+    while (!RecordAt(recordCount - 1 - framesSinceKeyframe).keyframe)
+    {
+        ++framesSinceKeyframe;
+    }
+
+    state.assign(latest.begin(), latest.end());
+    return true;
+}
+
+std::size_t RewindBuffer::RecordSlot(int index) const
+{
+    const std::size_t slot = static_cast<std::size_t>(firstRecord + index);
+    return slot >= records.size() ? slot - records.size() : slot;
+}
+
+const RewindBuffer::Record& RewindBuffer::RecordAt(int index) const
+{
+    return records[RecordSlot(index)];
+}
+
+bool RewindBuffer::Store(const unsigned char* bytes, std::size_t size, bool keyframe)
+{
+    std::size_t offset = 0;
+    while (!Reserve(size, offset))
+    {
+        // Never drop the group the new frame belongs to.
+        if (recordCount == 0 || (oldestGroupSize == recordCount && !keyframe))
+        {
+            return false;
+        }
+        DropOldestGroup();
+    }
+
+    std::memcpy(storage.data() + offset, bytes, size);
+    Record& record = records[RecordSlot(recordCount)];
+    record.offset = offset;
+    record.size = static_cast<std::uint32_t>(size);
+    record.keyframe = keyframe;
+    if (recordCount == 0 || (!keyframe && oldestGroupSize == recordCount))
+    {
+        oldestGroupSize += 1;
+    }
+    recordCount += 1;
+    usedBytes += size;
+    return true;
+}
+
+bool RewindBuffer::Reserve(std::size_t size, std::size_t& offset)
+{
+    if (recordCount == 0)
+    {
+        offset = 0;
+        return size <= storage.size();
+    }
+
+    // Records are never empty, so the newest one starting before the oldest
+    // means the ring has wrapped.
+    const Record& oldest = RecordAt(0);
+    const Record& newest = RecordAt(recordCount - 1);
+    const std::size_t head = newest.offset + newest.size;
+    const std::size_t tail = oldest.offset;
+    if (newest.offset < tail)
+    {
+        offset = head;
+        return head + size <= tail;
+    }
+    if (head + size <= storage.size())
+    {
+        offset = head;
+        return true;
+    }
+    offset = 0;
+    return size <= tail;
+}
+
+void RewindBuffer::DropOldestGroup()
+{
+    for (int i = 0; i < oldestGroupSize; ++i)
+    {
+        usedBytes -= RecordAt(i).size;
+    }
+    firstRecord = (firstRecord + oldestGroupSize) % static_cast<int>(records.size());
+    recordCount -= oldestGroupSize;
+
+    oldestGroupSize = recordCount > 0 ? 1 : 0;
+    while (oldestGroupSize < recordCount && !RecordAt(oldestGroupSize).keyframe)
+    {
+        ++oldestGroupSize;
+    }
+}
+
+void RewindBuffer::Decode(int index, std::vector<unsigned char>& state) const
+{
+    int keyframe = index;
+    while (!RecordAt(keyframe).keyframe)
+    {
+        --keyframe;
+    }
+
+    const Record& first = RecordAt(keyframe);
+    state.assign(storage.data() + first.offset, storage.data() + first.offset + first.size);
+    for (int i = keyframe + 1; i <= index; ++i)
+    {
+        const Record& record = RecordAt(i);
+        ApplyDelta(storage.data() + record.offset, record.size, state);
+    }
+}
+
+void RewindBuffer::ApplyDelta(const unsigned char* delta, std::size_t size, std::vector<unsigned char>& state)
+{
+    std::size_t word = 0;
+    std::size_t position = 0;
+    while (position + 4 <= size)
+    {
+        std::uint32_t run = 0;
+        std::memcpy(&run, delta + position, 4);
+        position += 4;
+        word += run & MAX_RUN_WORDS;
+
+        const std::uint32_t changed = run >> 16;
+        for (std::uint32_t i = 0; i < changed; ++i, ++word)
+        {
+            std::uint32_t difference = 0;
+            std::memcpy(&difference, delta + position, 4);
+            position += 4;
+            StoreWord(state.data(), state.size(), word, LoadWord(state.data(), state.size(), word) ^ difference);
+        }
+    }
+}
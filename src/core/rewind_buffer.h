@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+constexpr std::size_t REWIND_MEMORY_BUDGET = 4u * 1024u * 1024u;
+// Ten seconds at the highest supported tick rate.
+constexpr int REWIND_MAX_FRAMES = 2400;
+// A keyframe every this many frames bounds how many deltas a seek replays.
+constexpr int REWIND_KEYFRAME_INTERVAL = 64;
+
+// History of saved simulation states in a fixed block of memory. Frames are
+// stored as the XOR against the previous frame, run-length encoded in 32-bit
+// words, so the handful of values that change in a tick cost a few bytes and
+// the rest nothing. A raw keyframe starts every group of
+// REWIND_KEYFRAME_INTERVAL frames, and whenever the state changes size.
+//
+// XOR deltas undo as readily as they apply, so stepping back from the newest
+// frame costs one delta; only stepping back over a keyframe replays its group.
+// The oldest whole group is dropped when the frame window or the memory
+// budget runs out. Nothing allocates after construction, apart from scratch
+// buffers growing to the largest state seen.
+class RewindBuffer
+{
+public:
+    explicit RewindBuffer(std::size_t memoryBudget = REWIND_MEMORY_BUDGET, int maxFrames = REWIND_MAX_FRAMES);
+
+    void Clear();
+    // Appends the newest frame, keeping at most `windowFrames` of history.
+    void Push(const std::vector<unsigned char>& state, int windowFrames);
+    // Drops the newest frame and decodes the one before it into `state`;
+    // false, leaving `state` alone, when no earlier frame is held.
+    bool StepBack(std::vector<unsigned char>& state);
+
+    int GetFrameCount() const { return recordCount; }
+    std::size_t GetUsedBytes() const { return usedBytes; }
+    std::size_t GetLastFrameBytes() const { return lastFrameBytes; }
+
+private:
+    struct Record
+    {
+        std::size_t offset{0};
+        std::uint32_t size{0};
+        bool keyframe{false};
+    };
+
+    std::size_t RecordSlot(int index) const;
+    const Record& RecordAt(int index) const;
+    bool Store(const unsigned char* bytes, std::size_t size, bool keyframe);
+    bool Reserve(std::size_t size, std::size_t& offset);
+    void DropOldestGroup();
+    void Decode(int index, std::vector<unsigned char>& state) const;
+    static void ApplyDelta(const unsigned char* delta, std::size_t size, std::vector<unsigned char>& state);
+
+    std::vector<unsigned char> storage{};
+    std::vector<Record> records{};
+    int firstRecord{0};
+    int recordCount{0};
+    int oldestGroupSize{0};
+    int framesSinceKeyframe{0};
+    std::size_t usedBytes{0};
+    std::size_t lastFrameBytes{0};
+    // The newest frame, decoded.
+    std::vector<unsigned char> latest{};
+    std::vector<unsigned char> scratch{};
+};
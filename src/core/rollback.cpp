@@ -0,0 +1,311 @@
+#include "rollback.h"
+
+#include <algorithm>
+#include <chrono>
+
+#include "replay.h"
+#include "state_stream.h"
+
+namespace
+{
+    // Only movement and jumping cross the wire; the session starts both lanes
+    // itself and menus have no place in a race.
+    std::uint32_t RaceButtons()
+    {
+        InputState buttons{};
+        buttons.moveLeft = true;
+        buttons.moveRight = true;
+        buttons.jumpPressed = true;
+        return PackInputState(buttons);
+    }
+
+    // What a guess keeps of the last known input: a held direction most
+    // likely stays held, a jump press most likely does not repeat.
+    std::uint32_t HeldButtons()
+    {
+        InputState buttons{};
+        buttons.moveLeft = true;
+        buttons.moveRight = true;
+        return PackInputState(buttons);
+    }
+
+    std::size_t HistorySlot(int tick)
+    {
+        return static_cast<std::size_t>(tick) & static_cast<std::size_t>(ROLLBACK_HISTORY_TICKS - 1);
+    }
+
+    // FNV-1a; saved states are a few hundred bytes, so this is noise next to
+    // the tick itself.
+    std::uint64_t HashState(const std::vector<unsigned char>& bytes)
+    {
+        std::uint64_t hash = 0xCBF29CE484222325ull;
+        for (const unsigned char byte : bytes)
+        {
+            hash ^= byte;
+            hash *= 0x100000001B3ull;
+        }
+        return hash;
+    }
+}
+
+static_assert((ROLLBACK_HISTORY_TICKS & (ROLLBACK_HISTORY_TICKS - 1)) == 0, "history must be a power of two");
+static_assert(ROLLBACK_MAX_INPUTS_PER_PACKET <= 255, "input count is sent as a byte");
+
+RollbackSession::RollbackSession(int localPlayer, std::uint32_t seed)
+    : localPlayer(localPlayer),
+      remotePlayer(1 - localPlayer),
+      lanes{{Simulation(seed), Simulation(seed)}}
+{
+    remoteInputTicks.fill(-1);
+    peerChecksumTicks.fill(-1);
+    comparedChecksumTicks.fill(-1);
+    finishTicks.fill(-1);
+    outTicks.fill(-1);
+    for (Simulation& lane : lanes)
+    {
+        lane.SetRewindEnabled(false);
+    }
+    lanes[static_cast<std::size_t>(remotePlayer)].SaveState(remoteStates[0], SaveScope::Level);
+}
+
+int RollbackSession::SetLevelDirectory(const std::string& directory)
+{
+    int levels = 0;
+    for (Simulation& lane : lanes)
+    {
+        levels = lane.SetLevelDirectory(directory);
+    }
+    return levels;
+}
+
+bool RollbackSession::AdvanceTick(const InputState& localInput, LoopbackTransport& transport, double now)
+{
+    ReceivePackets(transport, now);
+    if (rollbackFrom >= 0)
+    {
+        RollBack(rollbackFrom);
+        rollbackFrom = -1;
+    }
+    CompareChecksums();
+
+    if (tick > remoteConfirmedTick + ROLLBACK_MAX_TICKS)
+    {
+        // Too far ahead to guess any further. Keep the acknowledgements
+        // flowing so the other peer is never left waiting on this one.
+        stats.stalledTicks += 1;
+        SendPacket(transport, now);
+        return false;
+    }
+
+    const std::size_t slot = HistorySlot(tick);
+    localInputs[slot] = PackInputState(localInput) & RaceButtons();
+    remoteUsed[slot] = RemoteButtons(tick);
+    StepLane(localPlayer, tick, localInputs[slot]);
+    StepLane(remotePlayer, tick, remoteUsed[slot]);
+    tick += 1;
+    stats.ticks += 1;
+
+    SendPacket(transport, now);
+    return true;
+}
+
+void RollbackSession::ReceivePackets(LoopbackTransport& transport, double now)
+{
+    while (transport.Receive(localPlayer, now, packet))
+    {
+        ReadPacket(packet);
+    }
+}
+
+void RollbackSession::ReadPacket(const std::vector<unsigned char>& data)
+{
+    StateReader reader(data.data(), data.size());
+    const int sender = reader.Read<unsigned char>();
+    const int firstTick = reader.Read<std::int32_t>();
+    const int count = reader.Read<unsigned char>();
+    std::array<std::uint32_t, ROLLBACK_MAX_INPUTS_PER_PACKET> buttons{};
+    for (int i = 0; i < count && i < ROLLBACK_MAX_INPUTS_PER_PACKET; ++i)
+    {
+        buttons[static_cast<std::size_t>(i)] = reader.Read<std::uint32_t>();
+    }
+    const int ackTick = reader.Read<std::int32_t>();
+    const int checksumTick = reader.Read<std::int32_t>();
+    const std::uint64_t checksum = reader.Read<std::uint64_t>();
+    if (!reader.IsValid() || !reader.IsFinished() || sender != remotePlayer || count > ROLLBACK_MAX_INPUTS_PER_PACKET)
+    {
+        return;
+    }
+
+    localAckedTick = std::max(localAckedTick, ackTick);
+
+    for (int i = 0; i < count; ++i)
+    {
+        const int inputTick = firstTick + i;
+        const std::size_t slot = HistorySlot(inputTick);
+        if (inputTick <= remoteConfirmedTick || inputTick - remoteConfirmedTick >= ROLLBACK_HISTORY_TICKS ||
+            remoteInputTicks[slot] == inputTick)
+        {
+            continue;
+        }
+
+        remoteInputs[slot] = buttons[static_cast<std::size_t>(i)] & RaceButtons();
+        remoteInputTicks[slot] = inputTick;
+        if (inputTick < tick && remoteUsed[slot] != remoteInputs[slot])
+        {
+            rollbackFrom = rollbackFrom < 0 ? inputTick : std::min(rollbackFrom, inputTick);
+        }
+    }
+    while (remoteInputTicks[HistorySlot(remoteConfirmedTick + 1)] == remoteConfirmedTick + 1)
+    {
+        remoteConfirmedTick += 1;
+    }
+
+    // A stalled peer keeps resending the same checksum.
+    if (checksumTick >= 0 && checksumTick > tick - ROLLBACK_HISTORY_TICKS &&
+        comparedChecksumTicks[HistorySlot(checksumTick)] != checksumTick)
+    {
+        const std::size_t slot = HistorySlot(checksumTick);
+        peerChecksums[slot] = checksum;
+        peerChecksumTicks[slot] = checksumTick;
+        if (checksumTick <= lastComparedTick)
+        {
+            // Arrived after its tick was already final here.
+            CompareChecksum(checksumTick);
+        }
+    }
+}
+
+void RollbackSession::SendPacket(LoopbackTransport& transport, double now)
+{
+    // Everything the other peer has not acknowledged, newest last, so one
+    // lost packet costs nothing once the next one lands.
+    const int lastTick = tick - 1;
+    const int firstTick = std::max(localAckedTick + 1, lastTick - ROLLBACK_MAX_INPUTS_PER_PACKET + 1);
+    const int count = std::max(lastTick - firstTick + 1, 0);
+
+    packet.clear();
+    StateWriter writer(packet);
+    writer.Write(static_cast<unsigned char>(localPlayer));
+    writer.Write(static_cast<std::int32_t>(firstTick));
+    writer.Write(static_cast<unsigned char>(count));
+    for (int i = 0; i < count; ++i)
+    {
+        writer.Write(localInputs[HistorySlot(firstTick + i)]);
+    }
+    writer.Write(static_cast<std::int32_t>(remoteConfirmedTick));
+
+    // The newest own-lane checksum; this lane never rolls back, so it is final.
+    const int checksumTick = tick - 1;
+    writer.Write(static_cast<std::int32_t>(checksumTick));
+    writer.Write(checksumTick >= 0 ? checksums[static_cast<std::size_t>(localPlayer)][HistorySlot(checksumTick)] : std::uint64_t{0});
+
+    transport.Send(localPlayer, packet.data(), packet.size(), now);
+}
+
+void RollbackSession::RollBack(int fromTick)
+{
+    const auto start = std::chrono::steady_clock::now();
+
+    // The stall keeps every mispredicted tick within the saved window.
+    Simulation& lane = lanes[static_cast<std::size_t>(remotePlayer)];
+    lane.LoadState(remoteStates[static_cast<std::size_t>(fromTick % STATE_SLOTS)]);
+    for (int* result : {&finishTicks[static_cast<std::size_t>(remotePlayer)], &outTicks[static_cast<std::size_t>(remotePlayer)]})
+    {
+        if (*result >= fromTick)
+        {
+            *result = -1;
+        }
+    }
+    for (int laneTick = fromTick; laneTick < tick; ++laneTick)
+    {
+        const std::size_t slot = HistorySlot(laneTick);
+        remoteUsed[slot] = RemoteButtons(laneTick);
+        StepLane(remotePlayer, laneTick, remoteUsed[slot]);
+    }
+
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    const int length = tick - fromTick;
+    stats.rollbacks += 1;
+    stats.resimulatedTicks += length;
+    stats.longestRollback = std::max(stats.longestRollback, length);
+    stats.longestRollbackSeconds = std::max(stats.longestRollbackSeconds, seconds);
+}
+
+void RollbackSession::StepLane(int player, int laneTick, std::uint32_t buttons)
+{
+    Simulation& lane = lanes[static_cast<std::size_t>(player)];
+    InputState input = UnpackInputState(buttons);
+    if (laneTick == 0)
+    {
+        // Both lanes start the time trial on the first tick.
+        input.confirmPressed = true;
+        input.toggleTimeTrial = true;
+    }
+    else if (lane.GetState() != GameState::Playing)
+    {
+        // Out of lives: the racer stays out rather than jumping back to the menu.
+        input = InputState{};
+    }
+    lane.Update(input, SIMULATION_STEP);
+
+    if (finishTicks[static_cast<std::size_t>(player)] < 0 && lane.GetLevel() > 1)
+    {
+        finishTicks[static_cast<std::size_t>(player)] = laneTick;
+    }
+    if (outTicks[static_cast<std::size_t>(player)] < 0 && lane.GetState() == GameState::GameOver)
+    {
+        outTicks[static_cast<std::size_t>(player)] = laneTick;
+    }
+
+    // The remote lane's state after this tick is the one a rollback to the
+    // next tick starts from; either way its hash is the tick's checksum.
+    std::vector<unsigned char>& saved = player == remotePlayer ? remoteStates[static_cast<std::size_t>((laneTick + 1) % STATE_SLOTS)] : scratch;
+    lane.SaveState(saved, SaveScope::Level);
+    checksums[static_cast<std::size_t>(player)][HistorySlot(laneTick)] = HashState(saved);
+}
+
+std::uint32_t RollbackSession::RemoteButtons(int laneTick) const
+{
+    const std::size_t slot = HistorySlot(laneTick);
+    if (remoteInputTicks[slot] == laneTick)
+    {
+        return remoteInputs[slot];
+    }
+    if (remoteConfirmedTick < 0)
+    {
+        return 0;
+    }
+    return remoteInputs[HistorySlot(remoteConfirmedTick)] & HeldButtons();
+}
+
+void RollbackSession::CompareChecksums()
+{
+    const int finalTick = std::min(remoteConfirmedTick, tick - 1);
+    for (int checkedTick = std::max(lastComparedTick + 1, tick - ROLLBACK_HISTORY_TICKS + 1); checkedTick <= finalTick; ++checkedTick)
+    {
+        CompareChecksum(checkedTick);
+    }
+    lastComparedTick = std::max(lastComparedTick, finalTick);
+}
+
+void RollbackSession::CompareChecksum(int checkedTick)
+{
+    const std::size_t slot = HistorySlot(checkedTick);
+    if (peerChecksumTicks[slot] != checkedTick)
+    {
+        return;
+    }
+
+    stats.checksumsCompared += 1;
+    if (peerChecksums[slot] != checksums[static_cast<std::size_t>(remotePlayer)][slot])
+    {
+        stats.desyncs += 1;
+        if (stats.firstDesyncTick < 0)
+        {
+            stats.firstDesyncTick = checkedTick;
+        }
+    }
+    // Each tick is compared once.
+    peerChecksumTicks[slot] = -1;
+    comparedChecksumTicks[slot] = checkedTick;
+}
@@ -0,0 +1,114 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "input_state.h"
+#include "loopback_transport.h"
+#include "simulation.h"
+
+constexpr int RACE_PLAYER_COUNT = 2;
+// How far a peer may run ahead of the other player's last known input, and
+// so the most ticks one rollback ever re-simulates.
+constexpr int ROLLBACK_MAX_TICKS = 8;
+// Inputs and checksums are kept this many ticks back; a power of two well
+// past the rollback window and a round trip's worth of checksum lag.
+constexpr int ROLLBACK_HISTORY_TICKS = 128;
+// Unacknowledged inputs are resent with every packet, up to this many.
+constexpr int ROLLBACK_MAX_INPUTS_PER_PACKET = 32;
+
+struct RollbackStats
+{
+    int ticks{0};
+    int stalledTicks{0};
+    int rollbacks{0};
+    int resimulatedTicks{0};
+    int longestRollback{0};
+    double longestRollbackSeconds{0.0};
+    int checksumsCompared{0};
+    int desyncs{0};
+    int firstDesyncTick{-1};
+};
+
+// One peer of a two-player time-trial race. Each player's run is its own
+// Simulation ("lane") with the same seed; racers never touch, so both peers
+// step both lanes and only the other player's lane is ever predicted.
+//
+// Each tick the other player's input is guessed by repeating their last known
+// held buttons. When their real input arrives and differs from the guess,
+// their lane is loaded from the state saved before that tick and re-simulated
+// up to the present, at most ROLLBACK_MAX_TICKS ticks. Every packet carries
+// the sender's own-lane checksum for its latest tick, which the receiver
+// compares against its copy of that lane once it is final.
+class RollbackSession
+{
+public:
+    RollbackSession(int localPlayer, std::uint32_t seed);
+
+    int SetLevelDirectory(const std::string& directory);
+
+    // Takes the other peer's packets, rolls back if a guess was wrong, sends
+    // the local input and advances both lanes one tick. False, advancing
+    // nothing, while ROLLBACK_MAX_TICKS ahead of the other player's input;
+    // call again on a later frame.
+    bool AdvanceTick(const InputState& localInput, LoopbackTransport& transport, double now);
+
+    int GetLocalPlayer() const { return localPlayer; }
+    // Ticks simulated so far.
+    int GetTick() const { return tick; }
+    // The last tick whose input from the other player is known; both lanes
+    // are final up to here.
+    int GetConfirmedTick() const { return remoteConfirmedTick; }
+    const Simulation& GetLane(int player) const { return lanes[static_cast<std::size_t>(player)]; }
+    // The tick a player's lane cleared the first level, or -1. Only final
+    // once it is at or before GetConfirmedTick.
+    int GetFinishTick(int player) const { return finishTicks[static_cast<std::size_t>(player)]; }
+    // The tick a player's lane ran out of lives, or -1; final on the same terms.
+    int GetOutTick(int player) const { return outTicks[static_cast<std::size_t>(player)]; }
+    const RollbackStats& GetStats() const { return stats; }
+
+private:
+    static constexpr int STATE_SLOTS = ROLLBACK_MAX_TICKS + 1;
+
+    void ReceivePackets(LoopbackTransport& transport, double now);
+    void ReadPacket(const std::vector<unsigned char>& data);
+    void SendPacket(LoopbackTransport& transport, double now);
+    void RollBack(int fromTick);
+    void StepLane(int player, int laneTick, std::uint32_t buttons);
+    std::uint32_t RemoteButtons(int laneTick) const;
+    void CompareChecksums();
+    void CompareChecksum(int checkedTick);
+
+    int localPlayer{0};
+    int remotePlayer{1};
+    std::array<Simulation, RACE_PLAYER_COUNT> lanes;
+    int tick{0};
+
+    std::array<std::uint32_t, ROLLBACK_HISTORY_TICKS> localInputs{};
+    std::array<std::uint32_t, ROLLBACK_HISTORY_TICKS> remoteInputs{};
+    // Which tick each remote input slot holds, or -1.
+    std::array<int, ROLLBACK_HISTORY_TICKS> remoteInputTicks{};
+    // What the remote lane was actually stepped with, guess or not.
+    std::array<std::uint32_t, ROLLBACK_HISTORY_TICKS> remoteUsed{};
+    int remoteConfirmedTick{-1};
+    // The newest local input the other peer has acknowledged.
+    int localAckedTick{-1};
+    int rollbackFrom{-1};
+
+    // The remote lane as it was before each tick still open to a rollback.
+    std::array<std::vector<unsigned char>, STATE_SLOTS> remoteStates{};
+    std::array<std::array<std::uint64_t, ROLLBACK_HISTORY_TICKS>, RACE_PLAYER_COUNT> checksums{};
+    std::array<std::uint64_t, ROLLBACK_HISTORY_TICKS> peerChecksums{};
+    std::array<int, ROLLBACK_HISTORY_TICKS> peerChecksumTicks{};
+    // The tick each slot's checksum was last compared for, so resent copies are not compared again.
+    std::array<int, ROLLBACK_HISTORY_TICKS> comparedChecksumTicks{};
+    int lastComparedTick{-1};
+
+    std::array<int, RACE_PLAYER_COUNT> finishTicks{};
+    std::array<int, RACE_PLAYER_COUNT> outTicks{};
+    RollbackStats stats{};
+    std::vector<unsigned char> scratch{};
+    std::vector<unsigned char> packet{};
+};
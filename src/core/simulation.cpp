@@ -0,0 +1,841 @@
+#include "simulation.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <utility>
+
+#include "job_system.h"
+#include "level_generator.h"
+#include "state_stream.h"
+
+namespace
+{
+    constexpr float ACHIEVEMENT_DISPLAY_TIME = 3.5f;
+    constexpr float LANDING_DUST_MIN_SPEED = 220.0f;
+    // Below this many moving things a tick is a few microseconds of work and
+    // handing it to other threads costs more than it saves.
+    constexpr std::size_t PARALLEL_TICK_MIN_ENTITIES = 4096;
+
+    // AchievementState::lastUnlocked always points at one of these. Saved
+    // state stores the index, since the address differs from run to run.
+    enum AchievementMessage
+    {
+        FIRST_COIN_MESSAGE,
+        TEN_COINS_MESSAGE,
+        COMBO_FIVE_MESSAGE,
+        TIME_TRIAL_MESSAGE,
+        ACHIEVEMENT_MESSAGE_COUNT
+    };
+
+    const char* const ACHIEVEMENT_MESSAGES[ACHIEVEMENT_MESSAGE_COUNT] = {
+        "Shiny Start: Collected your first coin!",
+        "Treasure Hunter: 10 coins collected!",
+        "Combo Master: 5x combo achieved!",
+        "Speedrunner: New time trial record!",
+    };
+
+    std::int32_t FindAchievementMessage(const char* message)
+    {
+        for (std::int32_t i = 0; i < ACHIEVEMENT_MESSAGE_COUNT; ++i)
+        {
+            if (ACHIEVEMENT_MESSAGES[i] == message)
+            {
+                return i;
+            }
+        }
+        return -1;
+    }
+
+    void WritePlayer(StateWriter& writer, const Player& player)
+    {
+        writer.Write(player.position.x);
+        writer.Write(player.position.y);
+        writer.Write(player.velocity.x);
+        writer.Write(player.velocity.y);
+        writer.Write(player.previousPosition.x);
+        writer.Write(player.previousPosition.y);
+        writer.Write(player.width);
+        writer.Write(player.height);
+        writer.Write(player.grounded);
+        writer.Write(player.lives);
+        writer.Write(player.score);
+        writer.Write(player.speed);
+        writer.Write(player.jumpStrength);
+        writer.Write(player.invincibilityTimer);
+        writer.Write(player.comboCount);
+        writer.Write(player.bestCombo);
+        writer.Write(player.comboTimer);
+        writer.Write(player.comboWindow);
+        writer.Write(player.totalCoinsCollected);
+    }
+
+    Player ReadPlayer(StateReader& reader)
+    {
+        Player player{};
+        player.position.x = reader.Read<float>();
+        player.position.y = reader.Read<float>();
+        player.velocity.x = reader.Read<float>();
+        player.velocity.y = reader.Read<float>();
+        player.previousPosition.x = reader.Read<float>();
+        player.previousPosition.y = reader.Read<float>();
+        player.width = reader.Read<float>();
+        player.height = reader.Read<float>();
+        player.grounded = reader.ReadBool();
+        player.lives = reader.Read<int>();
+        player.score = reader.Read<int>();
+        player.speed = reader.Read<float>();
+        player.jumpStrength = reader.Read<float>();
+        player.invincibilityTimer = reader.Read<float>();
+        player.comboCount = reader.Read<int>();
+        player.bestCombo = reader.Read<int>();
+        player.comboTimer = reader.Read<float>();
+        player.comboWindow = reader.Read<float>();
+        player.totalCoinsCollected = reader.Read<int>();
+        return player;
+    }
+
+    // A whole-level save's platform record, anchor timer and age, and enemy
+    // record, anchor x, direction and age.
+    constexpr std::size_t PLATFORM_RECORD_BYTES = sizeof(float) + sizeof(int);
+    constexpr std::size_t ENEMY_RECORD_BYTES = 2 * sizeof(float) + sizeof(int);
+
+    // The weather fields the tick evolves; rain drops are visual only.
+    constexpr int WEATHER_STATE_FLOATS = 9;
+    float WeatherState::* const WEATHER_STATE_FIELDS[WEATHER_STATE_FLOATS] = {
+        &WeatherState::timeUntilChange,
+        &WeatherState::rainIntensity,
+        &WeatherState::baseWind,
+        &WeatherState::windVariance,
+        &WeatherState::windCurrent,
+        &WeatherState::windTarget,
+        &WeatherState::windChangeTimer,
+        &WeatherState::lightningCooldown,
+        &WeatherState::lightningFlashTimer,
+    };
+}
+
+Simulation::Simulation(std::uint32_t seed)
+    : rng(seed)
+{
+    bestTimeTrial = std::numeric_limits<float>::infinity();
+    InitWeather(weather, rng, viewSize);
+    InitEffects(effects, rng);
+    levelLibrary.SetGeneration(seed, MakeJumpLimits(player, gravity));
+    ResetLevel();
+}
+
+void Simulation::SetViewSize(Vector2 size)
+{
+    viewSize = size;
+}
+
+int Simulation::SetLevelDirectory(const std::string& directory)
+{
+    return levelLibrary.SetDirectory(directory);
+}
+
+void Simulation::Update(const InputState& input, float dt)
+{
+    UpdateWeather(weather, rng, viewSize, dt);
+    HandleInputToggles(input);
+
+    switch (state)
+    {
+        case GameState::Menu:
+        {
+            if (input.jumpPressed || input.confirmPressed)
+            {
+                state = GameState::Playing;
+                ResetLevel();
+                timeTrialActive = timeTrialMode;
+                timeTrialTimer = 0.0f;
+            }
+            break;
+        }
+        case GameState::Playing:
+        {
+            if (input.pausePressed)
+            {
+                state = GameState::Paused;
+                rewinding = false;
+                break;
+            }
+
+            rewinding = rewindEnabled && input.rewindHeld;
+            if (rewinding)
+            {
+                // At the start of the history this simply holds still.
+                if (rewindBuffer.StepBack(rewindFrame))
+                {
+                    LoadState(rewindFrame);
+                }
+                break;
+            }
+
+            StreamWorld(CHUNK_LOADS_PER_TICK);
+
+            // Platforms, enemies and particles own disjoint state, so they run
+            // side by side; only the player has to wait for the platforms.
+            // Everything that reads across systems follows once all are done.
+            bool wasGrounded = false;
+            float fallSpeed = 0.0f;
+            const LodFocus focus = GetLodFocus();
+            auto movePlatforms = [&]() { UpdatePlatforms(platforms, platformGrid, dt, focus); };
+            auto moveEnemies = [&]() { MoveEnemies(enemies, enemyGrid, dt, focus); };
+            auto updateEffects = [&]() { UpdateEffects(effects, dt); };
+            auto movePlayer = [&]()
+            {
+                ApplyPlayerInput(player, input, dt);
+                UpdatePlayerPhysics(player, gravity, dt, GetWeatherForce(weather));
+                wasGrounded = player.grounded;
+                fallSpeed = player.velocity.y;
+                ResolvePlayerPlatforms(player, platforms, platformGrid);
+            };
+
+            TaskGraph tick{};
+            const int platformTask = tick.Add(movePlatforms);
+            const int playerTask = tick.Add(movePlayer);
+            tick.Add(moveEnemies);
+            tick.Add(updateEffects);
+            tick.Precede(platformTask, playerTask);
+            const std::size_t particles = static_cast<std::size_t>(effects.dust.GetCount() + effects.sparkle.GetCount() + effects.hit.GetCount());
+            tick.Run(platforms.MoverCount() + enemies.Size() + particles >= PARALLEL_TICK_MIN_ENTITIES);
+
+            if (!wasGrounded && player.grounded && fallSpeed >= LANDING_DUST_MIN_SPEED)
+            {
+                EmitLandingDust(effects, {player.position.x + player.width * 0.5f, player.position.y + player.height}, fallSpeed);
+            }
+
+            const bool wasVulnerable = player.invincibilityTimer <= 0.0f;
+            ResolveEnemyHits(enemies, enemyGrid, player);
+            if (wasVulnerable && player.invincibilityTimer > 0.0f)
+            {
+                EmitEnemyHit(effects, GetPlayerCentre(player));
+            }
+
+            const int coinsCollected = CheckCoinCollection(coins, coinGrid, player);
+            coinsRemaining -= coinsCollected;
+            if (coinsCollected > 0)
+            {
+                // The coin overlapped the player, so the player's centre is close enough.
+                EmitCoinSparkle(effects, GetPlayerCentre(player), coinsCollected);
+            }
+            UpdateAchievements(coinsCollected, dt);
+            UpdateComboTimer();
+
+            const bool allCollected = coinsRemaining <= 0;
+            const bool newBestTime = UpdateTimeTrial(dt, allCollected);
+
+            if (newBestTime)
+            {
+                achievements.timeTrialClearUnlocked = true;
+                achievements.lastUnlocked = ACHIEVEMENT_MESSAGES[TIME_TRIAL_MESSAGE];
+                achievements.notificationTimer = ACHIEVEMENT_DISPLAY_TIME;
+            }
+
+            if (allCollected)
+            {
+                currentLevel += 1;
+                player.lives = std::min(player.lives + 1, 5);
+                ResetLevel();
+                timeTrialActive = timeTrialMode;
+                timeTrialTimer = 0.0f;
+            }
+
+            if (player.lives <= 0)
+            {
+                state = GameState::GameOver;
+            }
+            else if (rewindEnabled)
+            {
+                CaptureRewindFrame(dt);
+            }
+
+            break;
+        }
+        case GameState::Paused:
+        {
+            if (input.pausePressed)
+            {
+                state = GameState::Playing;
+            }
+            break;
+        }
+        case GameState::GameOver:
+        {
+            if (input.restartPressed)
+            {
+                currentLevel = 1;
+                ResetLevel();
+                state = GameState::Playing;
+                timeTrialActive = timeTrialMode;
+                timeTrialTimer = 0.0f;
+            }
+            else if (input.jumpPressed)
+            {
+                state = GameState::Menu;
+            }
+            break;
+        }
+    }
+}
+
+void Simulation::ResetLevel()
+{
+    if (currentLevel <= 1)
+    {
+        currentLevel = 1;
+        player.score = 0;
+        player.lives = 3;
+        player.totalCoinsCollected = 0;
+        player.bestCombo = 0;
+        hasBestTime = false;
+        bestTimeTrial = std::numeric_limits<float>::infinity();
+    }
+
+    LoadLevelLayout();
+    coinsRemaining = static_cast<int>(worldStream.GetLayout().coins.size());
+    ResetPlayer(player, worldStream.GetLayout().spawnPoint);
+
+    platforms.Clear();
+    enemies.Clear();
+    coins.clear();
+    ClearEffects(effects);
+    StreamWorld(std::numeric_limits<int>::max());
+
+    timeTrialActive = timeTrialMode;
+    timeTrialTimer = 0.0f;
+    levelSerial += 1;
+}
+
+void Simulation::LoadLevelLayout()
+{
+    // The outgoing layout and all the stream's bookkeeping live in the arena,
+    // and Build below replaces every one of them, so this drops the whole
+    // level in one step and the new one reuses the same memory.
+    levelArena->Reset();
+    LevelLayout layout = levelLibrary.Load(currentLevel, levelArena.get());
+    std::shared_ptr<StaticGeometry> geometry = TakeStaticGeometry();
+    BuildStaticGeometry(layout, *geometry);
+    staticGeometry = std::move(geometry);
+    worldStream.Build(std::move(layout));
+    levelLibrary.Prefetch(currentLevel + 1);
+
+    // Cells of the outgoing level are dropped; the rebuild files into spares.
+    platformGrid.Reset();
+    enemyGrid.Reset();
+    coinGrid.Reset();
+
+    // Rewind frames only make sense within the level they were taken in.
+    rewindBuffer.Clear();
+    rewinding = false;
+}
+
+std::shared_ptr<StaticGeometry> Simulation::TakeStaticGeometry()
+{
+    // Snapshots and the tile cache may still hold earlier levels' geometry. An
+    // entry only the pool references can be refilled; the acquire pairs with
+    // the release of the last other reference.
+    for (std::shared_ptr<StaticGeometry>& entry : staticGeometryPool)
+    {
+        if (!entry)
+        {
+            entry = std::make_shared<StaticGeometry>();
+            return entry;
+        }
+        if (entry.use_count() == 1)
+        {
+            std::atomic_thread_fence(std::memory_order_acquire);
+            return entry;
+        }
+    }
+    return std::make_shared<StaticGeometry>();
+}
+
+void Simulation::SetLodEnabled(bool enabled)
+{
+    lodEnabled = enabled;
+}
+
+LodFocus Simulation::GetLodFocus() const
+{
+    // Wide enough for the whole view at the camera's closest zoom-out.
+    LodFocus focus{};
+    focus.x = player.position.x;
+    focus.fullRateDistance = std::max(LOD_FULL_RATE_DISTANCE, viewSize.x);
+    focus.enabled = lodEnabled;
+    return focus;
+}
+
+void Simulation::SetRewindEnabled(bool enabled)
+{
+    rewindEnabled = enabled;
+    rewindBuffer.Clear();
+    rewinding = false;
+}
+
+void Simulation::CaptureRewindFrame(float dt)
+{
+    SaveState(rewindFrame);
+    const int window = static_cast<int>(std::lround(REWIND_WINDOW_SECONDS / dt));
+    rewindBuffer.Push(rewindFrame, std::max(window, 1));
+}
+
+void Simulation::SaveState(std::vector<unsigned char>& out, SaveScope scope) const
+{
+    out.clear();
+    StateWriter writer(out);
+
+    writer.Write(levelSerial);
+    writer.Write(static_cast<unsigned char>(scope));
+    writer.Write(currentLevel);
+    writer.Write(static_cast<std::int32_t>(state));
+    writer.Write(coinsRemaining);
+    WritePlayer(writer, player);
+
+    writer.Write(achievements.firstCoinUnlocked);
+    writer.Write(achievements.tenCoinsUnlocked);
+    writer.Write(achievements.comboFiveUnlocked);
+    writer.Write(achievements.timeTrialClearUnlocked);
+    writer.Write(FindAchievementMessage(achievements.lastUnlocked));
+    writer.Write(achievements.notificationTimer);
+
+    writer.Write(timeTrialMode);
+    writer.Write(timeTrialActive);
+    writer.Write(timeTrialTimer);
+    writer.Write(bestTimeTrial);
+    writer.Write(hasBestTime);
+
+    writer.Write(static_cast<std::int32_t>(weather.current));
+    for (float WeatherState::* const field : WEATHER_STATE_FIELDS)
+    {
+        writer.Write(weather.*field);
+    }
+    writer.Write(rng.GetState());
+
+    const LevelVector<int>& loadedChunks = worldStream.GetLoadedChunks();
+    writer.Write(static_cast<std::uint32_t>(loadedChunks.size()));
+    for (const int coordinate : loadedChunks)
+    {
+        writer.Write(coordinate);
+    }
+
+    const LevelVector<int>& activePlatforms = worldStream.GetActivePlatforms();
+    const LevelVector<int>& activeEnemies = worldStream.GetActiveEnemies();
+    const LevelVector<int>& activeCoins = worldStream.GetActiveCoins();
+
+    if (scope == SaveScope::Level)
+    {
+        // Every entity in layout order, so the bytes depend only on the state
+        // and never on the order chunks streamed in. The layout is stale for
+        // the active entities; their records are rewritten from the stores.
+        const LevelLayout& layout = worldStream.GetLayout();
+        writer.Write(static_cast<std::uint32_t>(layout.platforms.size()));
+        const std::size_t platformRecords = writer.GetSize();
+        for (const Platform& platform : layout.platforms)
+        {
+            writer.Write(platform.timer);
+            writer.Write(platform.age);
+        }
+        writer.Write(static_cast<std::uint32_t>(layout.enemies.size()));
+        const std::size_t enemyRecords = writer.GetSize();
+        for (const Enemy& enemy : layout.enemies)
+        {
+            writer.Write(enemy.bounds.x);
+            writer.Write(static_cast<float>(enemy.direction));
+            writer.Write(enemy.age);
+        }
+        writer.Write(static_cast<std::uint32_t>(layout.coins.size()));
+        const std::size_t coinRecords = writer.GetSize();
+        for (const Coin& coin : layout.coins)
+        {
+            writer.Write(coin.collected);
+        }
+
+        for (std::size_t i = 0; i < platforms.MoverCount(); ++i)
+        {
+            const auto index = static_cast<std::size_t>(activePlatforms[static_cast<std::size_t>(platforms.moverPlatform[i])]);
+            const std::size_t record = platformRecords + index * PLATFORM_RECORD_BYTES;
+            writer.WriteAt(record, platforms.moverAnchorTimer[i]);
+            writer.WriteAt(record + sizeof(float), platforms.GetAge(i));
+        }
+        for (std::size_t i = 0; i < enemies.Size(); ++i)
+        {
+            const std::size_t record = enemyRecords + static_cast<std::size_t>(activeEnemies[i]) * ENEMY_RECORD_BYTES;
+            writer.WriteAt(record, enemies.anchorX[i]);
+            writer.WriteAt(record + sizeof(float), enemies.anchorDirection[i]);
+            writer.WriteAt(record + 2 * sizeof(float), enemies.GetAge(i));
+        }
+        for (std::size_t i = 0; i < coins.size(); ++i)
+        {
+            writer.WriteAt(coinRecords + static_cast<std::size_t>(activeCoins[i]), coins[i].collected);
+        }
+        return;
+    }
+
+    // Active entities by layout index. Static platforms never change, and
+    // path, size and patrol data come from the layout, so only what moves is
+    // saved. Movers and patrols are saved as their anchors, which stay the
+    // same whichever ticks LOD skipped, so the bytes do too.
+    writer.Write(static_cast<std::uint32_t>(platforms.MoverCount()));
+    for (std::size_t i = 0; i < platforms.MoverCount(); ++i)
+    {
+        writer.Write(activePlatforms[static_cast<std::size_t>(platforms.moverPlatform[i])]);
+        writer.Write(platforms.moverAnchorTimer[i]);
+        writer.Write(platforms.GetAge(i));
+    }
+
+    writer.Write(static_cast<std::uint32_t>(enemies.Size()));
+    for (std::size_t i = 0; i < enemies.Size(); ++i)
+    {
+        writer.Write(activeEnemies[i]);
+        writer.Write(enemies.anchorX[i]);
+        writer.Write(enemies.anchorDirection[i]);
+        writer.Write(enemies.GetAge(i));
+    }
+
+    writer.Write(static_cast<std::uint32_t>(coins.size()));
+    for (std::size_t i = 0; i < coins.size(); ++i)
+    {
+        writer.Write(activeCoins[i]);
+        writer.Write(coins[i].collected);
+    }
+}
+
+bool Simulation::LoadState(const std::vector<unsigned char>& data)
+{
+    StateReader reader(data.data(), data.size());
+    const std::uint32_t savedSerial = reader.Read<std::uint32_t>();
+    const unsigned char savedScope = reader.Read<unsigned char>();
+    const auto scope = static_cast<SaveScope>(savedScope);
+    const int savedLevel = reader.Read<int>();
+    const bool otherLevel = savedSerial != levelSerial;
+    if (!reader.IsValid() || savedScope > static_cast<unsigned char>(SaveScope::Level) || savedLevel < 1 ||
+        (otherLevel && scope != SaveScope::Level))
+    {
+        return false;
+    }
+
+    const std::int32_t savedStateValue = reader.Read<std::int32_t>();
+    const auto savedState = static_cast<GameState>(savedStateValue);
+    const int savedCoinsRemaining = reader.Read<int>();
+    const Player savedPlayer = ReadPlayer(reader);
+
+    AchievementState savedAchievements{};
+    savedAchievements.firstCoinUnlocked = reader.ReadBool();
+    savedAchievements.tenCoinsUnlocked = reader.ReadBool();
+    savedAchievements.comboFiveUnlocked = reader.ReadBool();
+    savedAchievements.timeTrialClearUnlocked = reader.ReadBool();
+    const std::int32_t message = reader.Read<std::int32_t>();
+    savedAchievements.lastUnlocked = message >= 0 && message < ACHIEVEMENT_MESSAGE_COUNT ? ACHIEVEMENT_MESSAGES[message] : nullptr;
+    savedAchievements.notificationTimer = reader.Read<float>();
+
+    const bool savedTimeTrialMode = reader.ReadBool();
+    const bool savedTimeTrialActive = reader.ReadBool();
+    const float savedTimeTrialTimer = reader.Read<float>();
+    const float savedBestTimeTrial = reader.Read<float>();
+    const bool savedHasBestTime = reader.ReadBool();
+
+    const std::int32_t savedWeatherValue = reader.Read<std::int32_t>();
+    const auto savedWeather = static_cast<WeatherType>(savedWeatherValue);
+    float savedWeatherFields[WEATHER_STATE_FLOATS] = {};
+    for (float& field : savedWeatherFields)
+    {
+        field = reader.Read<float>();
+    }
+    const std::uint64_t savedRng = reader.Read<std::uint64_t>();
+
+    const std::uint32_t chunkCount = reader.Read<std::uint32_t>();
+    restoreChunks.clear();
+    for (std::uint32_t i = 0; i < chunkCount && reader.IsValid(); ++i)
+    {
+        restoreChunks.push_back(reader.Read<int>());
+    }
+    if (!reader.IsValid() || savedStateValue < static_cast<std::int32_t>(GameState::Menu) ||
+        savedStateValue > static_cast<std::int32_t>(GameState::GameOver) ||
+        savedWeatherValue < static_cast<std::int32_t>(WeatherType::Clear) ||
+        savedWeatherValue > static_cast<std::int32_t>(WeatherType::Storm))
+    {
+        return false;
+    }
+
+    // Check the entity records before touching anything else. State from
+    // another level is checked against a copy of that level's layout, so the
+    // current level stays as it is if the records are malformed.
+    const LevelLayout otherLayout = otherLevel ? levelLibrary.Load(savedLevel) : LevelLayout{};
+    const LevelLayout& layout = otherLevel ? otherLayout : worldStream.GetLayout();
+    StateReader check = reader;
+    auto checkRecords = [&check](std::size_t layoutSize, int floats, int ints, int flags)
+    {
+        const std::uint32_t count = check.Read<std::uint32_t>();
+        for (std::uint32_t i = 0; i < count && check.IsValid(); ++i)
+        {
+            const int index = check.Read<int>();
+            if (index < 0 || static_cast<std::size_t>(index) >= layoutSize)
+            {
+                return false;
+            }
+            for (int field = 0; field < floats; ++field)
+            {
+                check.Read<float>();
+            }
+            for (int field = 0; field < ints; ++field)
+            {
+                check.Read<int>();
+            }
+            for (int field = 0; field < flags; ++field)
+            {
+                check.ReadBool();
+            }
+        }
+        return check.IsValid();
+    };
+    auto checkLevelRecords = [&check](std::size_t layoutSize, int floats, int ints, int flags)
+    {
+        if (check.Read<std::uint32_t>() != layoutSize)
+        {
+            return false;
+        }
+        for (std::size_t i = 0; i < layoutSize; ++i)
+        {
+            for (int field = 0; field < floats; ++field)
+            {
+                check.Read<float>();
+            }
+            for (int field = 0; field < ints; ++field)
+            {
+                check.Read<int>();
+            }
+            for (int field = 0; field < flags; ++field)
+            {
+                check.ReadBool();
+            }
+        }
+        return check.IsValid();
+    };
+    const bool recordsValid = scope == SaveScope::Level
+        ? checkLevelRecords(layout.platforms.size(), 1, 1, 0) &&
+          checkLevelRecords(layout.enemies.size(), 2, 1, 0) &&
+          checkLevelRecords(layout.coins.size(), 0, 0, 1)
+        : checkRecords(layout.platforms.size(), 1, 1, 0) &&
+          checkRecords(layout.enemies.size(), 2, 1, 0) &&
+          checkRecords(layout.coins.size(), 0, 0, 1);
+    if (!recordsValid || !check.IsFinished())
+    {
+        return false;
+    }
+
+    if (otherLevel)
+    {
+        // Every entity of the saved level is in the records, so a freshly
+        // built copy of it patches up to exactly the saved state.
+        currentLevel = savedLevel;
+        LoadLevelLayout();
+        levelSerial = savedSerial;
+    }
+
+    state = savedState;
+    currentLevel = savedLevel;
+    coinsRemaining = savedCoinsRemaining;
+    player = savedPlayer;
+    achievements = savedAchievements;
+    timeTrialMode = savedTimeTrialMode;
+    timeTrialActive = savedTimeTrialActive;
+    timeTrialTimer = savedTimeTrialTimer;
+    bestTimeTrial = savedBestTimeTrial;
+    hasBestTime = savedHasBestTime;
+    weather.current = savedWeather;
+    for (int i = 0; i < WEATHER_STATE_FLOATS; ++i)
+    {
+        weather.*WEATHER_STATE_FIELDS[i] = savedWeatherFields[i];
+    }
+    rng.SetState(savedRng);
+
+    LevelLayout& patched = worldStream.BeginRestore();
+    if (scope == SaveScope::Level)
+    {
+        reader.Read<std::uint32_t>();
+        for (Platform& platform : patched.platforms)
+        {
+            platform.timer = reader.Read<float>();
+            platform.age = reader.Read<int>();
+        }
+        reader.Read<std::uint32_t>();
+        for (Enemy& enemy : patched.enemies)
+        {
+            enemy.bounds.x = reader.Read<float>();
+            enemy.direction = reader.Read<float>() < 0.0f ? -1 : 1;
+            enemy.age = reader.Read<int>();
+        }
+        reader.Read<std::uint32_t>();
+        for (Coin& coin : patched.coins)
+        {
+            coin.collected = reader.ReadBool();
+        }
+    }
+    else
+    {
+        const std::uint32_t moverCount = reader.Read<std::uint32_t>();
+        for (std::uint32_t i = 0; i < moverCount; ++i)
+        {
+            Platform& platform = patched.platforms[static_cast<std::size_t>(reader.Read<int>())];
+            platform.timer = reader.Read<float>();
+            platform.age = reader.Read<int>();
+        }
+        const std::uint32_t enemyCount = reader.Read<std::uint32_t>();
+        for (std::uint32_t i = 0; i < enemyCount; ++i)
+        {
+            Enemy& enemy = patched.enemies[static_cast<std::size_t>(reader.Read<int>())];
+            enemy.bounds.x = reader.Read<float>();
+            enemy.direction = reader.Read<float>() < 0.0f ? -1 : 1;
+            enemy.age = reader.Read<int>();
+        }
+        const std::uint32_t coinCount = reader.Read<std::uint32_t>();
+        for (std::uint32_t i = 0; i < coinCount; ++i)
+        {
+            Coin& coin = patched.coins[static_cast<std::size_t>(reader.Read<int>())];
+            coin.collected = reader.ReadBool();
+        }
+    }
+
+    if (!worldStream.EndRestore(restoreChunks, platforms, enemies, coins))
+    {
+        // Not chunks of this level; stream around the player instead.
+        restoreChunks.clear();
+        worldStream.EndRestore(restoreChunks, platforms, enemies, coins);
+        StreamWorld(std::numeric_limits<int>::max());
+    }
+    RebuildBroadphase();
+    return true;
+}
+
+void Simulation::RebuildBroadphase()
+{
+    platformGrid.Clear();
+    enemyGrid.Clear();
+    coinGrid.Clear();
+
+    for (std::size_t i = 0; i < platforms.Size(); ++i)
+    {
+        platformGrid.Insert(static_cast<int>(i), platforms.GetBounds(i));
+    }
+
+    for (std::size_t i = 0; i < enemies.Size(); ++i)
+    {
+        enemyGrid.Insert(static_cast<int>(i), enemies.GetBounds(i));
+    }
+
+    for (std::size_t i = 0; i < coins.size(); ++i)
+    {
+        if (!coins[i].collected)
+        {
+            coinGrid.Insert(static_cast<int>(i), GetCoinBounds(coins[i]));
+        }
+    }
+}
+
+void Simulation::StreamWorld(int loadBudget)
+{
+    // The camera is centred on the player, so this is camera.target without
+    // tying the simulation to the render-side camera.
+    const float focusX = player.position.x + player.width * 0.5f;
+    if (worldStream.Update(focusX, loadBudget, platforms, enemies, coins))
+    {
+        RebuildBroadphase();
+    }
+}
+
+void Simulation::HandleInputToggles(const InputState& input)
+{
+    if (input.toggleTimeTrial)
+    {
+        timeTrialMode = !timeTrialMode;
+        if (!timeTrialMode)
+        {
+            timeTrialActive = false;
+        }
+        else
+        {
+            timeTrialActive = true;
+            timeTrialTimer = 0.0f;
+        }
+    }
+}
+
+void Simulation::UpdateComboTimer()
+{
+    if (player.comboTimer <= 0.0f)
+    {
+        player.comboCount = 0;
+    }
+}
+
+void Simulation::UpdateAchievements(int coinsCollected, float dt)
+{
+    auto notify = [this](AchievementMessage message)
+    {
+        achievements.lastUnlocked = ACHIEVEMENT_MESSAGES[message];
+        achievements.notificationTimer = ACHIEVEMENT_DISPLAY_TIME;
+    };
+
+    if (coinsCollected > 0 && !achievements.firstCoinUnlocked)
+    {
+        achievements.firstCoinUnlocked = true;
+        notify(FIRST_COIN_MESSAGE);
+    }
+
+    if (player.totalCoinsCollected >= 10 && !achievements.tenCoinsUnlocked)
+    {
+        achievements.tenCoinsUnlocked = true;
+        notify(TEN_COINS_MESSAGE);
+    }
+
+    if (player.bestCombo >= 5 && !achievements.comboFiveUnlocked)
+    {
+        achievements.comboFiveUnlocked = true;
+        notify(COMBO_FIVE_MESSAGE);
+    }
+
+    if (achievements.notificationTimer > 0.0f)
+    {
+        achievements.notificationTimer = std::max(0.0f, achievements.notificationTimer - dt);
+    }
+}
+
+bool Simulation::UpdateTimeTrial(float dt, bool levelCompleted)
+{
+    if (!timeTrialMode)
+    {
+        return false;
+    }
+
+    if (timeTrialActive)
+    {
+        timeTrialTimer += dt;
+    }
+
+    if (!levelCompleted)
+    {
+        return false;
+    }
+
+    if (!timeTrialActive)
+    {
+        return false;
+    }
+
+    timeTrialActive = false;
+
+    bool newRecord = false;
+    if (!hasBestTime || timeTrialTimer < bestTimeTrial)
+    {
+        bestTimeTrial = timeTrialTimer;
+        hasBestTime = true;
+        newRecord = true;
+    }
+
+    return newRecord;
+}
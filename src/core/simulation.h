@@ -0,0 +1,177 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "raylib.h"
+
+#include "player.h"
+#include "platform.h"
+#include "enemy.h"
+#include "coin.h"
+#include "collision.h"
+#include "effects.h"
+#include "entity_store.h"
+#include "input_state.h"
+#include "level.h"
+#include "level_arena.h"
+#include "lod.h"
+#include "random.h"
+#include "rewind_buffer.h"
+#include "spatial_grid.h"
+#include "weather.h"
+#include "world_stream.h"
+
+enum class GameState
+{
+    Menu,
+    Playing,
+    Paused,
+    GameOver
+};
+
+struct AchievementState
+{
+    bool firstCoinUnlocked{false};
+    bool tenCoinsUnlocked{false};
+    bool comboFiveUnlocked{false};
+    bool timeTrialClearUnlocked{false};
+    // Always one of the static messages, so copying the state never allocates.
+    const char* lastUnlocked{nullptr};
+    float notificationTimer{0.0f};
+};
+
+// How much of the level a saved state covers; see Simulation::SaveState.
+enum class SaveScope : unsigned char
+{
+    Active,
+    Level
+};
+
+constexpr float SIMULATION_STEP = 1.0f / 120.0f;
+// Static geometry buffers kept for reuse across levels: one per snapshot the
+// renderer can still be holding, plus the tile cache's and the current one.
+constexpr std::size_t STATIC_GEOMETRY_POOL_SIZE = 6;
+// How far holding rewind can scrub back.
+constexpr float REWIND_WINDOW_SECONDS = 10.0f;
+
+// Everything that advances on the fixed tick: entities, weather, achievements,
+// time trial and the menu/play/pause/game-over state machine. Owns no window,
+// audio or camera, so it can be stepped headless as fast as the CPU allows.
+class Simulation
+{
+public:
+    explicit Simulation(std::uint32_t seed = Random::DEFAULT_SEED);
+
+    void SetViewSize(Vector2 size);
+
+    // Maps compiled levels from the directory; returns how many were found.
+    // With none, every level uses the built-in layout.
+    int SetLevelDirectory(const std::string& directory);
+    void Update(const InputState& input, float dt);
+
+    std::uint32_t GetSeed() const { return rng.GetSeed(); }
+    GameState GetState() const { return state; }
+    const Player& GetPlayer() const { return player; }
+    const PlatformStore& GetPlatforms() const { return platforms; }
+    const EnemyStore& GetEnemies() const { return enemies; }
+    const std::vector<Coin>& GetCoins() const { return coins; }
+    const WorldStream& GetWorldStream() const { return worldStream; }
+    const SpatialGrid& GetPlatformGrid() const { return platformGrid; }
+    const SpatialGrid& GetEnemyGrid() const { return enemyGrid; }
+    const SpatialGrid& GetCoinGrid() const { return coinGrid; }
+    // Line of sight against the active platforms, for AI and effects. Movers
+    // out past the LOD full-rate range may be a few ticks behind. Safe from
+    // any thread that brings its own `candidates`, as long as no tick runs.
+    bool CastSegment(Vector2 from, Vector2 to, CastHit& hit, std::vector<int>& candidates) const
+    {
+        return ::CastSegment(platforms, platformGrid, from, to, hit, candidates);
+    }
+    const WeatherState& GetWeather() const { return weather; }
+    const EffectState& GetEffects() const { return effects; }
+    const AchievementState& GetAchievements() const { return achievements; }
+    int GetLevel() const { return currentLevel; }
+    const LevelLibrary& GetLevelLibrary() const { return levelLibrary; }
+    bool IsTimeTrialMode() const { return timeTrialMode; }
+    bool IsTimeTrialActive() const { return timeTrialActive; }
+    float GetTimeTrialTimer() const { return timeTrialTimer; }
+    float GetBestTimeTrial() const { return hasBestTime ? bestTimeTrial : -1.0f; }
+
+    // Bumped every time a level is (re)built; the shell watches it to restart music.
+    std::uint32_t GetLevelSerial() const { return levelSerial; }
+    const std::shared_ptr<const StaticGeometry>& GetStaticGeometry() const { return staticGeometry; }
+
+    // Everything the tick reads or writes, apart from the purely visual
+    // particles. An Active save covers the entities around the player and is
+    // only accepted back in the level it was taken in; LoadState returns
+    // false, changing nothing, for anything else. A Level save covers every
+    // entity of the level, in layout order, so it also restores after the
+    // level changed and two equal states always save to equal bytes.
+    void SaveState(std::vector<unsigned char>& out, SaveScope scope = SaveScope::Active) const;
+    bool LoadState(const std::vector<unsigned char>& data);
+
+    // Every playing tick is saved into the rewind buffer; holding rewind
+    // steps back through it one tick per tick instead of simulating.
+    // Disabling it skips the saves as well.
+    void SetRewindEnabled(bool enabled);
+    bool IsRewinding() const { return rewinding; }
+    const RewindBuffer& GetRewindBuffer() const { return rewindBuffer; }
+
+    // Moving platforms and enemies far from the player are updated less
+    // often, or not at all, and caught up exactly when they come back into
+    // range. Nothing the tick computes depends on it, saved states included.
+    void SetLodEnabled(bool enabled);
+    bool IsLodEnabled() const { return lodEnabled; }
+
+private:
+    void ResetLevel();
+    void LoadLevelLayout();
+    std::shared_ptr<StaticGeometry> TakeStaticGeometry();
+    void CaptureRewindFrame(float dt);
+    void RebuildBroadphase();
+    LodFocus GetLodFocus() const;
+    void StreamWorld(int loadBudget);
+    void HandleInputToggles(const InputState& input);
+    void UpdateComboTimer();
+    void UpdateAchievements(int coinsCollected, float dt);
+    bool UpdateTimeTrial(float dt, bool levelCompleted);
+
+    GameState state{GameState::Menu};
+    Player player{};
+    PlatformStore platforms{};
+    EnemyStore enemies{};
+    std::vector<Coin> coins{};
+    LevelLibrary levelLibrary{};
+    // Backs everything that belongs to the current level; reset on every load.
+    // Boxed so a moved Simulation keeps its containers' arena address.
+    std::unique_ptr<LevelArena> levelArena{std::make_unique<LevelArena>()};
+    WorldStream worldStream{};
+    SpatialGrid platformGrid{};
+    SpatialGrid enemyGrid{};
+    SpatialGrid coinGrid{};
+    int coinsRemaining{0};
+    float gravity{780.0f};
+    Vector2 viewSize{1600.0f, 900.0f};
+    int currentLevel{1};
+    std::uint32_t levelSerial{0};
+    std::shared_ptr<const StaticGeometry> staticGeometry{};
+    std::array<std::shared_ptr<StaticGeometry>, STATIC_GEOMETRY_POOL_SIZE> staticGeometryPool{};
+    AchievementState achievements{};
+    bool timeTrialMode{false};
+    bool timeTrialActive{false};
+    float timeTrialTimer{0.0f};
+    float bestTimeTrial{0.0f};
+    bool hasBestTime{false};
+    WeatherState weather{};
+    EffectState effects{};
+    Random rng{};
+    RewindBuffer rewindBuffer{};
+    std::vector<unsigned char> rewindFrame{};
+    std::vector<int> restoreChunks{};
+    bool rewindEnabled{true};
+    bool lodEnabled{true};
+    bool rewinding{false};
+};
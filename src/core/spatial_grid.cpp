@@ -0,0 +1,195 @@
+#include "spatial_grid.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+    std::uint64_t CellKey(int x, int y)
+    {
+        return (static_cast<std::uint64_t>(static_cast<std::uint32_t>(x)) << 32) |
+               static_cast<std::uint64_t>(static_cast<std::uint32_t>(y));
+    }
+}
+
+SpatialGrid::SpatialGrid(float size)
+    : cellSize(size),
+      inverseCellSize(1.0f / size)
+{
+}
+
+void SpatialGrid::Clear()
+{
+    // Keep the cells and their capacity: rebuilding after a chunk load then
+    // files entities without allocating.
+    for (Cell* cell : occupied)
+    {
+        cell->ids.clear();
+        cell->listed = false;
+    }
+    occupied.clear();
+    ranges.clear();
+    entityCount = 0;
+}
+
+void SpatialGrid::Reset()
+{
+    Clear();
+    for (auto& cell : cells)
+    {
+        if (spareCells.size() >= SPATIAL_GRID_SPARE_CELLS)
+        {
+            break;
+        }
+        if (cell.second.ids.capacity() > 0)
+        {
+            spareCells.push_back(std::move(cell.second.ids));
+        }
+    }
+    cells.clear();
+}
+
+void SpatialGrid::Insert(int id, const Rectangle& bounds)
+{
+    if (id < 0)
+    {
+        return;
+    }
+
+    if (static_cast<std::size_t>(id) >= ranges.size())
+    {
+        ranges.resize(static_cast<std::size_t>(id) + 1);
+    }
+
+    const CellRange range = ComputeRange(bounds);
+    if (ranges[id].maxX < ranges[id].minX)
+    {
+        ++entityCount;
+    }
+    RemoveFromCells(id, ranges[id]);
+    AddToCells(id, range);
+    ranges[id] = range;
+}
+
+void SpatialGrid::Update(int id, const Rectangle& bounds)
+{
+    if (id < 0 || static_cast<std::size_t>(id) >= ranges.size() || ranges[id].maxX < ranges[id].minX)
+    {
+        Insert(id, bounds);
+        return;
+    }
+
+    const CellRange range = ComputeRange(bounds);
+    const CellRange& current = ranges[id];
+    if (range.minX == current.minX && range.minY == current.minY &&
+        range.maxX == current.maxX && range.maxY == current.maxY)
+    {
+        return;
+    }
+
+    RemoveFromCells(id, current);
+    AddToCells(id, range);
+    ranges[id] = range;
+}
+
+void SpatialGrid::Remove(int id)
+{
+    if (id < 0 || static_cast<std::size_t>(id) >= ranges.size())
+    {
+        return;
+    }
+
+    if (ranges[id].maxX < ranges[id].minX)
+    {
+        return;
+    }
+
+    RemoveFromCells(id, ranges[id]);
+    ranges[id] = CellRange{};
+    --entityCount;
+}
+
+const std::vector<int>& SpatialGrid::Query(const Rectangle& area) const
+{
+    Query(area, queryResult);
+    return queryResult;
+}
+
+void SpatialGrid::Query(const Rectangle& area, std::vector<int>& out) const
+{
+    out.clear();
+
+    const CellRange range = ComputeRange(area);
+    for (int y = range.minY; y <= range.maxY; ++y)
+    {
+        for (int x = range.minX; x <= range.maxX; ++x)
+        {
+            const auto it = cells.find(CellKey(x, y));
+            if (it != cells.end())
+            {
+                out.insert(out.end(), it->second.ids.begin(), it->second.ids.end());
+            }
+        }
+    }
+
+    std::sort(out.begin(), out.end());
+    out.erase(std::unique(out.begin(), out.end()), out.end());
+}
+
+SpatialGrid::CellRange SpatialGrid::ComputeRange(const Rectangle& bounds) const
+{
+    CellRange range{};
+    range.minX = static_cast<int>(std::floor(bounds.x * inverseCellSize));
+    range.minY = static_cast<int>(std::floor(bounds.y * inverseCellSize));
+    range.maxX = static_cast<int>(std::floor((bounds.x + bounds.width) * inverseCellSize));
+    range.maxY = static_cast<int>(std::floor((bounds.y + bounds.height) * inverseCellSize));
+    return range;
+}
+
+void SpatialGrid::AddToCells(int id, const CellRange& range)
+{
+    for (int y = range.minY; y <= range.maxY; ++y)
+    {
+        for (int x = range.minX; x <= range.maxX; ++x)
+        {
+            const auto inserted = cells.try_emplace(CellKey(x, y));
+            Cell& cell = inserted.first->second;
+            if (inserted.second && !spareCells.empty())
+            {
+                cell.ids = std::move(spareCells.back());
+                spareCells.pop_back();
+            }
+            if (!cell.listed)
+            {
+                // Map nodes do not move on rehash, so the pointer stays valid until Reset.
+                occupied.push_back(&cell);
+                cell.listed = true;
+            }
+            cell.ids.push_back(id);
+        }
+    }
+}
+
+void SpatialGrid::RemoveFromCells(int id, const CellRange& range)
+{
+    for (int y = range.minY; y <= range.maxY; ++y)
+    {
+        for (int x = range.minX; x <= range.maxX; ++x)
+        {
+            const auto it = cells.find(CellKey(x, y));
+            if (it == cells.end())
+            {
+                continue;
+            }
+
+            // Emptied cells stay until Reset so patrolling entities do not churn the heap.
+            std::vector<int>& bucket = it->second.ids;
+            const auto found = std::find(bucket.begin(), bucket.end(), id);
+            if (found != bucket.end())
+            {
+                *found = bucket.back();
+                bucket.pop_back();
+            }
+        }
+    }
+}
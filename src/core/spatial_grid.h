@@ -0,0 +1,71 @@
+#pragma once
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "raylib.h"
+
+constexpr float BROADPHASE_CELL_SIZE = 128.0f;
+// Emptied cell buffers kept for reuse across level resets.
+constexpr std::size_t SPATIAL_GRID_SPARE_CELLS = 256;
+
+// Uniform-grid spatial hash over entity indices. Entities are keyed by their
+// index in the owning vector; each remembers the cell range it was filed under
+// so moving it only touches the hash when it actually crosses a cell border.
+class SpatialGrid
+{
+public:
+    explicit SpatialGrid(float cellSize = BROADPHASE_CELL_SIZE);
+
+    // Empties the cells filed since the last Clear; keeps every cell's buffer.
+    void Clear();
+    // Clear, then drops the cells themselves for a new level, keeping a
+    // bounded number of their buffers for the cells it files next.
+    void Reset();
+    void Insert(int id, const Rectangle& bounds);
+    void Update(int id, const Rectangle& bounds);
+    void Remove(int id);
+
+    // Indices whose cells touch the area, ascending and without duplicates so
+    // narrow-phase passes visit entities in the same order as a linear scan.
+    // The returned buffer is reused by the next query, so only one thread
+    // may query through it at a time.
+    const std::vector<int>& Query(const Rectangle& area) const;
+    // The same indices, into a buffer the caller owns. Any number of threads
+    // may query this way at once while nothing modifies the grid.
+    void Query(const Rectangle& area, std::vector<int>& out) const;
+
+    int GetEntityCount() const { return entityCount; }
+
+private:
+    // An empty range (maxX < minX) marks an index that is not filed.
+    struct CellRange
+    {
+        int minX{0};
+        int minY{0};
+        int maxX{-1};
+        int maxY{-1};
+    };
+
+    struct Cell
+    {
+        std::vector<int> ids{};
+        // Whether the cell is on `occupied`, which holds until the next Clear.
+        bool listed{false};
+    };
+
+    CellRange ComputeRange(const Rectangle& bounds) const;
+    void AddToCells(int id, const CellRange& range);
+    void RemoveFromCells(int id, const CellRange& range);
+
+    float cellSize{BROADPHASE_CELL_SIZE};
+    float inverseCellSize{1.0f / BROADPHASE_CELL_SIZE};
+    std::unordered_map<std::uint64_t, Cell> cells{};
+    // Cells filed into since the last Clear, so clearing skips the empty ones.
+    std::vector<Cell*> occupied{};
+    std::vector<std::vector<int>> spareCells{};
+    std::vector<CellRange> ranges{};
+    int entityCount{0};
+    mutable std::vector<int> queryResult{};
+};
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <cstddef>
+#include <cstring>
+#include <type_traits>
+#include <vector>
+
+// Appends values to a byte buffer one field at a time. Saved state is diffed
+// byte by byte, so whole structs are never copied in: their padding would
+// carry whatever happened to be in memory.
+class StateWriter
+{
+public:
+    explicit StateWriter(std::vector<unsigned char>& out) : out(out) {}
+
+    template <typename T>
+    void Write(const T& value)
+    {
+        static_assert(std::is_arithmetic<T>::value, "StateWriter only writes scalars");
+        unsigned char bytes[sizeof(T)];
+        std::memcpy(bytes, &value, sizeof(T));
+        out.insert(out.end(), bytes, bytes + sizeof(T));
+    }
+
+    void Write(bool value) { Write(static_cast<unsigned char>(value ? 1 : 0)); }
+
+    // Overwrites a value written earlier, `offset` bytes into the buffer.
+    template <typename T>
+    void WriteAt(std::size_t offset, const T& value)
+    {
+        static_assert(std::is_arithmetic<T>::value, "StateWriter only writes scalars");
+        std::memcpy(out.data() + offset, &value, sizeof(T));
+    }
+
+    void WriteAt(std::size_t offset, bool value) { WriteAt(offset, static_cast<unsigned char>(value ? 1 : 0)); }
+
+    std::size_t GetSize() const { return out.size(); }
+
+private:
+    std::vector<unsigned char>& out;
+};
+
+// Reads back what StateWriter wrote. Running past the end sets a sticky
+// failure and yields zeros, so callers check IsValid once at the end.
+class StateReader
+{
+public:
+    StateReader(const unsigned char* data, std::size_t size) : data(data), size(size) {}
+
+    template <typename T>
+    T Read()
+    {
+        static_assert(std::is_arithmetic<T>::value, "StateReader only reads scalars");
+        T value{};
+        if (offset + sizeof(T) > size)
+        {
+            valid = false;
+            return value;
+        }
+        std::memcpy(&value, data + offset, sizeof(T));
+        offset += sizeof(T);
+        return value;
+    }
+
+    bool ReadBool() { return Read<unsigned char>() != 0; }
+
+    bool IsValid() const { return valid; }
+    bool IsFinished() const { return offset == size; }
+
+private:
+    const unsigned char* data{nullptr};
+    std::size_t size{0};
+    std::size_t offset{0};
+    bool valid{true};
+};
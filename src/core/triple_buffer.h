@@ -0,0 +1,43 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+
+// Hands the latest value from one writer thread to one reader thread without
+// locks or waiting. The writer fills its private buffer and publishes it by
+// swapping it with the shared middle slot; the reader swaps the middle slot
+// with its own buffer whenever something newer has been published. Values the
+// reader never got round to are simply overwritten.
+template <typename T>
+class TripleBuffer
+{
+public:
+    // Writer side.
+    T& GetWriteBuffer() { return buffers[writeIndex]; }
+    void Publish()
+    {
+        writeIndex = middle.exchange(writeIndex | FRESH, std::memory_order_acq_rel) & INDEX_MASK;
+    }
+
+    // Reader side. Returns true when a newer value was swapped in.
+    bool Acquire()
+    {
+        if ((middle.load(std::memory_order_relaxed) & FRESH) == 0)
+        {
+            return false;
+        }
+
+        readIndex = middle.exchange(readIndex, std::memory_order_acq_rel) & INDEX_MASK;
+        return true;
+    }
+    const T& GetReadBuffer() const { return buffers[readIndex]; }
+
+private:
+    static constexpr int INDEX_MASK = 3;
+    static constexpr int FRESH = 4;
+
+    std::array<T, 3> buffers{};
+    int writeIndex{0};
+    std::atomic<int> middle{1};
+    int readIndex{2};
+};
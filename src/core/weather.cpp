@@ -0,0 +1,188 @@
+#include "weather.h"
+
+#include <algorithm>
+#include <limits>
+
+#include "profiler.h"
+#include "random.h"
+
+namespace
+{
+    // Drops only recycle by falling off screen, so they never age out.
+    constexpr float RAIN_DROP_LIFE = std::numeric_limits<float>::max();
+
+    ParticleEmitter MakeRainEmitter(float minX, float maxX, float minY, float maxY, float maxLength)
+    {
+        ParticleEmitter emitter{};
+        emitter.area = {minX, minY, maxX - minX, maxY - minY};
+        emitter.minVelocity = {0.0f, 380.0f};
+        emitter.maxVelocity = {0.0f, 650.0f};
+        emitter.minLife = RAIN_DROP_LIFE;
+        emitter.maxLife = RAIN_DROP_LIFE;
+        emitter.minSize = 14.0f;
+        emitter.maxSize = maxLength;
+        return emitter;
+    }
+}
+
+void InitWeather(WeatherState& weather, Random& rng, Vector2 viewSize)
+{
+    // One draw from the gameplay stream seeds the rain; it never touches it again.
+    weather.rain.Seed(rng.NextU32());
+    weather.rain.Clear();
+
+    const float width = viewSize.x;
+    const float height = viewSize.y;
+    weather.rain.Spawn(MakeRainEmitter(-width * 0.25f, width * 1.25f, -height, height, 24.0f), RAIN_DROP_COUNT);
+
+    weather.windCurrent = 0.0f;
+    weather.windTarget = 0.0f;
+    weather.baseWind = 0.0f;
+    weather.windVariance = 20.0f;
+    weather.windChangeTimer = 0.0f;
+    weather.lightningFlashTimer = 0.0f;
+    weather.lightningCooldown = 0.0f;
+    SetWeather(weather, WeatherType::Clear, rng);
+}
+
+void SetWeather(WeatherState& weather, WeatherType type, Random& rng)
+{
+    weather.current = type;
+
+    switch (type)
+    {
+        case WeatherType::Clear:
+            weather.rainIntensity = 0.0f;
+            weather.baseWind = 0.0f;
+            weather.windVariance = 35.0f;
+            weather.timeUntilChange = static_cast<float>(rng.Range(18, 28));
+            weather.lightningCooldown = 0.0f;
+            break;
+        case WeatherType::Rain:
+            weather.rainIntensity = 0.85f;
+            weather.baseWind = static_cast<float>(rng.Range(-30, 30));
+            weather.windVariance = 70.0f;
+            weather.timeUntilChange = static_cast<float>(rng.Range(24, 34));
+            weather.lightningCooldown = 0.0f;
+            break;
+        case WeatherType::Windy:
+            weather.rainIntensity = 0.0f;
+            weather.baseWind = static_cast<float>(rng.Range(-90, 90));
+            weather.windVariance = 90.0f;
+            weather.timeUntilChange = static_cast<float>(rng.Range(20, 30));
+            weather.lightningCooldown = 0.0f;
+            break;
+        case WeatherType::Storm:
+            weather.rainIntensity = 1.25f;
+            weather.baseWind = static_cast<float>(rng.Range(-110, 110));
+            weather.windVariance = 120.0f;
+            weather.timeUntilChange = static_cast<float>(rng.Range(22, 32));
+            weather.lightningCooldown = static_cast<float>(rng.Range(4, 9));
+            break;
+    }
+
+    weather.windTarget = weather.baseWind;
+    weather.windChangeTimer = static_cast<float>(rng.Range(2, 5));
+}
+
+void UpdateWeather(WeatherState& weather, Random& rng, Vector2 viewSize, float dt)
+{
+    SKYBOUND_PROFILE_SCOPE("UpdateWeather");
+
+    weather.timeUntilChange -= dt;
+    if (weather.timeUntilChange <= 0.0f)
+    {
+        int roll = rng.Range(0, 99);
+        WeatherType next = WeatherType::Clear;
+        if (roll < 40)
+        {
+            next = WeatherType::Clear;
+        }
+        else if (roll < 70)
+        {
+            next = WeatherType::Rain;
+        }
+        else if (roll < 90)
+        {
+            next = WeatherType::Windy;
+        }
+        else
+        {
+            next = WeatherType::Storm;
+        }
+
+        if (next == weather.current)
+        {
+            next = static_cast<WeatherType>((static_cast<int>(weather.current) + 1) % 4);
+        }
+
+        SetWeather(weather, next, rng);
+    }
+
+    weather.windChangeTimer -= dt;
+    if (weather.windChangeTimer <= 0.0f)
+    {
+        weather.windTarget = weather.baseWind + static_cast<float>(rng.Range(-100, 100)) * (weather.windVariance / 100.0f);
+        weather.windChangeTimer = static_cast<float>(rng.Range(2, 6));
+    }
+
+    const float windDiff = weather.windTarget - weather.windCurrent;
+    weather.windCurrent += windDiff * std::clamp(dt * 1.5f, 0.0f, 1.0f);
+
+    if (weather.lightningFlashTimer > 0.0f)
+    {
+        weather.lightningFlashTimer = std::max(0.0f, weather.lightningFlashTimer - dt);
+    }
+
+    if (weather.current == WeatherType::Storm)
+    {
+        weather.lightningCooldown -= dt;
+        if (weather.lightningCooldown <= 0.0f)
+        {
+            weather.lightningFlashTimer = LIGHTNING_FLASH_DURATION;
+            weather.lightningCooldown = static_cast<float>(rng.Range(5, 11));
+        }
+    }
+
+    const float width = viewSize.x;
+    const float height = viewSize.y;
+
+    ParticleForces forces{};
+    forces.floor = height;
+
+    if (weather.rainIntensity > 0.05f)
+    {
+        forces.drift.x = weather.windCurrent * 0.15f;
+        forces.speedScale = 1.0f + weather.rainIntensity;
+        const float wrapRange = width * 0.4f;
+        forces.wrapMinX = -wrapRange;
+        forces.wrapMaxX = width + wrapRange;
+        weather.rain.Update(forces, dt);
+        weather.rain.Spawn(MakeRainEmitter(-width * 0.25f, width * 1.25f, -height, 0.0f, 26.0f),
+                           RAIN_DROP_COUNT - weather.rain.GetCount());
+    }
+    else
+    {
+        // subtly drift raindrops even when not raining to keep animation fresh
+        forces.speedScale = 0.25f;
+        weather.rain.Update(forces, dt);
+        weather.rain.Spawn(MakeRainEmitter(0.0f, width, -height, 0.0f, 26.0f),
+                           RAIN_DROP_COUNT - weather.rain.GetCount());
+    }
+}
+
+Vector2 GetWeatherForce(const WeatherState& weather)
+{
+    Vector2 force{weather.windCurrent, 0.0f};
+
+    if (weather.current == WeatherType::Storm)
+    {
+        force.y = MAX_WEATHER_DOWNFORCE;
+    }
+    else if (weather.current == WeatherType::Rain)
+    {
+        force.y = 20.0f;
+    }
+
+    return force;
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include "raylib.h"
+
+#include "particles.h"
+
+class Random;
+
+enum class WeatherType
+{
+    Clear,
+    Rain,
+    Windy,
+    Storm
+};
+
+constexpr int RAIN_DROP_COUNT = 180;
+constexpr int RAIN_PARTICLE_CAPACITY = 4096;
+constexpr float LIGHTNING_FLASH_DURATION = 0.3f;
+// The strongest downward push any weather adds to gravity (storms).
+constexpr float MAX_WEATHER_DOWNFORCE = 50.0f;
+
+struct WeatherState
+{
+    WeatherType current{WeatherType::Clear};
+    float timeUntilChange{0.0f};
+    float rainIntensity{0.0f};
+    float baseWind{0.0f};
+    float windVariance{0.0f};
+    float windCurrent{0.0f};
+    float windTarget{0.0f};
+    float windChangeTimer{0.0f};
+    float lightningCooldown{0.0f};
+    float lightningFlashTimer{0.0f};
+    // Drops are screen-space particles; size is the streak length and the
+    // vertical velocity is the drop's base fall speed.
+    ParticleSystem rain{RAIN_PARTICLE_CAPACITY};
+};
+
+
+// Rain lives in screen space, so every entry point takes the current view size.
+void InitWeather(WeatherState& weather, Random& rng, Vector2 viewSize);
+void SetWeather(WeatherState& weather, WeatherType type, Random& rng);
+void UpdateWeather(WeatherState& weather, Random& rng, Vector2 viewSize, float dt);
+Vector2 GetWeatherForce(const WeatherState& weather);
@@ -0,0 +1,356 @@
+#include "world_stream.h"
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+namespace
+{
+    struct Span
+    {
+        float minX{0.0f};
+        float maxX{0.0f};
+    };
+
+    Span PlatformSpan(const Platform& platform)
+    {
+        const float width = platform.bounds.width;
+        return {std::min({platform.bounds.x, platform.startPosition.x, platform.endPosition.x}),
+                std::max({platform.bounds.x, platform.startPosition.x, platform.endPosition.x}) + width};
+    }
+
+    Span EnemySpan(const Enemy& enemy)
+    {
+        return {std::min(enemy.leftLimit, enemy.bounds.x),
+                std::max(enemy.rightLimit, enemy.bounds.x + enemy.bounds.width)};
+    }
+
+    Span CoinSpan(const Coin& coin)
+    {
+        return {coin.position.x - coin.radius, coin.position.x + coin.radius};
+    }
+
+    void AppendMembers(const LevelVector<int>& list, const ChunkMembers& range, LevelVector<int>& out)
+    {
+        const auto first = list.begin() + range.begin;
+        out.insert(out.end(), first, first + range.count);
+    }
+}
+
+void WorldStream::Build(LevelLayout newLayout)
+{
+    layout = std::move(newLayout);
+
+    const ArenaAllocator<int> allocator(layout.platforms.get_allocator());
+    chunks = LevelVector<WorldChunk>(allocator);
+    platformMembers = LevelVector<int>(allocator);
+    enemyMembers = LevelVector<int>(allocator);
+    coinMembers = LevelVector<int>(allocator);
+    loadedChunks = LevelVector<int>(allocator);
+    activePlatforms = LevelVector<int>(allocator);
+    activeEnemies = LevelVector<int>(allocator);
+    activeCoins = LevelVector<int>(allocator);
+    pendingLoads = LevelVector<int>(allocator);
+    firstChunk = 0;
+    widestReach = 0;
+
+    LevelVector<Span> platformSpans(allocator);
+    LevelVector<Span> enemySpans(allocator);
+    LevelVector<Span> coinSpans(allocator);
+    platformSpans.reserve(layout.platforms.size());
+    enemySpans.reserve(layout.enemies.size());
+    coinSpans.reserve(layout.coins.size());
+
+    for (const Platform& platform : layout.platforms)
+    {
+        platformSpans.push_back(PlatformSpan(platform));
+    }
+    for (const Enemy& enemy : layout.enemies)
+    {
+        enemySpans.push_back(EnemySpan(enemy));
+    }
+    for (const Coin& coin : layout.coins)
+    {
+        coinSpans.push_back(CoinSpan(coin));
+    }
+
+    bool any = false;
+    int minChunk = 0;
+    int maxChunk = 0;
+    auto extend = [&](const LevelVector<Span>& spans)
+    {
+        for (const Span& span : spans)
+        {
+            const int low = ChunkCoordinate(span.minX);
+            const int high = ChunkCoordinate(span.maxX);
+            minChunk = any ? std::min(minChunk, low) : low;
+            maxChunk = any ? std::max(maxChunk, high) : high;
+            any = true;
+        }
+    };
+    extend(platformSpans);
+    extend(enemySpans);
+    extend(coinSpans);
+
+    if (!any)
+    {
+        return;
+    }
+
+    firstChunk = minChunk;
+    chunks.resize(static_cast<std::size_t>(maxChunk - minChunk + 1));
+    for (std::size_t i = 0; i < chunks.size(); ++i)
+    {
+        chunks[i].reach = firstChunk + static_cast<int>(i);
+    }
+
+    // Counting sort into one flat list per kind: count, turn counts into
+    // offsets, then fill. Members stay in layout order within a chunk.
+    auto assign = [&](const LevelVector<Span>& spans, ChunkMembers WorldChunk::*members, LevelVector<int>& list)
+    {
+        for (const Span& span : spans)
+        {
+            WorldChunk& chunk = *FindChunk(ChunkCoordinate(span.minX));
+            (chunk.*members).count += 1;
+            chunk.reach = std::max(chunk.reach, ChunkCoordinate(span.maxX));
+        }
+
+        int begin = 0;
+        for (WorldChunk& chunk : chunks)
+        {
+            (chunk.*members).begin = begin;
+            begin += (chunk.*members).count;
+            (chunk.*members).count = 0;
+        }
+
+        list.resize(spans.size());
+        for (std::size_t i = 0; i < spans.size(); ++i)
+        {
+            ChunkMembers& range = FindChunk(ChunkCoordinate(spans[i].minX))->*members;
+            list[static_cast<std::size_t>(range.begin + range.count)] = static_cast<int>(i);
+            range.count += 1;
+        }
+    };
+    assign(platformSpans, &WorldChunk::platforms, platformMembers);
+    assign(enemySpans, &WorldChunk::enemies, enemyMembers);
+    assign(coinSpans, &WorldChunk::coins, coinMembers);
+
+    for (std::size_t i = 0; i < chunks.size(); ++i)
+    {
+        widestReach = std::max(widestReach, chunks[i].reach - (firstChunk + static_cast<int>(i)));
+    }
+
+    // Sized for the whole level, so loading chunks never grows them.
+    loadedChunks.reserve(chunks.size());
+    pendingLoads.reserve(chunks.size());
+    activePlatforms.reserve(layout.platforms.size());
+    activeEnemies.reserve(layout.enemies.size());
+    activeCoins.reserve(layout.coins.size());
+}
+
+bool WorldStream::Update(float focusX,
+                         int loadBudget,
+                         PlatformStore& platforms,
+                         EnemyStore& enemies,
+                         std::vector<Coin>& coins)
+{
+    if (chunks.empty())
+    {
+        return false;
+    }
+
+    const int focus = ChunkCoordinate(focusX);
+    const int lastChunk = firstChunk + static_cast<int>(chunks.size()) - 1;
+    bool changed = false;
+
+    for (std::size_t i = 0; i < loadedChunks.size();)
+    {
+        const int coordinate = loadedChunks[i];
+        WorldChunk& chunk = *FindChunk(coordinate);
+        if (chunk.reach < focus - CHUNK_UNLOAD_RADIUS || coordinate > focus + CHUNK_UNLOAD_RADIUS)
+        {
+            if (!changed)
+            {
+                StoreActive(platforms, enemies, coins);
+                changed = true;
+            }
+            chunk.loaded = false;
+            loadedChunks[i] = loadedChunks.back();
+            loadedChunks.pop_back();
+        }
+        else
+        {
+            ++i;
+        }
+    }
+
+    pendingLoads.clear();
+    const int scanBegin = std::max(firstChunk, focus - CHUNK_LOAD_RADIUS - widestReach);
+    const int scanEnd = std::min(lastChunk, focus + CHUNK_LOAD_RADIUS);
+    for (int coordinate = scanBegin; coordinate <= scanEnd; ++coordinate)
+    {
+        const WorldChunk& chunk = *FindChunk(coordinate);
+        const bool empty = chunk.platforms.count == 0 && chunk.enemies.count == 0 && chunk.coins.count == 0;
+        if (!chunk.loaded && !empty && chunk.reach >= focus - CHUNK_LOAD_RADIUS)
+        {
+            pendingLoads.push_back(coordinate);
+        }
+    }
+
+    if (!pendingLoads.empty() && loadBudget > 0)
+    {
+        // Nearest first, measured to the closest chunk each candidate reaches.
+        auto distance = [this, focus](int coordinate)
+        {
+            const int reach = FindChunk(coordinate)->reach;
+            if (focus < coordinate)
+            {
+                return coordinate - focus;
+            }
+            return focus > reach ? focus - reach : 0;
+        };
+        // Ties go to the left-most chunk; a plain sort keeps this allocation-free.
+        std::sort(pendingLoads.begin(), pendingLoads.end(), [&](int a, int b)
+                  {
+                      const int distanceA = distance(a);
+                      const int distanceB = distance(b);
+                      return distanceA != distanceB ? distanceA < distanceB : a < b;
+                  });
+
+        const std::size_t count = std::min(pendingLoads.size(), static_cast<std::size_t>(loadBudget));
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            if (!changed)
+            {
+                StoreActive(platforms, enemies, coins);
+                changed = true;
+            }
+            FindChunk(pendingLoads[i])->loaded = true;
+            loadedChunks.push_back(pendingLoads[i]);
+        }
+    }
+
+    if (changed)
+    {
+        RebuildActive(platforms, enemies, coins);
+    }
+
+    return changed;
+}
+
+bool WorldStream::EndRestore(const std::vector<int>& coordinates,
+                             PlatformStore& platforms,
+                             EnemyStore& enemies,
+                             std::vector<Coin>& coins)
+{
+    if (coordinates.size() > chunks.size())
+    {
+        return false;
+    }
+    for (const int coordinate : coordinates)
+    {
+        if (FindChunk(coordinate) == nullptr)
+        {
+            return false;
+        }
+    }
+
+    for (const int coordinate : loadedChunks)
+    {
+        FindChunk(coordinate)->loaded = false;
+    }
+    loadedChunks.clear();
+    for (const int coordinate : coordinates)
+    {
+        WorldChunk& chunk = *FindChunk(coordinate);
+        if (!chunk.loaded)
+        {
+            chunk.loaded = true;
+            loadedChunks.push_back(coordinate);
+        }
+    }
+
+    RebuildActive(platforms, enemies, coins);
+    return true;
+}
+
+int WorldStream::ChunkCoordinate(float x) const
+{
+    return static_cast<int>(std::floor(x / WORLD_CHUNK_WIDTH));
+}
+
+WorldChunk* WorldStream::FindChunk(int coordinate)
+{
+    const int index = coordinate - firstChunk;
+    if (index < 0 || index >= static_cast<int>(chunks.size()))
+    {
+        return nullptr;
+    }
+    return &chunks[static_cast<std::size_t>(index)];
+}
+
+void WorldStream::StoreActive(const PlatformStore& platforms,
+                              const EnemyStore& enemies,
+                              const std::vector<Coin>& coins)
+{
+    for (std::size_t i = 0; i < activePlatforms.size() && i < platforms.Size(); ++i)
+    {
+        layout.platforms[static_cast<std::size_t>(activePlatforms[i])] = platforms.Get(i);
+    }
+    for (std::size_t i = 0; i < activeEnemies.size() && i < enemies.Size(); ++i)
+    {
+        layout.enemies[static_cast<std::size_t>(activeEnemies[i])] = enemies.Get(i);
+    }
+    for (std::size_t i = 0; i < activeCoins.size() && i < coins.size(); ++i)
+    {
+        layout.coins[static_cast<std::size_t>(activeCoins[i])] = coins[i];
+    }
+}
+
+void WorldStream::RebuildActive(PlatformStore& platforms,
+                                EnemyStore& enemies,
+                                std::vector<Coin>& coins)
+{
+    activePlatforms.clear();
+    activeEnemies.clear();
+    activeCoins.clear();
+
+    for (const int coordinate : loadedChunks)
+    {
+        const WorldChunk& chunk = *FindChunk(coordinate);
+        AppendMembers(platformMembers, chunk.platforms, activePlatforms);
+        AppendMembers(enemyMembers, chunk.enemies, activeEnemies);
+        AppendMembers(coinMembers, chunk.coins, activeCoins);
+    }
+
+    // Layout order keeps collision resolution identical to an unstreamed level.
+    std::sort(activePlatforms.begin(), activePlatforms.end());
+    std::sort(activeEnemies.begin(), activeEnemies.end());
+    std::sort(activeCoins.begin(), activeCoins.end());
+
+    std::size_t moverCount = 0;
+    for (const int index : activePlatforms)
+    {
+        const Platform& platform = layout.platforms[static_cast<std::size_t>(index)];
+        moverCount += platform.moving && platform.travelTime > 0.0f ? 1 : 0;
+    }
+
+    platforms.Clear();
+    enemies.Clear();
+    coins.clear();
+    platforms.Reserve(activePlatforms.size(), moverCount);
+    enemies.Reserve(activeEnemies.size());
+
+    for (const int index : activePlatforms)
+    {
+        platforms.Push(layout.platforms[static_cast<std::size_t>(index)]);
+    }
+    for (const int index : activeEnemies)
+    {
+        enemies.Push(layout.enemies[static_cast<std::size_t>(index)]);
+    }
+    for (const int index : activeCoins)
+    {
+        coins.push_back(layout.coins[static_cast<std::size_t>(index)]);
+    }
+}
@@ -0,0 +1,101 @@
+#pragma once
+
+#include <vector>
+
+#include "raylib.h"
+
+#include "platform.h"
+#include "enemy.h"
+#include "coin.h"
+#include "entity_store.h"
+#include "level.h"
+
+constexpr float WORLD_CHUNK_WIDTH = 1024.0f;
+constexpr int CHUNK_LOAD_RADIUS = 2;
+constexpr int CHUNK_UNLOAD_RADIUS = 3;
+constexpr int CHUNK_LOADS_PER_TICK = 2;
+
+// A run of layout indices in one of the stream's flat member lists.
+struct ChunkMembers
+{
+    int begin{0};
+    int count{0};
+};
+
+// A vertical slice of the level. Entities belong to the chunk holding the left
+// edge of everything they can ever touch (platform path, patrol range), and
+// `reach` is the right-most chunk any of them can touch.
+struct WorldChunk
+{
+    ChunkMembers platforms{};
+    ChunkMembers enemies{};
+    ChunkMembers coins{};
+    int reach{0};
+    bool loaded{false};
+};
+
+// Keeps only the chunks around the focus point resident in the simulation's
+// active entity stores. Unloaded entities keep their last state in the layout and
+// resume from it when their chunk comes back.
+//
+// All per-level bookkeeping is allocated up front from the arena the layout
+// was loaded into, sized for the whole level, so streaming never allocates and
+// the next Build simply starts over on a reset arena.
+class WorldStream
+{
+public:
+    void Build(LevelLayout layout);
+
+    // Loads at most `loadBudget` chunks, nearest first, and unloads chunks past
+    // the unload radius. Returns true when the active vectors were rebuilt.
+    bool Update(float focusX,
+                int loadBudget,
+                PlatformStore& platforms,
+                EnemyStore& enemies,
+                std::vector<Coin>& coins);
+
+    const LevelLayout& GetLayout() const { return layout; }
+    int GetChunkCount() const { return static_cast<int>(chunks.size()); }
+    int GetLoadedChunkCount() const { return static_cast<int>(loadedChunks.size()); }
+    const LevelVector<int>& GetLoadedChunks() const { return loadedChunks; }
+    // Layout index of each active entity, in active-store order.
+    const LevelVector<int>& GetActivePlatforms() const { return activePlatforms; }
+    const LevelVector<int>& GetActiveEnemies() const { return activeEnemies; }
+    const LevelVector<int>& GetActiveCoins() const { return activeCoins; }
+
+    // Restoring saved state: BeginRestore hands out the layout for patching,
+    // then EndRestore loads exactly the given chunks and rebuilds the active
+    // entities from it. The active entities are deliberately not written
+    // back first: one active now but not in the saved state has been
+    // untouched in the layout since before it loaded, which is exactly its
+    // saved state. EndRestore fails, changing nothing, if a coordinate is
+    // not a chunk of this level.
+    LevelLayout& BeginRestore() { return layout; }
+    bool EndRestore(const std::vector<int>& coordinates,
+                    PlatformStore& platforms,
+                    EnemyStore& enemies,
+                    std::vector<Coin>& coins);
+
+private:
+    int ChunkCoordinate(float x) const;
+    WorldChunk* FindChunk(int coordinate);
+    void StoreActive(const PlatformStore& platforms,
+                     const EnemyStore& enemies,
+                     const std::vector<Coin>& coins);
+    void RebuildActive(PlatformStore& platforms,
+                       EnemyStore& enemies,
+                       std::vector<Coin>& coins);
+
+    LevelLayout layout{};
+    LevelVector<WorldChunk> chunks{};
+    LevelVector<int> platformMembers{};
+    LevelVector<int> enemyMembers{};
+    LevelVector<int> coinMembers{};
+    int firstChunk{0};
+    int widestReach{0};
+    LevelVector<int> loadedChunks{};
+    LevelVector<int> activePlatforms{};
+    LevelVector<int> activeEnemies{};
+    LevelVector<int> activeCoins{};
+    LevelVector<int> pendingLoads{};
+};
@@ -0,0 +1,159 @@
+#include "frame_pacer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <thread>
+
+namespace
+{
+    constexpr auto SLEEP_SLICE = std::chrono::milliseconds(1);
+    // Past this many samples the sleep estimate becomes a moving average, so it
+    // follows changes in system load.
+    constexpr int SLEEP_SAMPLE_WINDOW = 64;
+    // Vsync is taken as ignored when a full history of frames averages faster
+    // than this share of the refresh interval.
+    constexpr double VSYNC_IGNORED_RATIO = 0.75;
+
+    double ToSeconds(std::chrono::steady_clock::duration duration)
+    {
+        return std::chrono::duration<double>(duration).count();
+    }
+}
+
+void FramePacer::Configure(PacingMode newMode, double newTargetSeconds)
+{
+    mode = newMode;
+    targetSeconds = std::max(0.0, newTargetSeconds);
+    vsyncFallback = false;
+    historyCursor = 0;
+    historyCount = 0;
+    stats = FramePacerStats{};
+    Restart();
+}
+
+void FramePacer::Restart()
+{
+    started = false;
+}
+
+bool FramePacer::ShouldWait() const
+{
+    return targetSeconds > 0.0 && (mode == PacingMode::Capped || (mode == PacingMode::Vsync && vsyncFallback));
+}
+
+float FramePacer::Pace()
+{
+    const Clock::time_point now = Clock::now();
+    const Clock::duration interval = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(targetSeconds));
+
+    if (!started)
+    {
+        started = true;
+        lastFrame = now;
+        deadline = now + interval;
+        return 0.0f;
+    }
+
+    frameSleep = 0.0;
+    frameSpin = 0.0;
+    if (ShouldWait())
+    {
+        // Catch up on a slightly late frame to keep the cadence, but after a
+        // real stall start over rather than rushing out a burst of short frames.
+        if (deadline + interval < now)
+        {
+            deadline = now;
+        }
+        WaitUntil(deadline);
+        deadline += interval;
+    }
+
+    const Clock::time_point frameEnd = Clock::now();
+    const double frameSeconds = ToSeconds(frameEnd - lastFrame);
+    lastFrame = frameEnd;
+    RecordFrame(frameSeconds);
+
+    if (mode == PacingMode::Vsync && !vsyncFallback && targetSeconds > 0.0 && historyCount == FRAME_PACER_HISTORY &&
+        stats.averageMs < targetSeconds * 1000.0 * VSYNC_IGNORED_RATIO)
+    {
+        vsyncFallback = true;
+        deadline = frameEnd + interval;
+    }
+
+    return static_cast<float>(frameSeconds);
+}
+
+void FramePacer::WaitUntil(Clock::time_point target)
+{
+    for (;;)
+    {
+        const Clock::time_point now = Clock::now();
+        const double remaining = ToSeconds(target - now);
+        if (remaining <= sleepMean + 2.0 * std::sqrt(sleepVariance))
+        {
+            break;
+        }
+
+        std::this_thread::sleep_for(SLEEP_SLICE);
+        const double slept = ToSeconds(Clock::now() - now);
+        frameSleep += slept;
+        RecordSleep(slept);
+    }
+
+    const Clock::time_point spinStart = Clock::now();
+    while (Clock::now() < target)
+    {
+        std::this_thread::yield();
+    }
+    frameSpin += ToSeconds(Clock::now() - spinStart);
+}
+
+void FramePacer::RecordSleep(double seconds)
+{
+    sleepSamples = std::min(sleepSamples + 1, SLEEP_SAMPLE_WINDOW);
+    const double weight = 1.0 / static_cast<double>(sleepSamples);
+    const double delta = seconds - sleepMean;
+    sleepMean += weight * delta;
+    sleepVariance = (1.0 - weight) * (sleepVariance + weight * delta * delta);
+}
+
+void FramePacer::RecordFrame(double frameSeconds)
+{
+    frameHistory[historyCursor] = static_cast<float>(frameSeconds);
+    sleepHistory[historyCursor] = static_cast<float>(frameSleep);
+    spinHistory[historyCursor] = static_cast<float>(frameSpin);
+    historyCursor = (historyCursor + 1) % FRAME_PACER_HISTORY;
+    historyCount = std::min(historyCount + 1, FRAME_PACER_HISTORY);
+
+    double total = 0.0;
+    double slept = 0.0;
+    double spun = 0.0;
+    for (std::size_t i = 0; i < historyCount; ++i)
+    {
+        total += frameHistory[i];
+        slept += sleepHistory[i];
+        spun += spinHistory[i];
+    }
+    const double average = total / static_cast<double>(historyCount);
+
+    // Uncapped frames have no target, so their error is measured from the mean.
+    const double target = mode == PacingMode::Uncapped || targetSeconds <= 0.0 ? average : targetSeconds;
+    double variance = 0.0;
+    double error = 0.0;
+    double worstError = 0.0;
+    for (std::size_t i = 0; i < historyCount; ++i)
+    {
+        const double frame = frameHistory[i];
+        variance += (frame - average) * (frame - average);
+        error += std::fabs(frame - target);
+        worstError = std::max(worstError, std::fabs(frame - target));
+    }
+
+    const double count = static_cast<double>(historyCount);
+    stats.averageMs = average * 1000.0;
+    stats.deviationMs = std::sqrt(variance / count) * 1000.0;
+    stats.averageErrorMs = error / count * 1000.0;
+    stats.worstErrorMs = worstError * 1000.0;
+    stats.sleepFraction = total > 0.0 ? slept / total : 0.0;
+    stats.spinFraction = total > 0.0 ? spun / total : 0.0;
+}
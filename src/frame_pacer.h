@@ -0,0 +1,87 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+
+enum class PacingMode
+{
+    // Never waits; frames run as fast as the CPU and GPU allow.
+    Uncapped,
+    // Waits out the rest of every frame to hold a fixed rate.
+    Capped,
+    // Presenting blocks on the display; the pacer only steps in to cap at the
+    // refresh rate if the driver turns out to ignore the vsync request.
+    Vsync
+};
+
+constexpr std::size_t FRAME_PACER_HISTORY = 120;
+
+struct FramePacerStats
+{
+    double averageMs{0.0};
+    // Standard deviation of the frame time: the jitter players notice.
+    double deviationMs{0.0};
+    // Mean and worst distance of each frame from the target interval.
+    double averageErrorMs{0.0};
+    double worstErrorMs{0.0};
+    // Share of wall time spent asleep and busy-waiting, respectively.
+    double sleepFraction{0.0};
+    double spinFraction{0.0};
+};
+
+// Replaces raylib's SetTargetFPS wait. Sleeps in short slices while the
+// deadline is comfortably far away, then spins on a monotonic clock for the
+// last stretch, where the OS scheduler is too coarse. How close to the deadline
+// sleeping is still safe is learned from the sleeps themselves.
+class FramePacer
+{
+public:
+    // A zero interval leaves Capped and Vsync with nothing to wait for.
+    void Configure(PacingMode newMode, double targetSeconds);
+
+    // Call once per frame, between presenting the previous frame and polling
+    // input for the next, so the wait does not age the input. Waits until the
+    // frame is due and returns the seconds since the previous call returned.
+    float Pace();
+
+    // Forget the previous frame, e.g. after a stretch without pacing.
+    void Restart();
+
+    PacingMode GetMode() const { return mode; }
+    double GetTargetSeconds() const { return targetSeconds; }
+    // True once Vsync mode has found presenting does not block and caps itself.
+    bool IsVsyncFallbackActive() const { return vsyncFallback; }
+    const FramePacerStats& GetStats() const { return stats; }
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    bool ShouldWait() const;
+    void WaitUntil(Clock::time_point deadline);
+    void RecordSleep(double seconds);
+    void RecordFrame(double frameSeconds);
+
+    PacingMode mode{PacingMode::Capped};
+    double targetSeconds{1.0 / 60.0};
+    bool vsyncFallback{false};
+
+    bool started{false};
+    Clock::time_point lastFrame{};
+    Clock::time_point deadline{};
+
+    // Running mean and variance of how long a 1 ms sleep really takes;
+    // sleeping stops once the deadline is within mean + 2 sigma.
+    double sleepMean{0.002};
+    double sleepVariance{0.0};
+    int sleepSamples{0};
+
+    std::array<float, FRAME_PACER_HISTORY> frameHistory{};
+    std::array<float, FRAME_PACER_HISTORY> sleepHistory{};
+    std::array<float, FRAME_PACER_HISTORY> spinHistory{};
+    std::size_t historyCursor{0};
+    std::size_t historyCount{0};
+    double frameSleep{0.0};
+    double frameSpin{0.0};
+    FramePacerStats stats{};
+};
@@ -1,10 +1,12 @@
 #include "game.h"
 
 #include <algorithm>
-#include <cmath>
 #include <cstddef>
-#include <limits>
+#include <string>
+#include <utility>
 
+#include "geometry.h"
+#include "profiler.h"
 #include "ui.h"
 
 namespace
@@ -14,22 +16,70 @@ namespace
     constexpr Color PLAYER_COLOR{221, 161, 94, 255};
     constexpr Color ENEMY_COLOR{191, 97, 106, 255};
     constexpr Color COIN_COLOR{229, 192, 123, 255};
+    constexpr Color DUST_COLOR{196, 176, 140, 255};
+    constexpr Color SPARKLE_COLOR{255, 236, 150, 255};
+    constexpr Color HIT_COLOR{240, 96, 96, 255};
 
     constexpr Color HIGH_CONTRAST_BG{10, 10, 10, 255};
     constexpr Color HIGH_CONTRAST_PLATFORM{225, 225, 225, 255};
     constexpr Color HIGH_CONTRAST_PLAYER{255, 230, 0, 255};
     constexpr Color HIGH_CONTRAST_ENEMY{255, 64, 64, 255};
     constexpr Color HIGH_CONTRAST_COIN{255, 200, 0, 255};
+    constexpr Color HIGH_CONTRAST_DUST{200, 200, 200, 255};
+    constexpr Color HIGH_CONTRAST_SPARKLE{255, 255, 120, 255};
+    constexpr Color HIGH_CONTRAST_HIT{255, 64, 64, 255};
 
-    constexpr float ACHIEVEMENT_DISPLAY_TIME = 3.5f;
-    constexpr float FIXED_STEP = 1.0f / 120.0f;
-    constexpr int RAIN_DROP_COUNT = 180;
-    constexpr float LIGHTNING_FLASH_DURATION = 0.3f;
+    // Wall time fast replay simulates between progress frames.
+    constexpr double FAST_REPLAY_FRAME_BUDGET = 0.1;
+
+    // Optional; the game stays silent if the file is not there.
+    constexpr const char* BACKGROUND_MUSIC_ASSET = "audio/background.ogg";
+
+    // Next to the executable in a build tree, or the installed share directory.
+    std::string FindAssetRoot()
+    {
+        const std::string applicationDirectory = GetApplicationDirectory();
+        const std::string installed = applicationDirectory + "../share/SkyBound/assets";
+        if (!DirectoryExists((applicationDirectory + "assets").c_str()) && DirectoryExists(installed.c_str()))
+        {
+            return installed;
+        }
+        return applicationDirectory + "assets";
+    }
+
+    const char* DescribePacing(const FramePacer& pacer)
+    {
+        switch (pacer.GetMode())
+        {
+            case PacingMode::Uncapped:
+                return "uncapped";
+            case PacingMode::Capped:
+                return "capped";
+            case PacingMode::Vsync:
+                return pacer.IsVsyncFallbackActive() ? "vsync ignored, capped" : "vsync";
+        }
+        return "";
+    }
+
+    // World-space rectangle the camera shows; rotation is always zero here.
+    Rectangle GetCameraViewRect(const Camera2D& camera, int screenWidth, int screenHeight)
+    {
+        const float inverseZoom = 1.0f / camera.zoom;
+        return {camera.target.x - camera.offset.x * inverseZoom,
+                camera.target.y - camera.offset.y * inverseZoom,
+                static_cast<float>(screenWidth) * inverseZoom,
+                static_cast<float>(screenHeight) * inverseZoom};
+    }
 }
 
-Game::Game()
+bool IsSupportedTickRate(int ticksPerSecond)
+{
+    return std::find(SUPPORTED_TICK_RATES.begin(), SUPPORTED_TICK_RATES.end(), ticksPerSecond) != SUPPORTED_TICK_RATES.end();
+}
+
+Game::Game(LaunchOptions options)
+    : launchOptions(std::move(options))
 {
-    bestTimeTrial = std::numeric_limits<float>::infinity();
 }
 
 Game::~Game()
@@ -39,35 +89,100 @@ Game::~Game()
 
 void Game::Init()
 {
-    SetConfigFlags(FLAG_WINDOW_RESIZABLE);
+    const bool vsync = launchOptions.pacing == PacingMode::Vsync;
+    SetConfigFlags(FLAG_WINDOW_RESIZABLE | (vsync ? FLAG_VSYNC_HINT : 0));
     InitWindow(screenWidth, screenHeight, "SkyBound");
     InitAudioDevice();
-    SetTargetFPS(60);
+
+    // Pacing is ours rather than raylib's; SetTargetFPS stays at its uncapped default.
+    int pacedRate = launchOptions.fpsCap;
+    if (vsync)
+    {
+        const int refreshRate = GetMonitorRefreshRate(GetCurrentMonitor());
+        pacedRate = refreshRate > 0 ? refreshRate : FALLBACK_REFRESH_RATE;
+    }
+    framePacer.Configure(launchOptions.pacing, pacedRate > 0 ? 1.0 / static_cast<double>(pacedRate) : 0.0);
 
     inputBindings = MakeDefaultBindings();
     InitParallax();
     UpdateParallaxPalette();
-    InitWeather();
+    simulationHost.Configure(1.0f / static_cast<float>(launchOptions.tickRate), launchOptions.maxSubsteps);
+    StartReplay();
+    Simulation& simulation = simulationHost.GetSimulation();
+    simulation.SetViewSize({static_cast<float>(screenWidth), static_cast<float>(screenHeight)});
+    simulation.SetLevelDirectory(std::string(GetApplicationDirectory()) + "levels");
+    if (!launchOptions.recordPath.empty())
+    {
+        simulationHost.StartRecording();
+    }
+
+    // Registers this thread first, so its tree is the one that owns the frame.
+    FrameProfiler& profiler = FrameProfiler::Get();
+    profiler.SetThreadName("Main");
+    if (!launchOptions.tracePath.empty())
+    {
+#if SKYBOUND_PROFILER_ENABLED
+        if (!profiler.StartTrace(launchOptions.tracePath))
+        {
+            TraceLog(LOG_WARNING, "PROFILER: Could not open %s", launchOptions.tracePath.c_str());
+        }
+#else
+        TraceLog(LOG_WARNING, "PROFILER: Not compiled into this build; --trace ignored");
+#endif
+    }
 
     camera.target = {0.0f, 0.0f};
     camera.offset = {static_cast<float>(screenWidth) / 2.0f, static_cast<float>(screenHeight) / 2.0f};
     camera.zoom = 1.0f;
     camera.rotation = 0.0f;
 
-    ResetLevel();
+    musicStarted = false;
+    musicLevelSerial = simulation.GetLevelSerial();
+    musicFeeder.Start();
 
-    musicLoaded = false;
+    const std::string assetRoot = FindAssetRoot();
+    assets.Start(assetRoot, DEFAULT_ASSET_LOADER_THREADS, DEFAULT_ASSET_MEMORY_BUDGET);
+    if (FileExists((assetRoot + "/" + BACKGROUND_MUSIC_ASSET).c_str()))
+    {
+        musicAsset = assets.Acquire(BACKGROUND_MUSIC_ASSET, AssetType::Music);
+    }
+
+    JobSystem::Get().Start(launchOptions.workerThreads, launchOptions.deterministicJobs);
+
+    // Fast replay interleaves its own progress frames, so it stays on this thread.
+    if (!launchOptions.singleThreaded && !launchOptions.fastReplay)
+    {
+        simulationHost.Start();
+    }
 }
 
 void Game::Shutdown()
 {
-    if (musicLoaded)
+    simulationHost.Stop();
+    JobSystem::Get().Stop();
+    FrameProfiler::Get().StopTrace();
+
+    ReplayRecorder& recorder = simulationHost.GetRecorder();
+    if (recorder.IsRecording())
     {
-        StopMusicStream(backgroundMusic);
-        UnloadMusicStream(backgroundMusic);
-        musicLoaded = false;
+        if (recorder.Save(launchOptions.recordPath))
+        {
+            TraceLog(LOG_INFO, "REPLAY: Recorded %u ticks to %s", recorder.GetTickCount(), launchOptions.recordPath.c_str());
+        }
+        else
+        {
+            TraceLog(LOG_WARNING, "REPLAY: Could not write %s", launchOptions.recordPath.c_str());
+        }
+        recorder = ReplayRecorder{};
     }
 
+    // The feeder stops the stream before the asset manager unloads it.
+    musicFeeder.Stop();
+    musicStarted = false;
+    assets.Release(musicAsset);
+    musicAsset = {};
+    assets.Stop();
+
     if (IsAudioDeviceReady())
     {
         CloseAudioDevice();
@@ -75,6 +190,8 @@ void Game::Shutdown()
 
     if (IsWindowReady())
     {
+        hud.Unload();
+        staticTiles.Unload();
         CloseWindow();
     }
 }
@@ -83,204 +200,230 @@ void Game::Run()
 {
     Init();
 
-    float timeAccumulator = 0.0f;
-
     while (!WindowShouldClose())
     {
-        const float dt = GetFrameTime();
-        timeAccumulator += dt;
-
-        inputState = PollInputState(inputBindings);
-
-        while (timeAccumulator >= FIXED_STEP)
+        if (launchOptions.fastReplay && simulationHost.IsReplaying())
         {
-            Update(FIXED_STEP);
-            timeAccumulator -= FIXED_STEP;
+            RunFastReplay();
+            PollFrameInput();
+            framePacer.Restart();
+            continue;
         }
 
-        UpdateCamera();
-        Draw();
-
-        if (musicLoaded)
+        // The previous frame has been presented; waiting before the poll
+        // rather than after keeps the input the simulation sees fresh.
+        const float dt = framePacer.Pace();
+        PollFrameInput();
+
+        // Shell toggles act on live input straight away; the rest is for the simulation.
+        const InputState input = PollInputState(inputBindings);
+        HandleInputToggles(input);
+        simulationHost.Submit({input,
+                               {static_cast<float>(screenWidth), static_cast<float>(screenHeight)},
+                               GetCameraViewRect(camera, screenWidth, screenHeight)});
+        if (!simulationHost.IsThreaded())
         {
-            UpdateMusicStream(backgroundMusic);
+            simulationHost.Advance(dt);
         }
+
+        PresentFrame(simulationHost.AcquireSnapshot());
     }
 
     Shutdown();
 }
 
-void Game::Update(float dt)
+void Game::PresentFrame(const RenderSnapshot& frame)
 {
-    UpdateWeather(dt);
-    HandleInputToggles();
+    assets.Update(DEFAULT_ASSET_UPLOAD_SECONDS);
+    SyncMusicWithLevel(frame);
+    UpdateCamera(frame);
+    Draw(frame);
+#if SKYBOUND_CUSTOM_FRAME_CONTROL
+    // raylib's EndDrawing leaves presenting and polling to us.
+    SwapScreenBuffer();
+#endif
+
+    FrameProfiler::Get().EndFrame();
+}
 
-    switch (state)
-    {
-        case GameState::Menu:
-        {
-            if (inputState.jumpPressed || IsKeyPressed(KEY_ENTER))
-            {
-                state = GameState::Playing;
-                ResetLevel();
-                timeTrialActive = timeTrialMode;
-                timeTrialTimer = 0.0f;
-            }
-            break;
-        }
-        case GameState::Playing:
-        {
-            if (inputState.pausePressed)
-            {
-                state = GameState::Paused;
-                break;
-            }
+void Game::PollFrameInput()
+{
+#if SKYBOUND_CUSTOM_FRAME_CONTROL
+    PollInputEvents();
+#endif
+}
 
-            UpdatePlatforms(platforms, dt);
+void Game::StartReplay()
+{
+    if (launchOptions.replayPath.empty())
+    {
+        return;
+    }
 
-            ApplyPlayerInput(player, inputState, dt);
-            const Vector2 weatherForce = GetWeatherForce();
-            UpdatePlayerPhysics(player, gravity, dt, weatherForce);
-            ResolvePlayerPlatforms(player, platforms);
+    const float requestedStep = simulationHost.GetStep();
+    if (!simulationHost.LoadReplay(launchOptions.replayPath))
+    {
+        TraceLog(LOG_WARNING, "REPLAY: Could not load %s", launchOptions.replayPath.c_str());
+        return;
+    }
 
-            UpdateEnemies(enemies, player, dt);
-            const int coinsCollected = CheckCoinCollection(coins, player);
-            UpdateAchievements(coinsCollected, dt);
-            UpdateComboTimer();
+    // Ticks only reproduce at the step they were recorded with.
+    if (simulationHost.GetStep() != requestedStep)
+    {
+        TraceLog(LOG_INFO, "REPLAY: %s was recorded at %.0f Hz; switching tick rate", launchOptions.replayPath.c_str(), 1.0f / simulationHost.GetStep());
+    }
 
-            const bool allCollected = std::all_of(coins.begin(), coins.end(), [](const Coin& coin) { return coin.collected; });
-            const bool newBestTime = UpdateTimeTrial(dt, allCollected);
+    TraceLog(LOG_INFO, "REPLAY: Playing %u ticks from %s", simulationHost.GetReplay().GetTickCount(), launchOptions.replayPath.c_str());
+}
 
-            if (newBestTime)
-            {
-                achievements.timeTrialClearUnlocked = true;
-                achievements.lastUnlocked = "Speedrunner: New time trial record!";
-                achievements.notificationTimer = ACHIEVEMENT_DISPLAY_TIME;
-            }
+void Game::RunFastReplay()
+{
+    const double frameStart = GetTime();
 
-            if (allCollected)
-            {
-                currentLevel += 1;
-                player.lives = std::min(player.lives + 1, 5);
-                ResetLevel();
-                timeTrialActive = timeTrialMode;
-                timeTrialTimer = 0.0f;
-            }
+    replayStats.ticks += simulationHost.RunReplayFor(FAST_REPLAY_FRAME_BUDGET);
+    replayStats.seconds += GetTime() - frameStart;
+    if (!simulationHost.IsReplaying())
+    {
+        TraceLog(LOG_INFO,
+                 "REPLAY: %llu ticks in %.3f s (%.1f ns/tick)",
+                 static_cast<unsigned long long>(replayStats.ticks),
+                 replayStats.seconds,
+                 replayStats.ticks > 0 ? replayStats.seconds * 1.0e9 / static_cast<double>(replayStats.ticks) : 0.0);
+    }
 
-            if (player.lives <= 0)
-            {
-                state = GameState::GameOver;
-            }
+    // One progress frame per budget keeps the window responsive.
+    PresentFrame(simulationHost.AcquireSnapshot());
+}
 
-            break;
-        }
-        case GameState::Paused:
-        {
-            if (inputState.pausePressed)
-            {
-                state = GameState::Playing;
-            }
-            break;
-        }
-        case GameState::GameOver:
-        {
-            if (inputState.restartPressed)
-            {
-                currentLevel = 1;
-                ResetLevel();
-                state = GameState::Playing;
-                timeTrialActive = timeTrialMode;
-                timeTrialTimer = 0.0f;
-            }
-            else if (inputState.jumpPressed)
-            {
-                state = GameState::Menu;
-            }
-            break;
-        }
-    }
+float Game::GetRenderAlpha(const RenderSnapshot& frame) const
+{
+    // Nothing advances outside play, so the previous tick's positions go stale.
+    return frame.state == GameState::Playing ? simulationHost.GetRenderAlpha(frame) : 1.0f;
 }
 
-void Game::Draw() const
+void Game::Draw(const RenderSnapshot& frame) const
 {
+    primitiveBatch.BeginFrame();
+
     BeginDrawing();
     ClearBackground(accessibility.highContrast ? HIGH_CONTRAST_BG : BACKGROUND_COLOR);
 
-    switch (state)
+    switch (frame.state)
     {
         case GameState::Menu:
-            DrawMenu();
+            DrawMenu(frame);
             break;
         case GameState::Playing:
-            DrawGameplay();
+            DrawGameplay(frame);
             break;
         case GameState::Paused:
-            DrawGameplay();
+            DrawGameplay(frame);
             DrawPause();
             break;
         case GameState::GameOver:
-            DrawGameplay();
-            DrawGameOver();
+            DrawGameplay(frame);
+            DrawGameOver(frame);
             break;
     }
 
     if (showSettingsOverlay)
     {
-        DrawSettingsOverlay();
+        DrawSettingsOverlay(frame);
+    }
+
+    if (showProfilerOverlay)
+    {
+        DrawProfilerOverlay();
     }
 
     EndDrawing();
 }
 
-void Game::DrawGameplay() const
+void Game::DrawGameplay(const RenderSnapshot& frame) const
 {
+    SKYBOUND_PROFILE_SCOPE("DrawGameplay");
+
     DrawBackground();
 
+    // The snapshot only carries entities near the view; this trims it to the screen.
+    const Rectangle view = GetCameraViewRect(camera, screenWidth, screenHeight);
+    const float alpha = GetRenderAlpha(frame);
+    int drawn = 0;
+
+    const Color platformColor = accessibility.highContrast ? HIGH_CONTRAST_PLATFORM : PLATFORM_COLOR;
+    staticTiles.SetGeometry(frame.staticGeometry, platformColor);
+    staticTiles.Prepare(view);
+
     BeginMode2D(camera);
 
-    for (const Platform& platform : platforms)
+    staticTiles.Draw(view, primitiveBatch);
+    for (const SnapshotRect& platform : frame.platforms)
     {
-        const Color color = accessibility.highContrast ? HIGH_CONTRAST_PLATFORM : PLATFORM_COLOR;
-        DrawRectangleRec(platform.bounds, color);
+        const Rectangle bounds = platform.Interpolate(alpha);
+        if (RectsOverlap(bounds, view))
+        {
+            primitiveBatch.PushRectangle(bounds, platformColor);
+            ++drawn;
+        }
     }
 
-    for (const Coin& coin : coins)
+    const Color coinColor = accessibility.highContrast ? HIGH_CONTRAST_COIN : COIN_COLOR;
+    for (const SnapshotCoin& coin : frame.coins)
     {
-        if (!coin.collected)
+        const Rectangle bounds{coin.position.x - coin.radius, coin.position.y - coin.radius, coin.radius * 2.0f, coin.radius * 2.0f};
+        if (RectsOverlap(bounds, view))
         {
-            const Color color = accessibility.highContrast ? HIGH_CONTRAST_COIN : COIN_COLOR;
-            DrawCircleV(coin.position, coin.radius, color);
+            primitiveBatch.PushCircle(coin.position, coin.radius, coinColor);
+            ++drawn;
         }
     }
 
-    for (const Enemy& enemy : enemies)
+    const Color enemyColor = accessibility.highContrast ? HIGH_CONTRAST_ENEMY : ENEMY_COLOR;
+    for (const SnapshotRect& enemy : frame.enemies)
     {
-        const Color color = accessibility.highContrast ? HIGH_CONTRAST_ENEMY : ENEMY_COLOR;
-        DrawRectangleRec(enemy.bounds, color);
+        const Rectangle bounds = enemy.Interpolate(alpha);
+        if (RectsOverlap(bounds, view))
+        {
+            primitiveBatch.PushRectangle(bounds, enemyColor);
+            ++drawn;
+        }
     }
 
+    const bool highContrast = accessibility.highContrast;
+    DrawParticles(frame.dust, view, highContrast ? HIGH_CONTRAST_DUST : DUST_COLOR);
+    DrawParticles(frame.sparkle, view, highContrast ? HIGH_CONTRAST_SPARKLE : SPARKLE_COLOR);
+    DrawParticles(frame.hit, view, highContrast ? HIGH_CONTRAST_HIT : HIT_COLOR);
+
+    cullingStats.drawn = drawn;
+    cullingStats.culled = frame.broadphaseEntities - drawn;
+
+    const Player& player = frame.player;
     const Color playerColor = accessibility.highContrast ? HIGH_CONTRAST_PLAYER : PLAYER_COLOR;
-    DrawRectangleV(player.position, {player.width, player.height}, playerColor);
+    const Vector2 playerPosition = GetInterpolatedPlayerPosition(player, alpha);
+    primitiveBatch.PushRectangle({playerPosition.x, playerPosition.y, player.width, player.height}, playerColor);
 
+    primitiveBatch.Flush();
     EndMode2D();
 
-    DrawWeather();
-
-    DrawHUD(player,
-            currentLevel,
-            timeTrialMode,
-            timeTrialActive,
-            timeTrialTimer,
-            hasBestTime ? bestTimeTrial : -1.0f,
-            accessibility,
-            achievements,
-            weather);
+    DrawWeather(frame);
+
+    hud.Draw(player,
+             frame.level,
+             frame.timeTrialMode,
+             frame.timeTrialActive,
+             frame.timeTrialTimer,
+             frame.bestTimeTrial,
+             accessibility,
+             frame.achievements,
+             frame.weather,
+             frame.rewinding,
+             static_cast<float>(frame.rewindFrames) * frame.tickStep);
 }
 
-void Game::DrawMenu() const
+void Game::DrawMenu(const RenderSnapshot& frame) const
 {
-    DrawWeather();
-    DrawMenuScreen({static_cast<float>(screenWidth), static_cast<float>(screenHeight)}, timeTrialMode);
+    DrawWeather(frame);
+    DrawMenuScreen({static_cast<float>(screenWidth), static_cast<float>(screenHeight)}, frame.timeTrialMode);
 }
 
 void Game::DrawPause() const
@@ -288,12 +431,14 @@ void Game::DrawPause() const
     DrawPauseScreen({static_cast<float>(screenWidth), static_cast<float>(screenHeight)});
 }
 
-void Game::DrawGameOver() const
+void Game::DrawGameOver(const RenderSnapshot& frame) const
 {
-    DrawGameOverScreen({static_cast<float>(screenWidth), static_cast<float>(screenHeight)}, player.score, player.bestCombo);
+    DrawGameOverScreen({static_cast<float>(screenWidth), static_cast<float>(screenHeight)},
+                       frame.player.score,
+                       frame.player.bestCombo);
 }
 
-void Game::DrawSettingsOverlay() const
+void Game::DrawSettingsOverlay(const RenderSnapshot& frame) const
 {
     const int margin = 48;
     const Rectangle panel{static_cast<float>(margin),
@@ -322,14 +467,14 @@ void Game::DrawSettingsOverlay() const
              RAYWHITE);
     textY += fontSize + 20;
 
-    DrawText(TextFormat("Key Layout [F5]: %s", accessibility.alternativeBindings ? "ALT (J/L/I/O/U)" : "DEFAULT (A/D/SPACE/P/R)"),
+    DrawText(TextFormat("Key Layout [F5]: %s", accessibility.alternativeBindings ? "ALT (J/L/I/O/U/K)" : "DEFAULT (A/D/SPACE/P/R/Q)"),
              margin + 40,
              textY,
              fontSize,
              RAYWHITE);
     textY += fontSize + 20;
 
-    DrawText(TextFormat("Time Trial Mode [T]: %s", timeTrialMode ? "ON" : "OFF"),
+    DrawText(TextFormat("Time Trial Mode [T]: %s", frame.timeTrialMode ? "ON" : "OFF"),
              margin + 40,
              textY,
              fontSize,
@@ -337,21 +482,206 @@ void Game::DrawSettingsOverlay() const
     textY += fontSize + 30;
 
     DrawText("Press O to close settings.", margin + 40, textY, fontSize - 8, LIGHTGRAY);
+    textY += fontSize + 10;
+
+    const PrimitiveBatchStats& batchStats = primitiveBatch.GetLastFrameStats();
+    DrawText(TextFormat("Batched: %d draws, %d shapes, %d vertices",
+                        batchStats.drawCalls,
+                        batchStats.primitives,
+                        batchStats.vertices),
+             margin + 40,
+             textY,
+             fontSize - 12,
+             GRAY);
+    textY += fontSize - 4;
+
+    DrawText(TextFormat("Culling: %d drawn, %d culled", cullingStats.drawn, cullingStats.culled),
+             margin + 40,
+             textY,
+             fontSize - 12,
+             GRAY);
+    textY += fontSize - 4;
+
+    const StaticTileStats& tileStats = staticTiles.GetLastFrameStats();
+    DrawText(TextFormat("Static tiles: %d drawn, %d baked, %d resident, %d live rects",
+                        tileStats.tilesDrawn,
+                        tileStats.tilesBaked,
+                        tileStats.residentTiles,
+                        tileStats.liveRectangles),
+             margin + 40,
+             textY,
+             fontSize - 12,
+             GRAY);
+    textY += fontSize - 4;
+
+    DrawText(TextFormat("Music feeder: %.1f ms worst refill gap", musicFeeder.GetWorstFeedGapMs()),
+             margin + 40,
+             textY,
+             fontSize - 12,
+             GRAY);
+    textY += fontSize - 4;
+
+    const AssetStats& assetStats = assets.GetStats();
+    DrawText(TextFormat("Assets: %d ready, %d loading, %d cached, %.1f MiB, %d uploads last frame",
+                        assetStats.ready,
+                        assetStats.loading,
+                        assetStats.unreferenced,
+                        static_cast<double>(assetStats.residentBytes) / (1024.0 * 1024.0),
+                        assetStats.uploadsLastFrame),
+             margin + 40,
+             textY,
+             fontSize - 12,
+             GRAY);
+    textY += fontSize - 4;
+
+    const HudStats& hudStats = hud.GetLastFrameStats();
+    DrawText(TextFormat("HUD: %d lines formatted, %d layer redraws", hudStats.formats, hudStats.layerRebuilds),
+             margin + 40,
+             textY,
+             fontSize - 12,
+             GRAY);
+    textY += fontSize - 4;
+
+    DrawText(TextFormat("Tick: %.0f Hz, %d steps last frame, %.2f s dilated",
+                        1.0f / frame.tickStep,
+                        frame.substeps,
+                        frame.dilatedSeconds),
+             margin + 40,
+             textY,
+             fontSize - 12,
+             GRAY);
+    textY += fontSize - 4;
+
+    const FramePacerStats& pacing = framePacer.GetStats();
+    DrawText(TextFormat("Pacing: %s, %.2f +/- %.2f ms, error %.2f avg / %.2f worst, %.0f%% asleep, %.0f%% spinning",
+                        DescribePacing(framePacer),
+                        pacing.averageMs,
+                        pacing.deviationMs,
+                        pacing.averageErrorMs,
+                        pacing.worstErrorMs,
+                        pacing.sleepFraction * 100.0,
+                        pacing.spinFraction * 100.0),
+             margin + 40,
+             textY,
+             fontSize - 12,
+             GRAY);
+    textY += fontSize - 4;
+
+    DrawText(TextFormat("Particles: %d rain, %d effects",
+                        frame.weather.rain.GetCount(),
+                        frame.dust.GetCount() + frame.sparkle.GetCount() + frame.hit.GetCount()),
+             margin + 40,
+             textY,
+             fontSize - 12,
+             GRAY);
+}
+
+void Game::DrawProfilerOverlay() const
+{
+    const int fontSize = accessibility.largeHud ? 20 : 16;
+    const int lineHeight = fontSize + 4;
+    const int panelWidth = 520;
+    const int x = screenWidth - panelWidth - 20;
+    int y = 20;
+
+#if SKYBOUND_PROFILER_ENABLED
+    FrameProfiler::Get().GetThreads(profilerThreads);
+    std::size_t lines = 1;
+    for (const ProfileThreadSnapshot& thread : profilerThreads)
+    {
+        lines += thread.nodes.size() + 1;
+    }
+    DrawRectangle(x - 10, y - 10, panelWidth + 20, static_cast<int>(lines) * lineHeight + 20, Color{0, 0, 0, 190});
+    DrawText(TextFormat("Profiler (avg / peak over %d frames)%s",
+                        PROFILER_HISTORY_FRAMES,
+                        FrameProfiler::Get().IsTracing() ? " - tracing" : ""),
+             x,
+             y,
+             fontSize,
+             RAYWHITE);
+    y += lineHeight;
+
+    for (const ProfileThreadSnapshot& thread : profilerThreads)
+    {
+        DrawText(thread.name.c_str(), x, y, fontSize, SKYBLUE);
+        y += lineHeight;
+
+        // Depth-first so children sit under their parent.
+        const std::vector<ProfileNode>& nodes = thread.nodes;
+        int index = 0;
+        while (index >= 0)
+        {
+            const ProfileNode& node = nodes[static_cast<std::size_t>(index)];
+            DrawText(TextFormat("%*s%s", node.depth * 2 + 2, "", node.name), x, y, fontSize, LIGHTGRAY);
+            DrawText(TextFormat("%6.2f / %6.2f ms  x%d", node.averageMs, node.peakMs, node.lastCalls),
+                     x + panelWidth - 230,
+                     y,
+                     fontSize,
+                     LIGHTGRAY);
+            y += lineHeight;
+
+            if (node.firstChild >= 0)
+            {
+                index = node.firstChild;
+                continue;
+            }
+            while (index >= 0 && nodes[static_cast<std::size_t>(index)].nextSibling < 0)
+            {
+                index = nodes[static_cast<std::size_t>(index)].parent;
+            }
+            if (index >= 0)
+            {
+                index = nodes[static_cast<std::size_t>(index)].nextSibling;
+            }
+        }
+    }
+#else
+    DrawRectangle(x - 10, y - 10, panelWidth + 20, lineHeight + 20, Color{0, 0, 0, 190});
+    DrawText("Profiler not compiled into this build", x, y, fontSize, LIGHTGRAY);
+#endif
+}
+
+void Game::DrawParticles(const ParticleSnapshot& particles, const Rectangle& view, Color color) const
+{
+    for (int i = 0; i < particles.GetCount(); ++i)
+    {
+        const std::size_t index = static_cast<std::size_t>(i);
+        const float size = particles.size[index];
+        const Rectangle bounds{particles.x[index] - size * 0.5f, particles.y[index] - size * 0.5f, size, size};
+        if (!RectsOverlap(bounds, view))
+        {
+            continue;
+        }
+
+        Color faded = color;
+        faded.a = static_cast<unsigned char>(static_cast<float>(color.a) * particles.fade[index]);
+        primitiveBatch.PushRectangle(bounds, faded);
+    }
 }
 
-void Game::DrawWeather() const
+void Game::DrawWeather(const RenderSnapshot& frame) const
 {
-    if (weather.rainIntensity > 0.05f && !weather.rainDrops.empty())
+    SKYBOUND_PROFILE_SCOPE("DrawWeather");
+
+    const WeatherSnapshot& weather = frame.weather;
+    const GameState state = frame.state;
+
+    if (weather.rainIntensity > 0.05f && weather.rain.GetCount() > 0)
     {
         const unsigned char alpha = static_cast<unsigned char>(std::clamp(140.0f + weather.rainIntensity * 60.0f, 80.0f, 220.0f));
         const Color rainColor = accessibility.highContrast ? Color{200, 200, 200, alpha} : Color{120, 160, 255, alpha};
         const float windOffset = weather.windCurrent * 0.02f;
-        for (const RainDrop& drop : weather.rainDrops)
+        const float thickness = accessibility.largeHud ? 2.0f : 1.5f;
+        const ParticleSnapshot& rain = weather.rain;
+        for (int i = 0; i < rain.GetCount(); ++i)
         {
-            const Vector2 start{drop.position.x, drop.position.y};
-            const Vector2 end{drop.position.x + windOffset * drop.length, drop.position.y + drop.length};
-            DrawLineEx(start, end, accessibility.largeHud ? 2.0f : 1.5f, rainColor);
+            const std::size_t index = static_cast<std::size_t>(i);
+            const float length = rain.size[index];
+            const Vector2 start{rain.x[index], rain.y[index]};
+            const Vector2 end{start.x + windOffset * length, start.y + length};
+            primitiveBatch.PushLine(start, end, thickness, rainColor);
         }
+        primitiveBatch.Flush();
     }
 
     if (weather.lightningFlashTimer > 0.0f)
@@ -379,71 +709,29 @@ void Game::DrawWeather() const
 
 void Game::DrawBackground() const
 {
-    const float cameraX = camera.target.x;
     const float cameraY = camera.target.y;
 
+    // Each layer is a flat band as wide as the screen, so horizontal scrolling
+    // never changes what it covers: one screen-wide quad per layer is exactly
+    // what side-by-side scrolled copies would draw.
     for (const ParallaxLayer& layer : parallaxLayers)
     {
-        const float parallaxX = std::fmod(-cameraX * layer.scrollFactor, static_cast<float>(screenWidth));
         const float baseY = screenHeight - layer.height + layer.verticalOffset;
-
-        for (int i = -1; i <= 1; ++i)
-        {
-            Rectangle rect{parallaxX + static_cast<float>(i * screenWidth),
-                           baseY - cameraY * layer.scrollFactor * 0.1f,
-                           static_cast<float>(screenWidth),
-                           layer.height};
-            DrawRectangleRec(rect, layer.color);
-        }
-    }
-}
-
-void Game::ResetLevel()
-{
-    platforms.clear();
-    enemies.clear();
-    coins.clear();
-
-    if (currentLevel <= 1)
-    {
-        currentLevel = 1;
-        player.score = 0;
-        player.lives = 3;
-        player.totalCoinsCollected = 0;
-        player.bestCombo = 0;
-        hasBestTime = false;
-        bestTimeTrial = std::numeric_limits<float>::infinity();
+        Rectangle rect{0.0f,
+                       baseY - cameraY * layer.scrollFactor * 0.1f,
+                       static_cast<float>(screenWidth),
+                       layer.height};
+        primitiveBatch.PushRectangle(rect, layer.color);
     }
 
-    const float groundHeight = 64.0f;
-    platforms.push_back({Rectangle{ -400.0f, 400.0f, 1200.0f, groundHeight }, { -400.0f, 400.0f }, { -400.0f, 400.0f }, 0.0f, 0.0f, false});
-    platforms.push_back({Rectangle{ 150.0f, 320.0f, 160.0f, 24.0f }, {150.0f, 320.0f}, {150.0f, 320.0f}, 0.0f, 0.0f, false});
-    platforms.push_back({Rectangle{ 380.0f, 260.0f, 160.0f, 24.0f }, {380.0f, 260.0f}, {500.0f, 260.0f}, 2.5f, 0.0f, true});
-    platforms.push_back({Rectangle{ 640.0f, 180.0f, 180.0f, 24.0f }, {640.0f, 180.0f}, {820.0f, 200.0f}, 3.0f, 0.0f, true});
-
-    enemies.push_back({Rectangle{220.0f, 364.0f, 32.0f, 32.0f}, 50.0f, 150.0f, 310.0f, 1, 1});
-    enemies.push_back({Rectangle{420.0f, 214.0f, 32.0f, 32.0f}, 70.0f, 380.0f, 520.0f, 1, -1});
-
-    coins.push_back({Vector2{180.0f, 290.0f}, 12.0f, false});
-    coins.push_back({Vector2{420.0f, 230.0f}, 12.0f, false});
-    coins.push_back({Vector2{700.0f, 150.0f}, 12.0f, false});
-
-    Vector2 spawnPoint{0.0f, 352.0f};
-    ResetPlayer(player, spawnPoint);
-
-    timeTrialActive = timeTrialMode;
-    timeTrialTimer = 0.0f;
-
-    if (musicLoaded)
-    {
-        StopMusicStream(backgroundMusic);
-        PlayMusicStream(backgroundMusic);
-    }
+    primitiveBatch.Flush();
 }
 
-void Game::UpdateCamera()
+void Game::UpdateCamera(const RenderSnapshot& frame)
 {
-    camera.target = {player.position.x + player.width * 0.5f, player.position.y + player.height * 0.5f};
+    const Player& player = frame.player;
+    const Vector2 playerPosition = GetInterpolatedPlayerPosition(player, GetRenderAlpha(frame));
+    camera.target = {playerPosition.x + player.width * 0.5f, playerPosition.y + player.height * 0.5f};
 
     const float zoomMin = 0.6f;
     const float zoomMax = 1.2f;
@@ -480,307 +768,54 @@ void Game::UpdateParallaxPalette()
     }
 }
 
-void Game::InitWeather()
-{
-    weather.rainDrops.clear();
-    weather.rainDrops.resize(RAIN_DROP_COUNT);
-
-    const int width = screenWidth;
-    const int height = screenHeight;
-
-    for (RainDrop& drop : weather.rainDrops)
-    {
-        drop.position = {
-            static_cast<float>(GetRandomValue(-width / 4, width + width / 4)),
-            static_cast<float>(GetRandomValue(-height, height))
-        };
-        drop.length = 14.0f + static_cast<float>(GetRandomValue(0, 10));
-        drop.speed = 500.0f + static_cast<float>(GetRandomValue(-120, 160));
-    }
-
-    weather.windCurrent = 0.0f;
-    weather.windTarget = 0.0f;
-    weather.baseWind = 0.0f;
-    weather.windVariance = 20.0f;
-    weather.windChangeTimer = 0.0f;
-    weather.lightningFlashTimer = 0.0f;
-    weather.lightningCooldown = 0.0f;
-    SetWeather(WeatherType::Clear);
-}
-
-void Game::SetWeather(WeatherType type)
-{
-    weather.current = type;
-
-    switch (type)
-    {
-        case WeatherType::Clear:
-            weather.rainIntensity = 0.0f;
-            weather.baseWind = 0.0f;
-            weather.windVariance = 35.0f;
-            weather.timeUntilChange = static_cast<float>(GetRandomValue(18, 28));
-            weather.lightningCooldown = 0.0f;
-            break;
-        case WeatherType::Rain:
-            weather.rainIntensity = 0.85f;
-            weather.baseWind = static_cast<float>(GetRandomValue(-30, 30));
-            weather.windVariance = 70.0f;
-            weather.timeUntilChange = static_cast<float>(GetRandomValue(24, 34));
-            weather.lightningCooldown = 0.0f;
-            break;
-        case WeatherType::Windy:
-            weather.rainIntensity = 0.0f;
-            weather.baseWind = static_cast<float>(GetRandomValue(-90, 90));
-            weather.windVariance = 90.0f;
-            weather.timeUntilChange = static_cast<float>(GetRandomValue(20, 30));
-            weather.lightningCooldown = 0.0f;
-            break;
-        case WeatherType::Storm:
-            weather.rainIntensity = 1.25f;
-            weather.baseWind = static_cast<float>(GetRandomValue(-110, 110));
-            weather.windVariance = 120.0f;
-            weather.timeUntilChange = static_cast<float>(GetRandomValue(22, 32));
-            weather.lightningCooldown = static_cast<float>(GetRandomValue(4, 9));
-            break;
-    }
-
-    weather.windTarget = weather.baseWind;
-    weather.windChangeTimer = static_cast<float>(GetRandomValue(2, 5));
-}
-
-void Game::UpdateWeather(float dt)
-{
-    if (weather.rainDrops.empty())
-    {
-        InitWeather();
-    }
-
-    weather.timeUntilChange -= dt;
-    if (weather.timeUntilChange <= 0.0f)
-    {
-        int roll = GetRandomValue(0, 99);
-        WeatherType next = WeatherType::Clear;
-        if (roll < 40)
-        {
-            next = WeatherType::Clear;
-        }
-        else if (roll < 70)
-        {
-            next = WeatherType::Rain;
-        }
-        else if (roll < 90)
-        {
-            next = WeatherType::Windy;
-        }
-        else
-        {
-            next = WeatherType::Storm;
-        }
-
-        if (next == weather.current)
-        {
-            next = static_cast<WeatherType>((static_cast<int>(weather.current) + 1) % 4);
-        }
-
-        SetWeather(next);
-    }
-
-    weather.windChangeTimer -= dt;
-    if (weather.windChangeTimer <= 0.0f)
-    {
-        weather.windTarget = weather.baseWind + static_cast<float>(GetRandomValue(-100, 100)) * (weather.windVariance / 100.0f);
-        weather.windChangeTimer = static_cast<float>(GetRandomValue(2, 6));
-    }
-
-    const float windDiff = weather.windTarget - weather.windCurrent;
-    weather.windCurrent += windDiff * std::clamp(dt * 1.5f, 0.0f, 1.0f);
-
-    if (weather.lightningFlashTimer > 0.0f)
-    {
-        weather.lightningFlashTimer = std::max(0.0f, weather.lightningFlashTimer - dt);
-    }
-
-    if (weather.current == WeatherType::Storm)
-    {
-        weather.lightningCooldown -= dt;
-        if (weather.lightningCooldown <= 0.0f)
-        {
-            weather.lightningFlashTimer = LIGHTNING_FLASH_DURATION;
-            weather.lightningCooldown = static_cast<float>(GetRandomValue(5, 11));
-        }
-    }
-
-    const float width = static_cast<float>(GetScreenWidth());
-    const float height = static_cast<float>(GetScreenHeight());
-
-    if (weather.rainIntensity > 0.05f)
-    {
-        for (RainDrop& drop : weather.rainDrops)
-        {
-            drop.position.x += weather.windCurrent * 0.15f * dt;
-            drop.position.y += drop.speed * (1.0f + weather.rainIntensity) * dt;
-
-            if (drop.position.y - drop.length > height)
-            {
-                drop.position.y = static_cast<float>(GetRandomValue(-static_cast<int>(height), 0));
-                drop.position.x = static_cast<float>(GetRandomValue(-static_cast<int>(width) / 4, static_cast<int>(width) + static_cast<int>(width) / 4));
-                drop.speed = 500.0f + static_cast<float>(GetRandomValue(-120, 150));
-                drop.length = 14.0f + static_cast<float>(GetRandomValue(0, 12));
-            }
-
-            const float wrapRange = width * 0.4f;
-            if (drop.position.x < -wrapRange)
-            {
-                drop.position.x += width + wrapRange * 2.0f;
-            }
-            else if (drop.position.x > width + wrapRange)
-            {
-                drop.position.x -= width + wrapRange * 2.0f;
-            }
-        }
-    }
-    else
-    {
-        // subtly drift raindrops even when not raining to keep animation fresh
-        for (RainDrop& drop : weather.rainDrops)
-        {
-            drop.position.y += drop.speed * 0.25f * dt;
-            if (drop.position.y > height)
-            {
-                drop.position.y = static_cast<float>(GetRandomValue(-static_cast<int>(height), 0));
-                drop.position.x = static_cast<float>(GetRandomValue(0, static_cast<int>(width)));
-            }
-        }
-    }
-}
-
-Vector2 Game::GetWeatherForce() const
-{
-    Vector2 force{weather.windCurrent, 0.0f};
-
-    if (weather.current == WeatherType::Storm)
-    {
-        force.y = 50.0f;
-    }
-    else if (weather.current == WeatherType::Rain)
-    {
-        force.y = 20.0f;
-    }
-
-    return force;
-}
-
-void Game::HandleInputToggles()
+void Game::HandleInputToggles(const InputState& input)
 {
-    if (inputState.toggleHighContrast)
+    if (input.toggleHighContrast)
     {
         accessibility.highContrast = !accessibility.highContrast;
         UpdateParallaxPalette();
     }
 
-    if (inputState.toggleLargeHud)
+    if (input.toggleLargeHud)
     {
         accessibility.largeHud = !accessibility.largeHud;
     }
 
-    if (inputState.cycleBindings)
+    if (input.cycleBindings)
     {
         accessibility.alternativeBindings = !accessibility.alternativeBindings;
         inputBindings = accessibility.alternativeBindings ? MakeAlternativeBindings() : MakeDefaultBindings();
     }
 
-    if (inputState.openSettings)
+    if (input.openSettings)
     {
         showSettingsOverlay = !showSettingsOverlay;
     }
 
-    if (inputState.toggleTimeTrial)
+    if (input.toggleProfiler)
     {
-        timeTrialMode = !timeTrialMode;
-        if (!timeTrialMode)
-        {
-            timeTrialActive = false;
-        }
-        else
-        {
-            timeTrialActive = true;
-            timeTrialTimer = 0.0f;
-        }
-    }
-}
-
-void Game::UpdateComboTimer()
-{
-    if (player.comboTimer <= 0.0f)
-    {
-        player.comboCount = 0;
-    }
-}
-
-void Game::UpdateAchievements(int coinsCollected, float dt)
-{
-    auto notify = [this](const char* message)
-    {
-        achievements.lastUnlocked = message;
-        achievements.notificationTimer = ACHIEVEMENT_DISPLAY_TIME;
-    };
-
-    if (coinsCollected > 0 && !achievements.firstCoinUnlocked)
-    {
-        achievements.firstCoinUnlocked = true;
-        notify("Shiny Start: Collected your first coin!");
-    }
-
-    if (player.totalCoinsCollected >= 10 && !achievements.tenCoinsUnlocked)
-    {
-        achievements.tenCoinsUnlocked = true;
-        notify("Treasure Hunter: 10 coins collected!");
-    }
-
-    if (player.bestCombo >= 5 && !achievements.comboFiveUnlocked)
-    {
-        achievements.comboFiveUnlocked = true;
-        notify("Combo Master: 5x combo achieved!");
-    }
-
-    if (achievements.notificationTimer > 0.0f)
-    {
-        achievements.notificationTimer = std::max(0.0f, achievements.notificationTimer - dt);
+        showProfilerOverlay = !showProfilerOverlay;
     }
 }
 
-bool Game::UpdateTimeTrial(float dt, bool levelCompleted)
+void Game::SyncMusicWithLevel(const RenderSnapshot& frame)
 {
-    if (!timeTrialMode)
+    // The asset manager owns the stream; the feeder plays a copy of its handle.
+    const Music* music = musicStarted ? nullptr : assets.GetMusic(musicAsset);
+    if (music != nullptr)
     {
-        return false;
+        musicFeeder.Play(*music);
+        musicStarted = true;
     }
 
-    if (timeTrialActive)
+    if (frame.levelSerial == musicLevelSerial)
     {
-        timeTrialTimer += dt;
+        return;
     }
 
-    if (!levelCompleted)
+    musicLevelSerial = frame.levelSerial;
+    if (musicStarted)
     {
-        return false;
+        musicFeeder.Restart();
     }
-
-    if (!timeTrialActive)
-    {
-        return false;
-    }
-
-    timeTrialActive = false;
-
-    bool newRecord = false;
-    if (!hasBestTime || timeTrialTimer < bestTimeTrial)
-    {
-        bestTimeTrial = timeTrialTimer;
-        hasBestTime = true;
-        newRecord = true;
-    }
-
-    return newRecord;
 }
-
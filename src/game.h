@@ -1,39 +1,23 @@
 #pragma once
 
 #include <array>
+#include <cstdint>
 #include <string>
 #include <vector>
 
 #include "raylib.h"
 
-#include "player.h"
-#include "platform.h"
-#include "enemy.h"
-#include "coin.h"
+#include "asset_manager.h"
+#include "frame_pacer.h"
 #include "input.h"
-
-enum class GameState
-{
-    Menu,
-    Playing,
-    Paused,
-    GameOver
-};
-
-enum class WeatherType
-{
-    Clear,
-    Rain,
-    Windy,
-    Storm
-};
-
-struct RainDrop
-{
-    Vector2 position{};
-    float length{18.0f};
-    float speed{600.0f};
-};
+#include "job_system.h"
+#include "music_feeder.h"
+#include "profiler.h"
+#include "render_batch.h"
+#include "render_snapshot.h"
+#include "simulation_host.h"
+#include "static_tiles.h"
+#include "ui.h"
 
 struct ParallaxLayer
 {
@@ -43,6 +27,12 @@ struct ParallaxLayer
     float verticalOffset{0.0f};
 };
 
+struct CullingStats
+{
+    int drawn{0};
+    int culled{0};
+};
+
 struct AccessibilityOptions
 {
     bool highContrast{false};
@@ -50,35 +40,50 @@ struct AccessibilityOptions
     bool alternativeBindings{false};
 };
 
-struct AchievementState
+// Simulation rates the shell can run at. Lower rates suit weak devices, since
+// rendering interpolates between ticks either way.
+constexpr std::array<int, 4> SUPPORTED_TICK_RATES{30, 60, 120, 240};
+constexpr int DEFAULT_TICK_RATE = 120;
+// Ticks one frame may run to catch up; beyond that the game slows down rather
+// than letting a long frame snowball into longer ones.
+constexpr int DEFAULT_MAX_SUBSTEPS = 8;
+constexpr int DEFAULT_FPS_CAP = 60;
+// Assumed when the monitor does not report its refresh rate.
+constexpr int FALLBACK_REFRESH_RATE = 60;
+
+bool IsSupportedTickRate(int ticksPerSecond);
+
+// Command-line switches for the simulation rate and for capturing or replaying a session.
+struct LaunchOptions
 {
-    bool firstCoinUnlocked{false};
-    bool tenCoinsUnlocked{false};
-    bool comboFiveUnlocked{false};
-    bool timeTrialClearUnlocked{false};
-    std::string lastUnlocked{};
-    float notificationTimer{0.0f};
+    int tickRate{DEFAULT_TICK_RATE};
+    int maxSubsteps{DEFAULT_MAX_SUBSTEPS};
+    PacingMode pacing{PacingMode::Capped};
+    int fpsCap{DEFAULT_FPS_CAP};
+    std::string recordPath{};
+    std::string replayPath{};
+    // Replay as fast as possible, drawing only an occasional progress frame.
+    bool fastReplay{false};
+    // Chrome/Perfetto trace of every profiled scope; needs a profiling build.
+    std::string tracePath{};
+    // Tick on the render thread instead of a simulation thread of its own.
+    bool singleThreaded{false};
+    // Job system workers for per-entity updates; 0 keeps them on the tick thread.
+    int workerThreads{GetDefaultWorkerCount()};
+    // Fixed job chunking, for runs that must reproduce across machines.
+    bool deterministicJobs{false};
 };
 
-struct WeatherState
+struct ReplayStats
 {
-    WeatherType current{WeatherType::Clear};
-    float timeUntilChange{0.0f};
-    float rainIntensity{0.0f};
-    float baseWind{0.0f};
-    float windVariance{0.0f};
-    float windCurrent{0.0f};
-    float windTarget{0.0f};
-    float windChangeTimer{0.0f};
-    float lightningCooldown{0.0f};
-    float lightningFlashTimer{0.0f};
-    std::vector<RainDrop> rainDrops{};
+    std::uint64_t ticks{0};
+    double seconds{0.0};
 };
 
 class Game
 {
 public:
-    Game();
+    explicit Game(LaunchOptions options = {});
     ~Game();
 
     void Run();
@@ -86,52 +91,48 @@ public:
 private:
     void Init();
     void Shutdown();
-    void Update(float dt);
-    void Draw() const;
-    void DrawGameplay() const;
-    void DrawMenu() const;
+    void PresentFrame(const RenderSnapshot& frame);
+    void PollFrameInput();
+    void Draw(const RenderSnapshot& frame) const;
+    void DrawGameplay(const RenderSnapshot& frame) const;
+    void DrawMenu(const RenderSnapshot& frame) const;
     void DrawPause() const;
-    void DrawGameOver() const;
-    void DrawSettingsOverlay() const;
+    void DrawGameOver(const RenderSnapshot& frame) const;
+    void DrawSettingsOverlay(const RenderSnapshot& frame) const;
+    void DrawProfilerOverlay() const;
     void DrawBackground() const;
-    void DrawWeather() const;
-    void ResetLevel();
-    void UpdateCamera();
+    void DrawParticles(const ParticleSnapshot& particles, const Rectangle& view, Color color) const;
+    void DrawWeather(const RenderSnapshot& frame) const;
+    void UpdateCamera(const RenderSnapshot& frame);
     void InitParallax();
     void UpdateParallaxPalette();
-    void InitWeather();
-    void SetWeather(WeatherType type);
-    void UpdateWeather(float dt);
-    Vector2 GetWeatherForce() const;
-    void HandleInputToggles();
-    void UpdateComboTimer();
-    void UpdateAchievements(int coinsCollected, float dt);
-    bool UpdateTimeTrial(float dt, bool levelCompleted);
-
-    GameState state{GameState::Menu};
-    Player player{};
-    std::vector<Platform> platforms{};
-    std::vector<Enemy> enemies{};
-    std::vector<Coin> coins{};
+    void HandleInputToggles(const InputState& input);
+    void SyncMusicWithLevel(const RenderSnapshot& frame);
+    void StartReplay();
+    void RunFastReplay();
+    float GetRenderAlpha(const RenderSnapshot& frame) const;
+
+    LaunchOptions launchOptions{};
+    SimulationHost simulationHost{};
+    FramePacer framePacer{};
     Camera2D camera{};
-    float gravity{780.0f};
     int screenWidth{1600};
     int screenHeight{900};
-    int currentLevel{1};
-    InputState inputState{};
     InputBindings inputBindings{MakeDefaultBindings()};
-    Music backgroundMusic{};
-    bool musicLoaded{false};
+    AssetManager assets{};
+    AssetHandle musicAsset{};
+    MusicFeeder musicFeeder{};
+    bool musicStarted{false};
+    std::uint32_t musicLevelSerial{0};
     std::array<ParallaxLayer, 3> parallaxLayers{};
     AccessibilityOptions accessibility{};
     bool showSettingsOverlay{false};
-    AchievementState achievements{};
-    bool timeTrialMode{false};
-    bool timeTrialActive{false};
-    float timeTrialTimer{0.0f};
-    float bestTimeTrial{0.0f};
-    bool hasBestTime{false};
-    WeatherState weather{};
+    bool showProfilerOverlay{false};
+    ReplayStats replayStats{};
+    // Draw() is const, but batching geometry is a render-side cache.
+    mutable PrimitiveBatch primitiveBatch{};
+    mutable CullingStats cullingStats{};
+    mutable HudLayer hud{};
+    mutable StaticTileCache staticTiles{};
+    mutable std::vector<ProfileThreadSnapshot> profilerThreads{};
 };
-
-
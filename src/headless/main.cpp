@@ -0,0 +1,414 @@
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include "job_system.h"
+#include "level_generator.h"
+#include "loopback_transport.h"
+#include "random.h"
+#include "replay.h"
+#include "rollback.h"
+#include "simulation.h"
+
+namespace
+{
+    struct HeadlessOptions
+    {
+        long long ticks{1000000};
+        std::uint32_t seed{Random::DEFAULT_SEED};
+        float step{SIMULATION_STEP};
+        const char* levelDirectory{nullptr};
+        const char* recordPath{nullptr};
+        const char* replayPath{nullptr};
+        int workerThreads{0};
+        bool deterministicJobs{false};
+        bool race{false};
+        bool lod{true};
+        LinkConditions link{};
+    };
+
+    // Entities per LOD tier, summed over every tick of the run.
+    struct LodTotals
+    {
+        long long full{0};
+        long long reduced{0};
+        long long dormant{0};
+
+        void Add(const LodCounts& counts)
+        {
+            full += counts.full;
+            reduced += counts.reduced;
+            dormant += counts.dormant;
+        }
+    };
+
+    void PrintUsage(const char* program)
+    {
+        std::printf("Usage: %s [--ticks N] [--seed S] [--step SECONDS] [--levels DIR]\n"
+                    "          [--record FILE] [--replay FILE] [--threads N] [--deterministic]\n"
+                    "          [--race] [--latency MS] [--jitter MS] [--loss PERCENT] [--no-lod]\n"
+                    "--replay takes seed, step and tick count from the file and drives the\n"
+                    "simulation from its inputs instead of the bot. --threads starts job system\n"
+                    "workers; results match a run without them. --race runs two bots as\n"
+                    "rollback peers over a simulated link until both finish the first level.\n"
+                    "--no-lod updates every entity every tick; results match a run with LOD.\n",
+                    program);
+    }
+
+    bool ParseArguments(int argc, char** argv, HeadlessOptions& options)
+    {
+        for (int i = 1; i < argc; ++i)
+        {
+            const char* arg = argv[i];
+            const bool hasValue = i + 1 < argc;
+
+            if (std::strcmp(arg, "--ticks") == 0 && hasValue)
+            {
+                options.ticks = std::strtoll(argv[++i], nullptr, 10);
+            }
+            else if (std::strcmp(arg, "--seed") == 0 && hasValue)
+            {
+                options.seed = static_cast<std::uint32_t>(std::strtoul(argv[++i], nullptr, 0));
+            }
+            else if (std::strcmp(arg, "--step") == 0 && hasValue)
+            {
+                options.step = std::strtof(argv[++i], nullptr);
+            }
+            else if (std::strcmp(arg, "--levels") == 0 && hasValue)
+            {
+                options.levelDirectory = argv[++i];
+            }
+            else if (std::strcmp(arg, "--record") == 0 && hasValue)
+            {
+                options.recordPath = argv[++i];
+            }
+            else if (std::strcmp(arg, "--replay") == 0 && hasValue)
+            {
+                options.replayPath = argv[++i];
+            }
+            else if (std::strcmp(arg, "--threads") == 0 && hasValue)
+            {
+                options.workerThreads = std::atoi(argv[++i]);
+            }
+            else if (std::strcmp(arg, "--deterministic") == 0)
+            {
+                options.deterministicJobs = true;
+            }
+            else if (std::strcmp(arg, "--race") == 0)
+            {
+                options.race = true;
+            }
+            else if (std::strcmp(arg, "--no-lod") == 0)
+            {
+                options.lod = false;
+            }
+            else if (std::strcmp(arg, "--latency") == 0 && hasValue)
+            {
+                options.link.latency = std::strtod(argv[++i], nullptr) / 1000.0;
+            }
+            else if (std::strcmp(arg, "--jitter") == 0 && hasValue)
+            {
+                options.link.jitter = std::strtod(argv[++i], nullptr) / 1000.0;
+            }
+            else if (std::strcmp(arg, "--loss") == 0 && hasValue)
+            {
+                options.link.loss = std::strtof(argv[++i], nullptr) / 100.0f;
+            }
+            else
+            {
+                return false;
+            }
+        }
+
+        return options.ticks > 0 && options.step > 0.0f && options.workerThreads >= 0 &&
+               options.link.latency >= 0.0 && options.link.jitter >= 0.0;
+    }
+
+    // Scripted stand-in for a player: heads for the nearest coin, hops when it
+    // sits above, and presses through the menu and game-over screens so the soak
+    // never stalls.
+    class BotDriver
+    {
+    public:
+        explicit BotDriver(std::uint32_t seed)
+            : rng(seed ^ 0xB07B07u)
+        {
+        }
+
+        InputState NextInput(const Simulation& simulation)
+        {
+            InputState input{};
+
+            switch (simulation.GetState())
+            {
+                case GameState::Menu:
+                    input.confirmPressed = true;
+                    return input;
+                case GameState::Paused:
+                    input.pausePressed = true;
+                    return input;
+                case GameState::GameOver:
+                    input.restartPressed = true;
+                    return input;
+                case GameState::Playing:
+                    break;
+            }
+
+            const Player& player = simulation.GetPlayer();
+            const Vector2 centre = GetPlayerCentre(player);
+
+            const Coin* target = nullptr;
+            float bestDistance = 0.0f;
+            for (const Coin& coin : simulation.GetCoins())
+            {
+                if (coin.collected)
+                {
+                    continue;
+                }
+
+                const float dx = coin.position.x - centre.x;
+                const float dy = coin.position.y - centre.y;
+                const float distance = dx * dx + dy * dy;
+                if (target == nullptr || distance < bestDistance)
+                {
+                    target = &coin;
+                    bestDistance = distance;
+                }
+            }
+
+            if (target != nullptr)
+            {
+                const float dx = target->position.x - centre.x;
+                input.moveRight = dx > 8.0f;
+                input.moveLeft = dx < -8.0f;
+                input.jumpPressed = target->position.y < player.position.y || rng.Range(0, 89) == 0;
+            }
+
+            return input;
+        }
+
+    private:
+        Random rng;
+    };
+
+    bool IsLaneDone(const RollbackSession& session, int player)
+    {
+        const int finishTick = session.GetFinishTick(player);
+        const int outTick = session.GetOutTick(player);
+        const int confirmedTick = session.GetConfirmedTick();
+        return (finishTick >= 0 && finishTick <= confirmedTick) || (outTick >= 0 && outTick <= confirmedTick);
+    }
+
+    void PrintFinish(const RollbackSession& session, int player)
+    {
+        const int finishTick = session.GetFinishTick(player);
+        const int outTick = session.GetOutTick(player);
+        if (finishTick >= 0)
+        {
+            std::printf("player %d:         finished at %.2f s\n", player, static_cast<double>(finishTick + 1) * SIMULATION_STEP);
+        }
+        else if (outTick >= 0)
+        {
+            std::printf("player %d:         out of lives at %.2f s\n", player, static_cast<double>(outTick + 1) * SIMULATION_STEP);
+        }
+        else
+        {
+            std::printf("player %d:         still racing\n", player);
+        }
+    }
+
+    // Two bots race the first level, each on its own peer, over one simulated
+    // link. The clock is the frame count, so a run is as repeatable as its seed.
+    int RunRace(const HeadlessOptions& options)
+    {
+        LoopbackTransport transport(options.link, options.seed);
+        std::array<RollbackSession, RACE_PLAYER_COUNT> peers{{RollbackSession(0, options.seed), RollbackSession(1, options.seed)}};
+        std::array<BotDriver, RACE_PLAYER_COUNT> bots{{BotDriver(options.seed), BotDriver(options.seed + 1)}};
+        if (options.levelDirectory != nullptr)
+        {
+            for (RollbackSession& peer : peers)
+            {
+                peer.SetLevelDirectory(options.levelDirectory);
+            }
+        }
+
+        const auto start = std::chrono::steady_clock::now();
+        long long frame = 0;
+        for (; frame < options.ticks; ++frame)
+        {
+            const double now = static_cast<double>(frame) * SIMULATION_STEP;
+            for (int player = 0; player < RACE_PLAYER_COUNT; ++player)
+            {
+                // A peer that stalled catches up a tick per frame once unblocked.
+                RollbackSession& peer = peers[static_cast<std::size_t>(player)];
+                for (int step = 0; step < 2 && peer.GetTick() <= frame; ++step)
+                {
+                    const InputState input = bots[static_cast<std::size_t>(player)].NextInput(peer.GetLane(player));
+                    if (!peer.AdvanceTick(input, transport, now))
+                    {
+                        break;
+                    }
+                }
+            }
+
+            bool decided = true;
+            for (const RollbackSession& peer : peers)
+            {
+                for (int player = 0; player < RACE_PLAYER_COUNT; ++player)
+                {
+                    decided = decided && IsLaneDone(peer, player);
+                }
+            }
+            if (decided)
+            {
+                break;
+            }
+        }
+        const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        std::printf("race link:        %.1f ms latency, %.1f ms jitter, %.1f%% loss\n",
+                    options.link.latency * 1000.0, options.link.jitter * 1000.0, static_cast<double>(options.link.loss) * 100.0);
+        std::printf("frames:           %lld\n", frame);
+        std::printf("wall time:        %.3f s\n", seconds);
+        std::printf("packets:          %d sent, %d dropped\n", transport.GetSentCount(), transport.GetDroppedCount());
+        bool agreed = true;
+        for (const RollbackSession& peer : peers)
+        {
+            const RollbackStats& stats = peer.GetStats();
+            std::printf("peer %d:           %d ticks, %d stalled, %d rollbacks, %d resimulated, longest %d ticks in %.1f us\n",
+                        peer.GetLocalPlayer(), stats.ticks, stats.stalledTicks, stats.rollbacks, stats.resimulatedTicks,
+                        stats.longestRollback, stats.longestRollbackSeconds * 1.0e6);
+            std::printf("peer %d checksums: %d compared, %d desyncs\n", peer.GetLocalPlayer(), stats.checksumsCompared, stats.desyncs);
+            for (int player = 0; player < RACE_PLAYER_COUNT; ++player)
+            {
+                agreed = agreed && peer.GetFinishTick(player) == peers[0].GetFinishTick(player) &&
+                         peer.GetOutTick(player) == peers[0].GetOutTick(player);
+            }
+        }
+        for (int player = 0; player < RACE_PLAYER_COUNT; ++player)
+        {
+            PrintFinish(peers[0], player);
+        }
+        std::printf("peers agree:      %s\n", agreed ? "yes" : "no");
+
+        const int desyncs = peers[0].GetStats().desyncs + peers[1].GetStats().desyncs;
+        return agreed && desyncs == 0 ? 0 : 1;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    HeadlessOptions options{};
+    if (!ParseArguments(argc, argv, options))
+    {
+        PrintUsage(argv[0]);
+        return 1;
+    }
+
+    if (options.race)
+    {
+        return RunRace(options);
+    }
+
+    ReplayPlayer replay;
+    if (options.replayPath != nullptr)
+    {
+        if (!replay.Load(options.replayPath))
+        {
+            std::fprintf(stderr, "could not load replay %s\n", options.replayPath);
+            return 1;
+        }
+        options.seed = replay.GetSeed();
+        options.step = replay.GetStep();
+        options.ticks = static_cast<long long>(replay.GetTickCount());
+        std::printf("replay:           %s\n", options.replayPath);
+    }
+
+    ReplayRecorder recorder;
+    if (options.recordPath != nullptr)
+    {
+        recorder.Begin(options.seed, options.step);
+    }
+
+    Simulation simulation(options.seed);
+    if (options.levelDirectory != nullptr)
+    {
+        const int levels = simulation.SetLevelDirectory(options.levelDirectory);
+        std::printf("levels loaded:    %d\n", levels);
+    }
+    simulation.SetLodEnabled(options.lod);
+    BotDriver bot(options.seed);
+    JobSystem::Get().Start(options.workerThreads, options.deterministicJobs);
+
+    int gameOvers = 0;
+    LodTotals lodTotals{};
+    int highestLevel = 1;
+    GameState previousState = simulation.GetState();
+
+    const auto start = std::chrono::steady_clock::now();
+
+    for (long long tick = 0; tick < options.ticks; ++tick)
+    {
+        const InputState input = replay.IsLoaded() ? replay.Next() : bot.NextInput(simulation);
+        simulation.Update(input, options.step);
+        recorder.Record(input);
+        lodTotals.Add(simulation.GetPlatforms().lod);
+        lodTotals.Add(simulation.GetEnemies().lod);
+
+        const GameState current = simulation.GetState();
+        if (current == GameState::GameOver && previousState != GameState::GameOver)
+        {
+            ++gameOvers;
+        }
+        previousState = current;
+
+        if (simulation.GetLevel() > highestLevel)
+        {
+            highestLevel = simulation.GetLevel();
+        }
+    }
+
+    const auto end = std::chrono::steady_clock::now();
+    const double seconds = std::chrono::duration<double>(end - start).count();
+    const double simulatedSeconds = static_cast<double>(options.ticks) * options.step;
+
+    JobSystem::Get().Stop();
+
+    std::printf("ticks:            %lld\n", options.ticks);
+    std::printf("seed:             0x%08X\n", static_cast<unsigned int>(options.seed));
+    std::printf("simulated time:   %.1f s\n", simulatedSeconds);
+    std::printf("wall time:        %.3f s\n", seconds);
+    std::printf("ticks/second:     %.0f\n", seconds > 0.0 ? static_cast<double>(options.ticks) / seconds : 0.0);
+    std::printf("ns/tick:          %.1f\n", seconds * 1.0e9 / static_cast<double>(options.ticks));
+    std::printf("job workers:      %d\n", options.workerThreads);
+    std::printf("highest level:    %d\n", highestLevel);
+    std::printf("game overs:       %d\n", gameOvers);
+    std::printf("final score:      %d\n", simulation.GetPlayer().score);
+    const RewindBuffer& rewind = simulation.GetRewindBuffer();
+    std::printf("rewind history:   %d ticks, %.1f KiB\n", rewind.GetFrameCount(), static_cast<double>(rewind.GetUsedBytes()) / 1024.0);
+    const double perTick = 1.0 / static_cast<double>(options.ticks);
+    std::printf("lod per tick:     %.1f full, %.1f reduced, %.1f dormant%s\n",
+                static_cast<double>(lodTotals.full) * perTick, static_cast<double>(lodTotals.reduced) * perTick,
+                static_cast<double>(lodTotals.dormant) * perTick, options.lod ? "" : " (off)");
+    if (const LevelGenerator* generator = simulation.GetLevelLibrary().GetGenerator())
+    {
+        const LevelGeneratorStats levels = generator->GetStats();
+        std::printf("levels generated: %d, %d prefetched, %d waited for, last in %.2f ms\n",
+                    levels.generated, levels.prefetched, levels.waited, levels.lastGenerationSeconds * 1000.0);
+    }
+
+    if (options.recordPath != nullptr)
+    {
+        if (!recorder.Save(options.recordPath))
+        {
+            std::fprintf(stderr, "could not write replay %s\n", options.recordPath);
+            return 1;
+        }
+        std::printf("recorded:         %s (%u ticks)\n", options.recordPath, static_cast<unsigned int>(recorder.GetTickCount()));
+    }
+
+    return 0;
+}
@@ -25,6 +25,7 @@ InputBindings MakeDefaultBindings()
     bindings.jump = {KEY_SPACE, KEY_UP};
     bindings.pause = {KEY_P, KEY_ESCAPE};
     bindings.restart = {KEY_R, KEY_BACKSPACE};
+    bindings.rewind = {KEY_Q, KEY_NULL};
     return bindings;
 }
 
@@ -36,6 +37,7 @@ InputBindings MakeAlternativeBindings()
     bindings.jump = {KEY_I, KEY_SPACE};
     bindings.pause = {KEY_O, KEY_P};
     bindings.restart = {KEY_U, KEY_R};
+    bindings.rewind = {KEY_K, KEY_Q};
     return bindings;
 }
 
@@ -48,12 +50,15 @@ InputState PollInputState(const InputBindings& bindings)
     state.jumpPressed = IsKeyPairPressed(bindings.jump);
     state.pausePressed = IsKeyPairPressed(bindings.pause);
     state.restartPressed = IsKeyPairPressed(bindings.restart);
+    state.rewindHeld = IsKeyPairDown(bindings.rewind);
+    state.confirmPressed = IsKeyPressed(KEY_ENTER);
 
     state.openSettings = IsKeyPressed(KEY_O);
     state.toggleHighContrast = IsKeyPressed(KEY_F3);
     state.toggleLargeHud = IsKeyPressed(KEY_F4);
     state.toggleTimeTrial = IsKeyPressed(KEY_T);
     state.cycleBindings = IsKeyPressed(KEY_F5);
+    state.toggleProfiler = IsKeyPressed(KEY_F6);
 
 #if defined(PLATFORM_ANDROID)
     if (IsGestureDetected(GESTURE_TAP))
@@ -76,3 +81,29 @@ InputState PollInputState(const InputBindings& bindings)
 
     return state;
 }
+
+void LatchInputState(InputState& latched, const InputState& polled)
+{
+    latched.moveLeft = polled.moveLeft;
+    latched.moveRight = polled.moveRight;
+    latched.rewindHeld = polled.rewindHeld;
+    latched.jumpPressed = latched.jumpPressed || polled.jumpPressed;
+    latched.confirmPressed = latched.confirmPressed || polled.confirmPressed;
+    latched.pausePressed = latched.pausePressed || polled.pausePressed;
+    latched.restartPressed = latched.restartPressed || polled.restartPressed;
+    latched.openSettings = latched.openSettings || polled.openSettings;
+    latched.toggleHighContrast = latched.toggleHighContrast || polled.toggleHighContrast;
+    latched.toggleLargeHud = latched.toggleLargeHud || polled.toggleLargeHud;
+    latched.toggleTimeTrial = latched.toggleTimeTrial || polled.toggleTimeTrial;
+    latched.cycleBindings = latched.cycleBindings || polled.cycleBindings;
+    latched.toggleProfiler = latched.toggleProfiler || polled.toggleProfiler;
+}
+
+void ClearInputPresses(InputState& input)
+{
+    InputState cleared{};
+    cleared.moveLeft = input.moveLeft;
+    cleared.moveRight = input.moveRight;
+    cleared.rewindHeld = input.rewindHeld;
+    input = cleared;
+}
@@ -2,19 +2,7 @@
 
 #include "raylib.h"
 
-struct InputState
-{
-    bool moveLeft{false};
-    bool moveRight{false};
-    bool jumpPressed{false};
-    bool pausePressed{false};
-    bool restartPressed{false};
-    bool openSettings{false};
-    bool toggleHighContrast{false};
-    bool toggleLargeHud{false};
-    bool toggleTimeTrial{false};
-    bool cycleBindings{false};
-};
+#include "input_state.h"
 
 struct KeyPair
 {
@@ -29,9 +17,16 @@ struct InputBindings
     KeyPair jump{};
     KeyPair pause{};
     KeyPair restart{};
+    KeyPair rewind{};
 };
 
 InputBindings MakeDefaultBindings();
 InputBindings MakeAlternativeBindings();
 
 InputState PollInputState(const InputBindings& bindings);
+
+// Frames and ticks do not line up one to one. Held buttons follow the latest
+// poll; presses stay latched until ClearInputPresses so that a frame without a
+// tick cannot drop them and a frame with several ticks applies them only once.
+void LatchInputState(InputState& latched, const InputState& polled);
+void ClearInputPresses(InputState& input);
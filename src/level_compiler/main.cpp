@@ -0,0 +1,96 @@
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+#include "level_file.h"
+#include "mapped_file.h"
+
+namespace
+{
+    void PrintUsage(const char* program)
+    {
+        std::printf("Usage: %s <level.txt> <level.skl>\n", program);
+        std::printf("       %s --decompile <level.skl> [level.txt]\n", program);
+    }
+
+    bool ReadTextFile(const std::string& path, std::string& text)
+    {
+        MappedFile file;
+        if (!file.Open(path))
+        {
+            return false;
+        }
+
+        text.assign(reinterpret_cast<const char*>(file.GetData()), file.GetSize());
+        return true;
+    }
+
+    int Compile(const char* inputPath, const char* outputPath)
+    {
+        std::string text;
+        if (!ReadTextFile(inputPath, text))
+        {
+            std::fprintf(stderr, "%s: cannot read file\n", inputPath);
+            return 1;
+        }
+
+        LevelLayout layout{};
+        std::string error;
+        if (!ParseLevelText(text, layout, error))
+        {
+            std::fprintf(stderr, "%s: %s\n", inputPath, error.c_str());
+            return 1;
+        }
+
+        if (!WriteLevelFile(outputPath, layout))
+        {
+            std::fprintf(stderr, "%s: cannot write file\n", outputPath);
+            return 1;
+        }
+
+        return 0;
+    }
+
+    int Decompile(const char* inputPath, const char* outputPath)
+    {
+        MappedFile file;
+        LevelView view{};
+        if (!file.Open(inputPath) || !OpenLevelView(file.GetData(), file.GetSize(), view))
+        {
+            std::fprintf(stderr, "%s: not a compiled level (expected version %u)\n", inputPath, LEVEL_FILE_VERSION);
+            return 1;
+        }
+
+        const std::string text = FormatLevelText(MakeLevelLayout(view));
+
+        std::FILE* output = outputPath != nullptr ? std::fopen(outputPath, "wb") : stdout;
+        if (output == nullptr)
+        {
+            std::fprintf(stderr, "%s: cannot write file\n", outputPath);
+            return 1;
+        }
+
+        const bool ok = std::fwrite(text.data(), 1, text.size(), output) == text.size();
+        if (output != stdout)
+        {
+            std::fclose(output);
+        }
+        return ok ? 0 : 1;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    if (argc >= 3 && std::strcmp(argv[1], "--decompile") == 0)
+    {
+        return Decompile(argv[2], argc >= 4 ? argv[3] : nullptr);
+    }
+
+    if (argc == 3)
+    {
+        return Compile(argv[1], argv[2]);
+    }
+
+    PrintUsage(argv[0]);
+    return 1;
+}
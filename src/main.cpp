@@ -1,10 +1,88 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
 #include "game.h"
 
-int main()
+int main(int argc, char** argv)
 {
-    Game game;
+    LaunchOptions options{};
+    for (int i = 1; i < argc; ++i)
+    {
+        const char* arg = argv[i];
+        const bool hasValue = i + 1 < argc;
+
+        if (std::strcmp(arg, "--tick-rate") == 0 && hasValue)
+        {
+            options.tickRate = std::atoi(argv[++i]);
+            if (!IsSupportedTickRate(options.tickRate))
+            {
+                std::printf("--tick-rate must be one of 30, 60, 120 or 240\n");
+                return 1;
+            }
+        }
+        else if (std::strcmp(arg, "--max-substeps") == 0 && hasValue)
+        {
+            options.maxSubsteps = std::atoi(argv[++i]);
+            if (options.maxSubsteps < 1)
+            {
+                std::printf("--max-substeps must be at least 1\n");
+                return 1;
+            }
+        }
+        else if (std::strcmp(arg, "--fps") == 0 && hasValue)
+        {
+            options.fpsCap = std::atoi(argv[++i]);
+            options.pacing = options.fpsCap > 0 ? PacingMode::Capped : PacingMode::Uncapped;
+        }
+        else if (std::strcmp(arg, "--vsync") == 0)
+        {
+            options.pacing = PacingMode::Vsync;
+        }
+        else if (std::strcmp(arg, "--record") == 0 && hasValue)
+        {
+            options.recordPath = argv[++i];
+        }
+        else if (std::strcmp(arg, "--replay") == 0 && hasValue)
+        {
+            options.replayPath = argv[++i];
+        }
+        else if (std::strcmp(arg, "--trace") == 0 && hasValue)
+        {
+            options.tracePath = argv[++i];
+        }
+        else if (std::strcmp(arg, "--single-thread") == 0)
+        {
+            options.singleThreaded = true;
+        }
+        else if (std::strcmp(arg, "--threads") == 0 && hasValue)
+        {
+            options.workerThreads = std::atoi(argv[++i]);
+            if (options.workerThreads < 0)
+            {
+                std::printf("--threads must be 0 or more\n");
+                return 1;
+            }
+        }
+        else if (std::strcmp(arg, "--deterministic") == 0)
+        {
+            options.deterministicJobs = true;
+        }
+        else if (std::strcmp(arg, "--fast") == 0)
+        {
+            options.fastReplay = true;
+        }
+        else
+        {
+            std::printf("Usage: %s [--tick-rate 30|60|120|240] [--max-substeps N] [--fps N | --vsync]\n"
+                        "          [--single-thread] [--threads N] [--deterministic]\n"
+                        "          [--record FILE] [--replay FILE [--fast]] [--trace FILE]\n",
+                        argv[0]);
+            return 1;
+        }
+    }
+
+    Game game(options);
     game.Run();
     return 0;
 }
-
-
@@ -0,0 +1,142 @@
+#include "music_feeder.h"
+
+#include <algorithm>
+
+#include "profiler.h"
+
+MusicFeeder::~MusicFeeder()
+{
+    Stop();
+}
+
+void MusicFeeder::Start()
+{
+    if (feederThread.joinable())
+    {
+        return;
+    }
+
+    running.store(true, std::memory_order_release);
+    feederThread = std::thread(&MusicFeeder::ThreadMain, this);
+}
+
+void MusicFeeder::Stop()
+{
+    if (!feederThread.joinable())
+    {
+        return;
+    }
+
+    running.store(false, std::memory_order_release);
+    feederThread.join();
+
+    // The feeder has exited, so finishing its queue here cannot race it.
+    MusicCommand command{};
+    while (commands.TryPop(command))
+    {
+        Apply(command);
+    }
+    Apply({MusicCommandType::Stop, Music{}});
+}
+
+void MusicFeeder::Play(const Music& stream)
+{
+    Post({MusicCommandType::Play, stream});
+}
+
+void MusicFeeder::StopMusic()
+{
+    Post({MusicCommandType::Stop, Music{}});
+}
+
+void MusicFeeder::Restart()
+{
+    Post({MusicCommandType::Restart, Music{}});
+}
+
+void MusicFeeder::Post(const MusicCommand& command)
+{
+    if (!feederThread.joinable())
+    {
+        Apply(command);
+        return;
+    }
+
+    // The feeder drains the queue every few milliseconds, and commands come a
+    // handful per level at most, so a full queue only ever means a short wait.
+    while (!commands.TryPush(command))
+    {
+        std::this_thread::yield();
+    }
+}
+
+void MusicFeeder::Apply(const MusicCommand& command)
+{
+    switch (command.type)
+    {
+        case MusicCommandType::Play:
+        {
+            if (playing)
+            {
+                StopMusicStream(music);
+            }
+            music = command.music;
+            PlayMusicStream(music);
+            playing = true;
+            break;
+        }
+        case MusicCommandType::Stop:
+        {
+            if (playing)
+            {
+                StopMusicStream(music);
+                playing = false;
+            }
+            break;
+        }
+        case MusicCommandType::Restart:
+        {
+            if (playing)
+            {
+                StopMusicStream(music);
+                PlayMusicStream(music);
+            }
+            break;
+        }
+    }
+}
+
+void MusicFeeder::ThreadMain()
+{
+    FrameProfiler::Get().SetThreadName("Music");
+    Clock::time_point lastFeed = Clock::now();
+    Clock::time_point windowStart = lastFeed;
+    float windowWorstMs = 0.0f;
+
+    while (running.load(std::memory_order_acquire))
+    {
+        MusicCommand command{};
+        while (commands.TryPop(command))
+        {
+            Apply(command);
+        }
+
+        if (playing)
+        {
+            SKYBOUND_PROFILE_SCOPE("UpdateMusicStream");
+            UpdateMusicStream(music);
+        }
+
+        const Clock::time_point now = Clock::now();
+        windowWorstMs = std::max(windowWorstMs, std::chrono::duration<float, std::milli>(now - lastFeed).count());
+        lastFeed = now;
+        if (now - windowStart >= std::chrono::seconds(1))
+        {
+            worstGapMs.store(windowWorstMs, std::memory_order_relaxed);
+            windowWorstMs = 0.0f;
+            windowStart = now;
+        }
+
+        std::this_thread::sleep_for(MUSIC_FEED_INTERVAL);
+    }
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <thread>
+
+#include "raylib.h"
+
+#include "spsc_queue.h"
+
+enum class MusicCommandType
+{
+    Play,
+    Stop,
+    Restart
+};
+
+struct MusicCommand
+{
+    MusicCommandType type{MusicCommandType::Stop};
+    // The stream to start; only read for Play.
+    Music music{};
+};
+
+constexpr std::size_t MUSIC_COMMAND_QUEUE_CAPACITY = 16;
+// How often the feeder tops up the stream. raylib's stream buffers hold about
+// 33 ms each, so this leaves plenty of slack without keeping a core awake.
+constexpr std::chrono::milliseconds MUSIC_FEED_INTERVAL{5};
+
+// Decodes and refills the music stream on a thread of its own, so a long frame
+// never starves the audio device. The game thread only posts commands through
+// a lock-free queue; from Play until Stop the feeder is the only thread that
+// touches the stream. The caller keeps the Music loaded while it plays.
+class MusicFeeder
+{
+public:
+    MusicFeeder() = default;
+    ~MusicFeeder();
+
+    MusicFeeder(const MusicFeeder&) = delete;
+    MusicFeeder& operator=(const MusicFeeder&) = delete;
+
+    // Call once the audio device is open.
+    void Start();
+    // Stops any playing music and joins the feeder thread.
+    void Stop();
+
+    // Game thread only. Commands apply in order within one feed interval.
+    void Play(const Music& music);
+    void StopMusic();
+    void Restart();
+
+    // Longest wait between two refills over the last second, in milliseconds.
+    float GetWorstFeedGapMs() const { return worstGapMs.load(std::memory_order_relaxed); }
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    void Post(const MusicCommand& command);
+    void Apply(const MusicCommand& command);
+    void ThreadMain();
+
+    SpscQueue<MusicCommand, MUSIC_COMMAND_QUEUE_CAPACITY> commands{};
+    std::atomic<bool> running{false};
+    std::thread feederThread{};
+    std::atomic<float> worstGapMs{0.0f};
+
+    // Feeder thread only.
+    Music music{};
+    bool playing{false};
+};
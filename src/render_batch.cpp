@@ -0,0 +1,121 @@
+#include "render_batch.h"
+
+#include <cmath>
+
+#include "rlgl.h"
+
+PrimitiveBatch::PrimitiveBatch(std::size_t capacity)
+{
+    // whole triangles only, so a flush never splits one
+    vertices.resize(capacity < 3 ? 3 : capacity - capacity % 3);
+
+    for (int i = 0; i <= PRIMITIVE_BATCH_CIRCLE_SEGMENTS; ++i)
+    {
+        const float angle = 2.0f * PI * static_cast<float>(i) / static_cast<float>(PRIMITIVE_BATCH_CIRCLE_SEGMENTS);
+        unitCircle[static_cast<std::size_t>(i)] = {std::cos(angle), std::sin(angle)};
+    }
+}
+
+void PrimitiveBatch::BeginFrame()
+{
+    lastFrameStats = frameStats;
+    frameStats = PrimitiveBatchStats{};
+}
+
+void PrimitiveBatch::PushRectangle(const Rectangle& rect, Color color)
+{
+    Reserve(6);
+
+    const float left = rect.x;
+    const float top = rect.y;
+    const float right = rect.x + rect.width;
+    const float bottom = rect.y + rect.height;
+
+    PushVertex(left, top, color);
+    PushVertex(left, bottom, color);
+    PushVertex(right, bottom, color);
+    PushVertex(left, top, color);
+    PushVertex(right, bottom, color);
+    PushVertex(right, top, color);
+    frameStats.primitives += 1;
+}
+
+void PrimitiveBatch::PushLine(Vector2 start, Vector2 end, float thickness, Color color)
+{
+    const float dx = end.x - start.x;
+    const float dy = end.y - start.y;
+    const float length = std::sqrt(dx * dx + dy * dy);
+    if (length <= 0.0f || thickness <= 0.0f)
+    {
+        return;
+    }
+
+    Reserve(6);
+
+    const float scale = thickness / (2.0f * length);
+    const float nx = -dy * scale;
+    const float ny = dx * scale;
+
+    PushVertex(start.x - nx, start.y - ny, color);
+    PushVertex(start.x + nx, start.y + ny, color);
+    PushVertex(end.x - nx, end.y - ny, color);
+    PushVertex(start.x + nx, start.y + ny, color);
+    PushVertex(end.x + nx, end.y + ny, color);
+    PushVertex(end.x - nx, end.y - ny, color);
+    frameStats.primitives += 1;
+}
+
+void PrimitiveBatch::PushCircle(Vector2 center, float radius, Color color)
+{
+    Reserve(PRIMITIVE_BATCH_CIRCLE_SEGMENTS * 3);
+
+    for (int i = 0; i < PRIMITIVE_BATCH_CIRCLE_SEGMENTS; ++i)
+    {
+        const Vector2& a = unitCircle[static_cast<std::size_t>(i)];
+        const Vector2& b = unitCircle[static_cast<std::size_t>(i + 1)];
+        PushVertex(center.x, center.y, color);
+        PushVertex(center.x + b.x * radius, center.y + b.y * radius, color);
+        PushVertex(center.x + a.x * radius, center.y + a.y * radius, color);
+    }
+    frameStats.primitives += 1;
+}
+
+void PrimitiveBatch::Flush()
+{
+    if (used == 0)
+    {
+        return;
+    }
+
+    // Makes rlgl submit its own pending batch first if ours would overflow it.
+    rlCheckRenderBatchLimit(static_cast<int>(used));
+
+    rlBegin(RL_TRIANGLES);
+    for (std::size_t i = 0; i < used; ++i)
+    {
+        const BatchVertex& vertex = vertices[i];
+        rlColor4ub(vertex.color.r, vertex.color.g, vertex.color.b, vertex.color.a);
+        rlVertex2f(vertex.x, vertex.y);
+    }
+    rlEnd();
+
+    frameStats.drawCalls += 1;
+    frameStats.vertices += static_cast<int>(used);
+    used = 0;
+}
+
+void PrimitiveBatch::Reserve(std::size_t count)
+{
+    if (used + count > vertices.size())
+    {
+        Flush();
+    }
+}
+
+void PrimitiveBatch::PushVertex(float x, float y, Color color)
+{
+    BatchVertex& vertex = vertices[used++];
+    vertex.x = x;
+    vertex.y = y;
+    vertex.color = color;
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <vector>
+
+#include "raylib.h"
+
+constexpr std::size_t PRIMITIVE_BATCH_CAPACITY = 12288;
+constexpr int PRIMITIVE_BATCH_CIRCLE_SEGMENTS = 16;
+
+struct PrimitiveBatchStats
+{
+    int drawCalls{0};
+    int vertices{0};
+    int primitives{0};
+};
+
+// Collects flat-coloured rectangles, thick lines and discs as triangles in a
+// pre-sized buffer and hands them to rlgl in one rlBegin/rlEnd per flush,
+// instead of one DrawRectangleRec/DrawCircleV/DrawLineEx call per shape.
+// Flush before anything that changes the transform (BeginMode2D/EndMode2D).
+class PrimitiveBatch
+{
+public:
+    explicit PrimitiveBatch(std::size_t capacity = PRIMITIVE_BATCH_CAPACITY);
+
+    // Resets the counters; the previous frame's totals stay readable.
+    void BeginFrame();
+
+    void PushRectangle(const Rectangle& rect, Color color);
+    void PushLine(Vector2 start, Vector2 end, float thickness, Color color);
+    void PushCircle(Vector2 center, float radius, Color color);
+    void Flush();
+
+    const PrimitiveBatchStats& GetFrameStats() const { return frameStats; }
+    const PrimitiveBatchStats& GetLastFrameStats() const { return lastFrameStats; }
+
+private:
+    struct BatchVertex
+    {
+        float x{0.0f};
+        float y{0.0f};
+        Color color{};
+    };
+
+    void Reserve(std::size_t count);
+    void PushVertex(float x, float y, Color color);
+
+    std::vector<BatchVertex> vertices{};
+    std::size_t used{0};
+    std::array<Vector2, PRIMITIVE_BATCH_CIRCLE_SEGMENTS + 1> unitCircle{};
+    PrimitiveBatchStats frameStats{};
+    PrimitiveBatchStats lastFrameStats{};
+};
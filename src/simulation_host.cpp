@@ -0,0 +1,196 @@
+#include "simulation_host.h"
+
+#include <algorithm>
+
+#include "input.h"
+#include "profiler.h"
+
+SimulationHost::~SimulationHost()
+{
+    Stop();
+}
+
+void SimulationHost::Configure(float newStep, int newMaxSubsteps)
+{
+    step = newStep;
+    maxSubsteps = std::max(1, newMaxSubsteps);
+}
+
+bool SimulationHost::LoadReplay(const std::string& path)
+{
+    if (!replayPlayer.Load(path))
+    {
+        replayPlayer = ReplayPlayer{};
+        return false;
+    }
+
+    // Everything random derives from the seed, so a fresh simulation replays
+    // exactly, provided it ticks at the recorded step.
+    step = replayPlayer.GetStep();
+    simulation = Simulation(replayPlayer.GetSeed());
+    return true;
+}
+
+void SimulationHost::StartRecording()
+{
+    replayRecorder.Begin(simulation.GetSeed(), step);
+}
+
+void SimulationHost::Start()
+{
+    if (IsThreaded())
+    {
+        return;
+    }
+
+    // The renderer has something to draw before the first tick lands.
+    Publish();
+    running.store(true, std::memory_order_release);
+    simulationThread = std::thread(&SimulationHost::ThreadMain, this);
+}
+
+void SimulationHost::Stop()
+{
+    running.store(false, std::memory_order_release);
+    if (simulationThread.joinable())
+    {
+        simulationThread.join();
+    }
+}
+
+void SimulationHost::Submit(const FrameInput& frame)
+{
+    if (!IsThreaded())
+    {
+        ApplyInput(frame);
+        return;
+    }
+
+    // A full queue means the simulation thread has stalled; fold this frame's
+    // presses into the one waiting so none are lost.
+    FrameInput queued = frame;
+    if (hasPendingInput)
+    {
+        LatchInputState(pendingInput, frame.input);
+        queued.input = pendingInput;
+    }
+
+    hasPendingInput = !inputQueue.TryPush(queued);
+    if (hasPendingInput)
+    {
+        pendingInput = queued.input;
+    }
+}
+
+void SimulationHost::ApplyInput(const FrameInput& frame)
+{
+    LatchInputState(latchedInput, frame.input);
+    simulation.SetViewSize(frame.viewSize);
+
+    // Padded so the camera can move for a frame or two without exposing
+    // entities the snapshot left out.
+    captureArea = {frame.view.x - frame.view.width * 0.5f,
+                   frame.view.y - frame.view.height * 0.5f,
+                   frame.view.width * 2.0f,
+                   frame.view.height * 2.0f};
+}
+
+void SimulationHost::Advance(float seconds)
+{
+    timeAccumulator += seconds;
+
+    const float maxCatchUp = step * static_cast<float>(maxSubsteps);
+    if (timeAccumulator > maxCatchUp)
+    {
+        dilatedSeconds += timeAccumulator - maxCatchUp;
+        timeAccumulator = maxCatchUp;
+    }
+
+    lastSubsteps = 0;
+    while (timeAccumulator >= step)
+    {
+        Tick();
+        timeAccumulator -= step;
+        ++lastSubsteps;
+    }
+
+    Publish();
+}
+
+std::uint32_t SimulationHost::RunReplayFor(double seconds)
+{
+    const Clock::time_point start = Clock::now();
+    const std::uint32_t firstTick = replayPlayer.GetTick();
+
+    while (IsReplaying() && std::chrono::duration<double>(Clock::now() - start).count() < seconds)
+    {
+        Tick();
+    }
+
+    const std::uint32_t ticks = replayPlayer.GetTick() - firstTick;
+    timeAccumulator = 0.0f;
+    lastSubsteps = static_cast<int>(ticks);
+    Publish();
+    return ticks;
+}
+
+void SimulationHost::Tick()
+{
+    SKYBOUND_PROFILE_SCOPE("Update");
+
+    // A replay owns input until it runs out, then live input takes over.
+    const InputState input = IsReplaying() ? replayPlayer.Next() : latchedInput;
+    simulation.Update(input, step);
+    replayRecorder.Record(input);
+    ClearInputPresses(latchedInput);
+    ++tickCount;
+}
+
+void SimulationHost::Publish()
+{
+    RenderSnapshot& snapshot = snapshots.GetWriteBuffer();
+    CaptureRenderSnapshot(simulation, tickCount, captureArea, snapshot);
+    snapshot.tickStep = step;
+    snapshot.tickProgress = timeAccumulator / step;
+    snapshot.captureSeconds = std::chrono::duration<double>(Clock::now() - epoch).count();
+    snapshot.substeps = lastSubsteps;
+    snapshot.dilatedSeconds = dilatedSeconds;
+    snapshots.Publish();
+}
+
+const RenderSnapshot& SimulationHost::AcquireSnapshot()
+{
+    snapshots.Acquire();
+    return snapshots.GetReadBuffer();
+}
+
+float SimulationHost::GetRenderAlpha(const RenderSnapshot& snapshot) const
+{
+    if (snapshot.tickStep <= 0.0f)
+    {
+        return 1.0f;
+    }
+
+    const double now = std::chrono::duration<double>(Clock::now() - epoch).count();
+    const double progress = snapshot.tickProgress + (now - snapshot.captureSeconds) / snapshot.tickStep;
+    return static_cast<float>(std::clamp(progress, 0.0, 1.0));
+}
+
+void SimulationHost::ThreadMain()
+{
+    FrameProfiler::Get().SetThreadName("Simulation");
+    tickPacer.Configure(PacingMode::Capped, step);
+
+    while (running.load(std::memory_order_acquire))
+    {
+        const float dt = tickPacer.Pace();
+
+        FrameInput frame{};
+        while (inputQueue.TryPop(frame))
+        {
+            ApplyInput(frame);
+        }
+
+        Advance(dt);
+    }
+}
@@ -0,0 +1,106 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <thread>
+
+#include "raylib.h"
+
+#include "frame_pacer.h"
+#include "input_state.h"
+#include "render_snapshot.h"
+#include "replay.h"
+#include "simulation.h"
+#include "spsc_queue.h"
+#include "triple_buffer.h"
+
+// What the render thread hands the simulation each frame.
+struct FrameInput
+{
+    InputState input{};
+    Vector2 viewSize{};
+    // World-space area on screen; snapshots capture entities around it.
+    Rectangle view{};
+};
+
+constexpr std::size_t FRAME_INPUT_QUEUE_CAPACITY = 64;
+
+// Owns the simulation and everything that happens once per tick: fixed-step
+// timing, replay playback and recording, and publishing render snapshots.
+//
+// Single-threaded, the render loop calls Advance each frame. Threaded (between
+// Start and Stop), a dedicated thread paces itself to the tick rate, takes
+// input from a lock-free queue and publishes a snapshot after every batch of
+// ticks into a triple buffer. Either way the renderer only ever reads the
+// latest snapshot, never the Simulation itself.
+class SimulationHost
+{
+public:
+    SimulationHost() = default;
+    ~SimulationHost();
+
+    SimulationHost(const SimulationHost&) = delete;
+    SimulationHost& operator=(const SimulationHost&) = delete;
+
+    // Setup, only while the simulation thread is not running.
+    void Configure(float step, int maxSubsteps);
+    Simulation& GetSimulation() { return simulation; }
+    // Adopts the replay's seed and tick step; false if it cannot be loaded.
+    bool LoadReplay(const std::string& path);
+    const ReplayPlayer& GetReplay() const { return replayPlayer; }
+    void StartRecording();
+    ReplayRecorder& GetRecorder() { return replayRecorder; }
+
+    void Start();
+    void Stop();
+    bool IsThreaded() const { return simulationThread.joinable(); }
+
+    // Render thread, once per frame.
+    void Submit(const FrameInput& frame);
+    // Single-threaded only: runs the ticks due after another `seconds` of wall time.
+    void Advance(float seconds);
+    // Single-threaded only: steps the replay flat out for about `seconds`;
+    // returns the ticks run.
+    std::uint32_t RunReplayFor(double seconds);
+    bool IsReplaying() const { return replayPlayer.IsLoaded() && !replayPlayer.IsFinished(); }
+
+    // Newest published snapshot; stays valid until the next call.
+    const RenderSnapshot& AcquireSnapshot();
+    // How far past the snapshot's tick the present moment is, in ticks, capped at 1.
+    float GetRenderAlpha(const RenderSnapshot& snapshot) const;
+    float GetStep() const { return step; }
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    void ApplyInput(const FrameInput& frame);
+    void Tick();
+    void Publish();
+    void ThreadMain();
+
+    Simulation simulation{};
+    ReplayRecorder replayRecorder{};
+    ReplayPlayer replayPlayer{};
+    float step{SIMULATION_STEP};
+    int maxSubsteps{8};
+    float timeAccumulator{0.0f};
+    std::uint64_t tickCount{0};
+    int lastSubsteps{0};
+    float dilatedSeconds{0.0f};
+    // Presses stay latched until a tick consumes them.
+    InputState latchedInput{};
+    Rectangle captureArea{};
+    Clock::time_point epoch{Clock::now()};
+
+    // Render-thread side of the queue: a frame that found it full waits here.
+    InputState pendingInput{};
+    bool hasPendingInput{false};
+
+    SpscQueue<FrameInput, FRAME_INPUT_QUEUE_CAPACITY> inputQueue{};
+    TripleBuffer<RenderSnapshot> snapshots{};
+    std::atomic<bool> running{false};
+    std::thread simulationThread{};
+    FramePacer tickPacer{};
+};
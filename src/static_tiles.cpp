@@ -0,0 +1,196 @@
+#include "static_tiles.h"
+
+#include <cmath>
+
+#include "profiler.h"
+
+namespace
+{
+    int TileCoordinate(float world)
+    {
+        return static_cast<int>(std::floor(world / static_cast<float>(STATIC_TILE_SIZE)));
+    }
+
+    bool SameColor(Color a, Color b)
+    {
+        return a.r == b.r && a.g == b.g && a.b == b.b && a.a == b.a;
+    }
+}
+
+void StaticTileCache::SetGeometry(const std::shared_ptr<const StaticGeometry>& newGeometry, Color newColor)
+{
+    if (newGeometry == geometry && SameColor(newColor, color))
+    {
+        return;
+    }
+
+    Unload();
+    tiles.clear();
+    geometry = newGeometry;
+    color = newColor;
+    if (!geometry)
+    {
+        return;
+    }
+
+    for (std::size_t i = 0; i < geometry->platforms.size(); ++i)
+    {
+        const Rectangle& bounds = geometry->platforms[i];
+        const int lastColumn = TileCoordinate(bounds.x + bounds.width);
+        const int lastRow = TileCoordinate(bounds.y + bounds.height);
+        for (int column = TileCoordinate(bounds.x); column <= lastColumn; ++column)
+        {
+            for (int row = TileCoordinate(bounds.y); row <= lastRow; ++row)
+            {
+                tiles[TileKey(column, row)].platforms.push_back(static_cast<int>(i));
+            }
+        }
+    }
+}
+
+void StaticTileCache::Prepare(const Rectangle& view)
+{
+    SKYBOUND_PROFILE_SCOPE("BakeStaticTiles");
+
+    lastFrameStats = frameStats;
+    frameStats = {};
+    frame += 1;
+
+    const int lastColumn = TileCoordinate(view.x + view.width);
+    const int lastRow = TileCoordinate(view.y + view.height);
+    for (int column = TileCoordinate(view.x); column <= lastColumn; ++column)
+    {
+        for (int row = TileCoordinate(view.y); row <= lastRow; ++row)
+        {
+            if (frameStats.tilesBaked == STATIC_TILE_BAKES_PER_FRAME)
+            {
+                return;
+            }
+
+            const auto found = tiles.find(TileKey(column, row));
+            if (found != tiles.end() && !found->second.baked)
+            {
+                Bake(column, row, found->second);
+            }
+        }
+    }
+}
+
+void StaticTileCache::Draw(const Rectangle& view, PrimitiveBatch& batch)
+{
+    const float size = static_cast<float>(STATIC_TILE_SIZE);
+    const int lastColumn = TileCoordinate(view.x + view.width);
+    const int lastRow = TileCoordinate(view.y + view.height);
+    for (int column = TileCoordinate(view.x); column <= lastColumn; ++column)
+    {
+        for (int row = TileCoordinate(view.y); row <= lastRow; ++row)
+        {
+            const auto found = tiles.find(TileKey(column, row));
+            if (found == tiles.end())
+            {
+                continue;
+            }
+
+            Tile& tile = found->second;
+            if (tile.baked)
+            {
+                // Render textures are stored bottom-up, hence the negative height.
+                DrawTextureRec(tile.texture.texture,
+                               Rectangle{0.0f, 0.0f, size, -size},
+                               Vector2{static_cast<float>(column) * size, static_cast<float>(row) * size},
+                               WHITE);
+                tile.lastDrawn = frame;
+                frameStats.tilesDrawn += 1;
+                continue;
+            }
+
+            // Platforms spanning several unbaked tiles draw once per tile; they
+            // are opaque and the same colour, so the overlap does not show.
+            for (const int platform : tile.platforms)
+            {
+                batch.PushRectangle(geometry->platforms[static_cast<std::size_t>(platform)], color);
+                frameStats.liveRectangles += 1;
+            }
+        }
+    }
+
+    frameStats.residentTiles = static_cast<int>(residentTiles);
+}
+
+void StaticTileCache::Unload()
+{
+    for (auto& entry : tiles)
+    {
+        Tile& tile = entry.second;
+        if (tile.baked)
+        {
+            UnloadRenderTexture(tile.texture);
+            tile.texture = RenderTexture2D{};
+            tile.baked = false;
+        }
+    }
+    residentTiles = 0;
+}
+
+std::int64_t StaticTileCache::TileKey(int column, int row)
+{
+    return (static_cast<std::int64_t>(column) << 32) ^ static_cast<std::uint32_t>(row);
+}
+
+void StaticTileCache::Bake(int column, int row, Tile& tile)
+{
+    if (residentTiles >= STATIC_TILE_BUDGET)
+    {
+        EvictOverBudget();
+    }
+
+    tile.texture = LoadRenderTexture(STATIC_TILE_SIZE, STATIC_TILE_SIZE);
+    if (tile.texture.id == 0)
+    {
+        return;
+    }
+
+    const float originX = static_cast<float>(column * STATIC_TILE_SIZE);
+    const float originY = static_cast<float>(row * STATIC_TILE_SIZE);
+
+    BeginTextureMode(tile.texture);
+    ClearBackground(BLANK);
+    for (const int platform : tile.platforms)
+    {
+        const Rectangle& bounds = geometry->platforms[static_cast<std::size_t>(platform)];
+        DrawRectangleRec(Rectangle{bounds.x - originX, bounds.y - originY, bounds.width, bounds.height}, color);
+    }
+    EndTextureMode();
+
+    tile.baked = true;
+    tile.lastDrawn = frame;
+    residentTiles += 1;
+    frameStats.tilesBaked += 1;
+}
+
+void StaticTileCache::EvictOverBudget()
+{
+    while (residentTiles >= STATIC_TILE_BUDGET)
+    {
+        Tile* oldest = nullptr;
+        for (auto& entry : tiles)
+        {
+            Tile& tile = entry.second;
+            if (tile.baked && tile.lastDrawn < frame && (oldest == nullptr || tile.lastDrawn < oldest->lastDrawn))
+            {
+                oldest = &tile;
+            }
+        }
+
+        // Everything resident is on screen; go over budget rather than thrash.
+        if (oldest == nullptr)
+        {
+            return;
+        }
+
+        UnloadRenderTexture(oldest->texture);
+        oldest->texture = RenderTexture2D{};
+        oldest->baked = false;
+        residentTiles -= 1;
+    }
+}
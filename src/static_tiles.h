@@ -0,0 +1,72 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include "raylib.h"
+
+#include "level.h"
+#include "render_batch.h"
+
+constexpr int STATIC_TILE_SIZE = 512;
+// Resident tile textures (1 MiB each); enough for a zoomed-out 1080p view.
+constexpr std::size_t STATIC_TILE_BUDGET = 40;
+// Tiles baked per frame; the rest of a newly visible area draws live until then.
+constexpr int STATIC_TILE_BAKES_PER_FRAME = 4;
+
+struct StaticTileStats
+{
+    int tilesDrawn{0};
+    int tilesBaked{0};
+    int liveRectangles{0};
+    int residentTiles{0};
+};
+
+// Renders a level's fixed platforms into world-aligned square render textures
+// once, so a frame blits a handful of tiles instead of resubmitting every
+// ledge. Tiles are baked lazily as they come into view and the least recently
+// drawn ones are dropped once over budget. A new level or platform colour
+// throws the whole set away.
+class StaticTileCache
+{
+public:
+    StaticTileCache() = default;
+    StaticTileCache(const StaticTileCache&) = delete;
+    StaticTileCache& operator=(const StaticTileCache&) = delete;
+
+    void SetGeometry(const std::shared_ptr<const StaticGeometry>& geometry, Color color);
+    // Bakes missing tiles in the view. Call outside BeginMode2D, since baking
+    // switches render targets and resets the transform.
+    void Prepare(const Rectangle& view);
+    // Call inside BeginMode2D. Unbaked tiles go through the batch instead.
+    void Draw(const Rectangle& view, PrimitiveBatch& batch);
+    // Frees every tile texture; call before the window closes.
+    void Unload();
+
+    const StaticTileStats& GetLastFrameStats() const { return lastFrameStats; }
+
+private:
+    struct Tile
+    {
+        std::vector<int> platforms{};
+        RenderTexture2D texture{};
+        bool baked{false};
+        std::uint64_t lastDrawn{0};
+    };
+
+    static std::int64_t TileKey(int column, int row);
+    void Bake(int column, int row, Tile& tile);
+    void EvictOverBudget();
+
+    std::shared_ptr<const StaticGeometry> geometry{};
+    Color color{};
+    // Only tiles that some platform touches exist at all.
+    std::unordered_map<std::int64_t, Tile> tiles{};
+    std::size_t residentTiles{0};
+    std::uint64_t frame{0};
+    StaticTileStats frameStats{};
+    StaticTileStats lastFrameStats{};
+};
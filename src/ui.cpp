@@ -2,32 +2,31 @@
 
 #include <cmath>
 #include <cstdio>
-#include <string>
+#include <cstring>
 
 #include "player.h"
 #include "game.h"
+#include "profiler.h"
 
 namespace
 {
-    std::string FormatTime(float seconds)
+    constexpr std::int64_t NO_TIME = -1;
+
+    // The time as the HUD shows it, in whole hundredths, or NO_TIME if unset.
+    std::int64_t ToHundredths(float seconds)
     {
         if (seconds < 0.0f || std::isinf(seconds))
         {
-            return "--:--.--";
+            return NO_TIME;
         }
 
-        int wholeSeconds = static_cast<int>(seconds);
-        int minutes = wholeSeconds / 60;
-        int secs = wholeSeconds % 60;
+        const int wholeSeconds = static_cast<int>(seconds);
         int hundredths = static_cast<int>((seconds - static_cast<float>(wholeSeconds)) * 100.0f);
         if (hundredths < 0)
         {
             hundredths = 0;
         }
-
-        char buffer[32];
-        std::snprintf(buffer, sizeof(buffer), "%02d:%02d.%02d", minutes, secs, hundredths);
-        return buffer;
+        return static_cast<std::int64_t>(wholeSeconds) * 100 + hundredths;
     }
 
     const char* WeatherLabel(WeatherType type)
@@ -41,103 +40,277 @@ namespace
             default: return "Unknown";
         }
     }
+
+    // Formats and measures the line only if its key or font size moved on;
+    // returns whether it did. The text must be derived from the key alone.
+    template <typename... Args>
+    bool SetText(HudText& line, std::int64_t key, int fontSize, HudStats& stats, const char* format, Args... args)
+    {
+        if (line.formatted && line.key == key && line.fontSize == fontSize)
+        {
+            return false;
+        }
+
+        std::snprintf(line.text.data(), line.text.size(), format, args...);
+        line.key = key;
+        line.fontSize = fontSize;
+        line.width = MeasureText(line.text.data(), fontSize);
+        line.formatted = true;
+        stats.formats += 1;
+        return true;
+    }
+
+    bool SetTime(HudText& line, const char* label, float seconds, int fontSize, HudStats& stats)
+    {
+        const std::int64_t hundredths = ToHundredths(seconds);
+        if (hundredths == NO_TIME)
+        {
+            return SetText(line, hundredths, fontSize, stats, "%s: --:--.--", label);
+        }
+
+        return SetText(line,
+                       hundredths,
+                       fontSize,
+                       stats,
+                       "%s: %02d:%02d.%02d",
+                       label,
+                       static_cast<int>(hundredths / 6000),
+                       static_cast<int>(hundredths / 100 % 60),
+                       static_cast<int>(hundredths % 100));
+    }
+
+    // Moves the line; returns whether anything about where or how it draws changed.
+    bool Place(HudText& line, int x, int y, Color color, bool visible)
+    {
+        const bool changed = line.visible != visible ||
+                             (visible && (line.x != x || line.y != y || line.color.r != color.r ||
+                                          line.color.g != color.g || line.color.b != color.b ||
+                                          line.color.a != color.a));
+        line.x = x;
+        line.y = y;
+        line.color = color;
+        line.visible = visible;
+        return changed;
+    }
+
+    void DrawHudText(const HudText& line)
+    {
+        if (line.visible)
+        {
+            DrawText(line.text.data(), line.x, line.y, line.fontSize, line.color);
+        }
+    }
 }
 
-void DrawHUD(const Player& player,
-             int level,
-             bool timeTrialMode,
-             bool timeTrialActive,
-             float timeTrialTimer,
-             float bestTimeTrial,
-             const AccessibilityOptions& accessibility,
-             const AchievementState& achievements,
-             const WeatherState& weather)
+void HudLayer::Draw(const Player& player,
+                    int currentLevel,
+                    bool timeTrialMode,
+                    bool timeTrialActive,
+                    float timeTrialTimer,
+                    float bestTimeTrial,
+                    const AccessibilityOptions& accessibility,
+                    const AchievementState& achievements,
+                    const WeatherSnapshot& weather,
+                    bool rewinding,
+                    float rewindSeconds)
 {
+    SKYBOUND_PROFILE_SCOPE("DrawHUD");
+
+    lastFrameStats = frameStats;
+    frameStats = {};
+
     const int baseFont = accessibility.largeHud ? 32 : 24;
     const int smallFont = accessibility.largeHud ? 24 : 18;
     int y = 20;
 
-    DrawText(TextFormat("Score: %d", player.score), 20, y, baseFont, RAYWHITE);
+    // Static lines mark the layer dirty when their text or placement changes.
+    layerDirty |= SetText(score, player.score, baseFont, frameStats, "Score: %d", player.score);
+    layerDirty |= Place(score, 20, y, RAYWHITE, true);
     y += baseFont + 6;
-    DrawText(TextFormat("Lives: %d", player.lives), 20, y, baseFont, RAYWHITE);
+    layerDirty |= SetText(lives, player.lives, baseFont, frameStats, "Lives: %d", player.lives);
+    layerDirty |= Place(lives, 20, y, RAYWHITE, true);
     y += baseFont + 6;
-    DrawText(TextFormat("Level: %d", level), 20, y, baseFont, RAYWHITE);
+    layerDirty |= SetText(level, currentLevel, baseFont, frameStats, "Level: %d", currentLevel);
+    layerDirty |= Place(level, 20, y, RAYWHITE, true);
     y += baseFont + 10;
 
-    if (player.comboCount > 1)
+    const bool showCombo = player.comboCount > 1;
+    if (showCombo)
+    {
+        layerDirty |= SetText(combo, player.comboCount, smallFont + 4, frameStats, "Combo x%d!", player.comboCount);
+    }
+    layerDirty |= Place(combo, 20, y, GOLD, showCombo);
+    if (showCombo)
     {
-        DrawText(TextFormat("Combo x%d!", player.comboCount), 20, y, smallFont + 4, GOLD);
         y += smallFont + 10;
     }
 
-    DrawText(TextFormat("Best Combo: x%d", player.bestCombo), 20, y, smallFont, LIGHTGRAY);
+    layerDirty |= SetText(bestCombo, player.bestCombo, smallFont, frameStats, "Best Combo: x%d", player.bestCombo);
+    layerDirty |= Place(bestCombo, 20, y, LIGHTGRAY, true);
     y += smallFont + 8;
 
     if (timeTrialMode)
     {
-        const Color timerColor = timeTrialActive ? SKYBLUE : LIGHTGRAY;
-        DrawText(TextFormat("Time Trial: %s", FormatTime(timeTrialTimer).c_str()), 20, y, smallFont + 2, timerColor);
+        SetTime(timer, "Time Trial", timeTrialTimer, smallFont + 2, frameStats);
+    }
+    Place(timer, 20, y, timeTrialActive ? SKYBLUE : LIGHTGRAY, timeTrialMode);
+    if (timeTrialMode)
+    {
         y += smallFont + 8;
-
-        if (bestTimeTrial >= 0.0f)
-        {
-            DrawText(TextFormat("Best: %s", FormatTime(bestTimeTrial).c_str()), 20, y, smallFont, LIGHTGRAY);
-            y += smallFont + 8;
-        }
     }
 
-    if (player.invincibilityTimer > 0.0f)
+    const bool showBestTime = timeTrialMode && bestTimeTrial >= 0.0f;
+    if (showBestTime)
     {
-        DrawText(TextFormat("Invincible %.1fs", player.invincibilityTimer), 20, y, smallFont, YELLOW);
+        layerDirty |= SetTime(bestTime, "Best", bestTimeTrial, smallFont, frameStats);
+    }
+    layerDirty |= Place(bestTime, 20, y, LIGHTGRAY, showBestTime);
+    if (showBestTime)
+    {
+        y += smallFont + 8;
     }
 
-    if (achievements.notificationTimer > 0.0f && !achievements.lastUnlocked.empty())
+    const bool showInvincible = player.invincibilityTimer > 0.0f;
+    if (showInvincible)
     {
-        const int textWidth = MeasureText(achievements.lastUnlocked.c_str(), baseFont);
-        const int boxPadding = 20;
-        const int boxWidth = textWidth + boxPadding * 2;
-        const int boxHeight = baseFont + boxPadding;
-        const int x = (GetScreenWidth() - boxWidth) / 2;
-        const int boxY = 40;
-        DrawRectangleRounded(Rectangle{static_cast<float>(x), static_cast<float>(boxY), static_cast<float>(boxWidth), static_cast<float>(boxHeight)}, 0.2f, 6, Color{0, 0, 0, 180});
-        DrawText(achievements.lastUnlocked.c_str(), x + boxPadding, boxY + boxPadding / 2, baseFont, GOLD);
+        const long tenths = std::lround(player.invincibilityTimer * 10.0f);
+        SetText(invincible, tenths, smallFont, frameStats, "Invincible %.1fs", static_cast<double>(tenths) / 10.0);
     }
+    Place(invincible, 20, y, YELLOW, showInvincible);
 
     const int screenW = GetScreenWidth();
-    int infoX = screenW - (accessibility.largeHud ? 300 : 240);
+    if (rewinding)
+    {
+        const long tenths = std::lround(rewindSeconds * 10.0f);
+        SetText(rewind, tenths, baseFont, frameStats, "<< Rewind %.1fs", static_cast<double>(tenths) / 10.0);
+    }
+    Place(rewind, (screenW - rewind.width) / 2, 20, SKYBLUE, rewinding);
+
+    const int infoX = screenW - (accessibility.largeHud ? 300 : 240);
     int infoY = 20;
-    DrawText(TextFormat("Weather: %s", WeatherLabel(weather.current)),
-             infoX,
-             infoY,
-             baseFont - 2,
-             RAYWHITE);
+    layerDirty |= SetText(weatherName,
+                          static_cast<std::int64_t>(weather.current),
+                          baseFont - 2,
+                          frameStats,
+                          "Weather: %s",
+                          WeatherLabel(weather.current));
+    layerDirty |= Place(weatherName, infoX, infoY, RAYWHITE, true);
     infoY += baseFont;
 
-    DrawText(TextFormat("Wind %+0.1f", weather.windCurrent),
-             infoX,
-             infoY,
-             smallFont,
-             LIGHTGRAY);
+    // Wind eases continuously, so it draws every frame rather than
+    // invalidating the layer about every other frame.
+    const long windTenths = std::lround(weather.windCurrent * 10.0f);
+    SetText(wind, windTenths, smallFont, frameStats, "Wind %+0.1f", static_cast<double>(windTenths) / 10.0);
+    Place(wind, infoX, infoY, LIGHTGRAY, true);
     infoY += smallFont + 6;
 
-    if (weather.rainIntensity > 0.05f)
+    const bool showRain = weather.rainIntensity > 0.05f;
+    if (showRain)
+    {
+        const int percent = static_cast<int>(weather.rainIntensity * 100.0f);
+        layerDirty |= SetText(rain, percent, smallFont, frameStats, "Rain %d%%", percent);
+    }
+    layerDirty |= Place(rain, infoX, infoY, SKYBLUE, showRain);
+    if (showRain)
     {
-        DrawText(TextFormat("Rain %d%%", static_cast<int>(weather.rainIntensity * 100.0f)),
-                 infoX,
-                 infoY,
-                 smallFont,
-                 SKYBLUE);
         infoY += smallFont + 6;
     }
 
-    if (weather.lightningFlashTimer > 0.0f && weather.current == WeatherType::Storm)
+    const bool showLightning = weather.lightningFlashTimer > 0.0f && weather.current == WeatherType::Storm;
+    if (showLightning)
+    {
+        SetText(lightning, 0, smallFont, frameStats, "%s", "Lightning!");
+    }
+    Place(lightning, infoX, infoY, YELLOW, showLightning);
+
+    const int screenH = GetScreenHeight();
+    if (!layerLoaded || layer.texture.width != screenW || layer.texture.height != screenH)
+    {
+        Unload();
+        layer = LoadRenderTexture(screenW, screenH);
+        layerLoaded = layer.id != 0;
+    }
+
+    if (layerLoaded)
+    {
+        if (layerDirty)
+        {
+            RebuildLayer();
+        }
+
+        // Render textures are stored bottom-up, hence the negative height.
+        DrawTextureRec(layer.texture,
+                       Rectangle{0.0f, 0.0f, static_cast<float>(layer.texture.width), -static_cast<float>(layer.texture.height)},
+                       Vector2{0.0f, 0.0f},
+                       WHITE);
+    }
+    else
+    {
+        DrawStaticLines();
+    }
+
+    DrawHudText(timer);
+    DrawHudText(invincible);
+    DrawHudText(rewind);
+    DrawHudText(wind);
+    DrawHudText(lightning);
+
+    // The banner's box is translucent, and blending it into a cleared layer
+    // would halve its alpha, so it draws directly; only its text is cached.
+    const bool showBanner = achievements.notificationTimer > 0.0f && achievements.lastUnlocked != nullptr;
+    if (showBanner)
+    {
+        if (banner.fontSize != baseFont ||
+            std::strncmp(banner.text.data(), achievements.lastUnlocked, banner.text.size() - 1) != 0)
+        {
+            std::snprintf(banner.text.data(), banner.text.size(), "%s", achievements.lastUnlocked);
+            banner.fontSize = baseFont;
+            banner.width = MeasureText(banner.text.data(), baseFont);
+            frameStats.formats += 1;
+        }
+
+        const int boxPadding = 20;
+        const int boxWidth = banner.width + boxPadding * 2;
+        const int boxHeight = baseFont + boxPadding;
+        const int x = (screenW - boxWidth) / 2;
+        const int boxY = 40;
+        DrawRectangleRounded(Rectangle{static_cast<float>(x), static_cast<float>(boxY), static_cast<float>(boxWidth), static_cast<float>(boxHeight)}, 0.2f, 6, Color{0, 0, 0, 180});
+        DrawText(banner.text.data(), x + boxPadding, boxY + boxPadding / 2, baseFont, GOLD);
+    }
+}
+
+void HudLayer::Unload()
+{
+    if (layerLoaded)
     {
-        DrawText("Lightning!",
-                 infoX,
-                 infoY,
-                 smallFont,
-                 YELLOW);
+        UnloadRenderTexture(layer);
     }
+    layer = RenderTexture2D{};
+    layerLoaded = false;
+    layerDirty = true;
+}
+
+void HudLayer::DrawStaticLines() const
+{
+    DrawHudText(score);
+    DrawHudText(lives);
+    DrawHudText(level);
+    DrawHudText(combo);
+    DrawHudText(bestCombo);
+    DrawHudText(bestTime);
+    DrawHudText(weatherName);
+    DrawHudText(rain);
+}
+
+void HudLayer::RebuildLayer()
+{
+    BeginTextureMode(layer);
+    ClearBackground(BLANK);
+    DrawStaticLines();
+    EndTextureMode();
+
+    layerDirty = false;
+    frameStats.layerRebuilds += 1;
 }
 
 void DrawMenuScreen(Vector2 screenSize, bool timeTrialMode)
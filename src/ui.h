@@ -1,21 +1,96 @@
 #pragma once
 
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
 #include "raylib.h"
 
 struct Player;
 struct AccessibilityOptions;
 struct AchievementState;
-struct WeatherState;
-
-void DrawHUD(const Player& player,
-             int level,
-             bool timeTrialMode,
-             bool timeTrialActive,
-             float timeTrialTimer,
-             float bestTimeTrial,
-             const AccessibilityOptions& accessibility,
-             const AchievementState& achievements,
-             const WeatherState& weather);
+struct WeatherSnapshot;
+
+constexpr std::size_t HUD_TEXT_CAPACITY = 64;
+
+// One HUD line. The text is formatted and measured only when the value it
+// shows changes; every other frame just draws the cached buffer.
+struct HudText
+{
+    std::array<char, HUD_TEXT_CAPACITY> text{};
+    std::int64_t key{0};
+    int fontSize{0};
+    int width{0};
+    int x{0};
+    int y{0};
+    Color color{};
+    bool visible{false};
+    bool formatted{false};
+};
+
+struct HudStats
+{
+    int formats{0};
+    int layerRebuilds{0};
+};
+
+// Retained-mode HUD. Lines that only change on gameplay events (score, lives,
+// level, combo, best time, weather type and rain) are drawn once into a render
+// texture and composited with a single quad until one of them changes. The
+// lines that tick continuously (timers, wind), flash (lightning) or sit on
+// translucent backgrounds draw from their cached text each frame.
+class HudLayer
+{
+public:
+    HudLayer() = default;
+    HudLayer(const HudLayer&) = delete;
+    HudLayer& operator=(const HudLayer&) = delete;
+
+    // Call outside BeginMode2D; a rebuild switches render targets.
+    void Draw(const Player& player,
+              int level,
+              bool timeTrialMode,
+              bool timeTrialActive,
+              float timeTrialTimer,
+              float bestTimeTrial,
+              const AccessibilityOptions& accessibility,
+              const AchievementState& achievements,
+              const WeatherSnapshot& weather,
+              bool rewinding,
+              float rewindSeconds);
+    // Frees the layer texture; call before the window closes.
+    void Unload();
+
+    // Totals for the previous frame.
+    const HudStats& GetLastFrameStats() const { return lastFrameStats; }
+
+private:
+    void DrawStaticLines() const;
+    void RebuildLayer();
+
+    HudText score{};
+    HudText lives{};
+    HudText level{};
+    HudText combo{};
+    HudText bestCombo{};
+    HudText bestTime{};
+    HudText weatherName{};
+    HudText rain{};
+
+    HudText timer{};
+    HudText wind{};
+    HudText lightning{};
+    HudText invincible{};
+    HudText rewind{};
+    HudText banner{};
+
+    RenderTexture2D layer{};
+    bool layerLoaded{false};
+    bool layerDirty{true};
+    HudStats frameStats{};
+    HudStats lastFrameStats{};
+};
+
 void DrawMenuScreen(Vector2 screenSize, bool timeTrialMode);
 void DrawPauseScreen(Vector2 screenSize);
 void DrawGameOverScreen(Vector2 screenSize, int score, int bestCombo);